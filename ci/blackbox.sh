@@ -170,6 +170,10 @@ main() {
         mv -f $APP_PATH/trace.vcd .
     fi
 
+    if [ $DEBUG -eq 1 ] && [ -f "$APP_PATH/trace.fst" ]; then
+        mv -f $APP_PATH/trace.fst .
+    fi
+
     if [ $SCOPE -eq 1 ] && [ -f "$APP_PATH/scope.vcd" ]; then
         mv -f $APP_PATH/scope.vcd .
     fi
@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+
+# Copyright © 2019-2023
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Runs applications on SimX and rtlsim with the same configuration and
+# reports how far SimX's cycle counts and performance counters drift from
+# the RTL, per kernel launch.
+
+import argparse
+import csv
+import glob
+import json
+import os
+import re
+import subprocess
+import sys
+
+ROOT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+BLACKBOX = os.path.join(ROOT_DIR, "ci", "blackbox.sh")
+
+DEFAULT_APPS = "vecadd,sgemm,sgemv,dotproduct,conv3,stencil3d,sort,diverge"
+DRIVERS = ("simx", "rtlsim")
+
+def parse_args():
+    parser = argparse.ArgumentParser(description="SimX vs rtlsim cycle correlation.",
+                                     epilog="Arguments after '--' are passed to blackbox.sh for both drivers, e.g. -- --cores=4 --l2cache")
+    parser.add_argument("--apps", default=DEFAULT_APPS, help="Comma-separated applications (default: %(default)s)")
+    parser.add_argument("--perf", default="1,2", help="Comma-separated profiling classes (default: %(default)s)")
+    parser.add_argument("--threshold", type=float, default=10.0, help="Cycle error flagged above this percentage (default: %(default)s)")
+    parser.add_argument("--counter-threshold", type=float, default=25.0, help="Counter error flagged above this percentage (default: %(default)s)")
+    parser.add_argument("--min-count", type=int, default=100, help="Ignore counters below this value on both drivers (default: %(default)s)")
+    parser.add_argument("--outdir", default="perf_correlate", help="Directory for logs and exported counters (default: %(default)s)")
+    parser.add_argument("--csv", help="Write all comparisons to a CSV file")
+    parser.add_argument("--skip-run", action="store_true", help="Compare the counters already in the output directory")
+    parser.add_argument("extra", nargs=argparse.REMAINDER, help=argparse.SUPPRESS)
+    args = parser.parse_args()
+    if args.extra and args.extra[0] == "--":
+        args.extra = args.extra[1:]
+    return args
+
+def export_pattern(outdir, app, driver, perf_class):
+    return os.path.join(outdir, "{}.{}.perf{}.%d.json".format(app, driver, perf_class))
+
+def run_app(app, driver, perf_class, args):
+    pattern = export_pattern(args.outdir, app, driver, perf_class)
+    for filename in glob.glob(pattern.replace("%d", "*")):
+        os.remove(filename)
+    log_file = os.path.join(args.outdir, "{}.{}.perf{}.log".format(app, driver, perf_class))
+    cmd = [BLACKBOX, "--driver=" + driver, "--app=" + app, "--perf={}".format(perf_class)] + args.extra
+    env = dict(os.environ)
+    env["VORTEX_PERF_EXPORT"] = pattern
+    print("Running: {}".format(" ".join(cmd)), flush=True)
+    with open(log_file, "w") as log:
+        status = subprocess.call(cmd, stdout=log, stderr=subprocess.STDOUT, env=env)
+    if status != 0:
+        print("Error: {} on {} failed (see {})".format(app, driver, log_file))
+    return status == 0
+
+def load_launches(app, driver, perf_class, outdir):
+    # exported counters, indexed by launch
+    pattern = export_pattern(outdir, app, driver, perf_class)
+    regex = re.compile(re.escape(pattern).replace("%d", r"(\d+)") + "$")
+    launches = {}
+    for filename in glob.glob(pattern.replace("%d", "*")):
+        m = regex.match(filename)
+        if not m:
+            continue
+        with open(filename) as f:
+            launches[int(m.group(1))] = json.load(f)["total"]
+    return launches
+
+def error_pct(simx, rtlsim):
+    if rtlsim == 0:
+        return 0.0 if simx == 0 else float("inf")
+    return 100.0 * (simx - rtlsim) / rtlsim
+
+def compare(app, perf_class, args):
+    results = []
+    simx = load_launches(app, "simx", perf_class, args.outdir)
+    rtlsim = load_launches(app, "rtlsim", perf_class, args.outdir)
+    if len(simx) != len(rtlsim):
+        print("Warning: {} ran {} launches on simx and {} on rtlsim".format(app, len(simx), len(rtlsim)))
+    for launch in sorted(set(simx) & set(rtlsim)):
+        s_total = simx[launch]
+        r_total = rtlsim[launch]
+        for metric, r_value in r_total.items():
+            s_value = s_total.get(metric)
+            if s_value is None:
+                continue
+            # raw counters are only checked when significant, derived ratios always
+            is_count = isinstance(s_value, int) and isinstance(r_value, int)
+            if metric != "cycles" and is_count and max(abs(s_value), abs(r_value)) < args.min_count:
+                continue
+            err = error_pct(s_value, r_value)
+            threshold = args.threshold if metric == "cycles" else args.counter_threshold
+            results.append({
+                "app": app,
+                "launch": launch,
+                "perf_class": perf_class,
+                "metric": metric,
+                "simx": s_value,
+                "rtlsim": r_value,
+                "delta": s_value - r_value,
+                "error_pct": err,
+                "flagged": abs(err) > threshold
+            })
+    return results
+
+def format_value(value):
+    if isinstance(value, float) and not value.is_integer():
+        return "{:.3f}".format(value)
+    return str(int(value))
+
+def print_report(results, args):
+    cycles = {}
+    for r in results:
+        if r["metric"] == "cycles":
+            cycles[(r["app"], r["launch"])] = r
+    print()
+    print("{:<16} {:>6} {:>14} {:>14} {:>9}".format("app", "launch", "simx", "rtlsim", "error%"))
+    for (app, launch), r in sorted(cycles.items()):
+        print("{:<16} {:>6} {:>14} {:>14} {:>8.2f}%{}".format(
+            app, launch, format_value(r["simx"]), format_value(r["rtlsim"]), r["error_pct"],
+            "  <<" if r["flagged"] else ""))
+    if cycles:
+        errors = [abs(r["error_pct"]) for r in cycles.values()]
+        print("cycle error: mean={:.2f}%, max={:.2f}%".format(sum(errors) / len(errors), max(errors)))
+
+    flagged = [r for r in results if r["flagged"] and r["metric"] != "cycles"]
+    if flagged:
+        print()
+        print("Counters beyond {}%:".format(args.counter_threshold))
+        print("{:<16} {:>6} {:<28} {:>14} {:>14} {:>9}".format("app", "launch", "metric", "simx", "rtlsim", "error%"))
+        for r in sorted(flagged, key=lambda r: -abs(r["error_pct"])):
+            print("{:<16} {:>6} {:<28} {:>14} {:>14} {:>8.2f}%".format(
+                r["app"], r["launch"], r["metric"], format_value(r["simx"]), format_value(r["rtlsim"]), r["error_pct"]))
+
+def write_csv(results, filename):
+    fields = ["app", "launch", "perf_class", "metric", "simx", "rtlsim", "delta", "error_pct", "flagged"]
+    with open(filename, "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=fields)
+        writer.writeheader()
+        for r in results:
+            writer.writerow(r)
+
+def main():
+    args = parse_args()
+    apps = [app for app in args.apps.split(",") if app]
+    perf_classes = [int(c) for c in args.perf.split(",") if c]
+    os.makedirs(args.outdir, exist_ok=True)
+    args.outdir = os.path.abspath(args.outdir)
+
+    failed = False
+    results = []
+    for app in apps:
+        for perf_class in perf_classes:
+            if not args.skip_run:
+                ok = all([run_app(app, driver, perf_class, args) for driver in DRIVERS])
+                if not ok:
+                    failed = True
+                    continue
+            # cycles are reported by every class, keep them from the first only
+            for r in compare(app, perf_class, args):
+                if r["metric"] in ("cycles", "instrs") and perf_class != perf_classes[0]:
+                    continue
+                results.append(r)
+
+    print_report(results, args)
+    if args.csv:
+        write_csv(results, args.csv)
+
+    if any(r["flagged"] for r in results):
+        print("Divergence beyond threshold detected!")
+        return 1
+    return 1 if failed else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -12,6 +12,7 @@
 // limitations under the License.
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 #include <unordered_map>
 #include <vector>
@@ -47,6 +48,7 @@ extern "C" {
   void dpi_trace(int level, const char* format, ...);
   void dpi_trace_start();
   void dpi_trace_stop();
+  void dpi_trace_pc(int64_t pc);
 }
 
 bool sim_trace_enabled();
@@ -202,3 +204,16 @@ void dpi_trace_start() {
 void dpi_trace_stop() {
   sim_trace_enable(false);
 }
+
+void dpi_trace_pc(int64_t pc) {
+  // tracing can be triggered by a committed PC with VORTEX_TRACE_PC=<address>
+  static int64_t trigger_pc = []() {
+    auto env = getenv("VORTEX_TRACE_PC");
+    return (env && env[0] != '\0') ? (int64_t)strtoull(env, nullptr, 0) : -1ll;
+  }();
+  static bool triggered = false;
+  if (triggered || pc != trigger_pc)
+    return;
+  triggered = true;
+  sim_trace_enable(true);
+}
@@ -29,5 +29,6 @@ import "DPI-C" function void dpi_assert(int inst, input logic cond, input int de
 import "DPI-C" function void dpi_trace(input int level, input string format /*verilator sformat*/);
 import "DPI-C" function void dpi_trace_start();
 import "DPI-C" function void dpi_trace_stop();
+import "DPI-C" function void dpi_trace_pc(input longint pc);
 
 `endif
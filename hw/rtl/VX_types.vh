@@ -35,6 +35,7 @@
 `define VX_DCR_MPM_CLASS_NONE           0
 `define VX_DCR_MPM_CLASS_CORE           1
 `define VX_DCR_MPM_CLASS_MEM            2
+`define VX_DCR_MPM_CLASS_DRAM           3
 
 // User Floating-Point CSRs ///////////////////////////////////////////////////
 
@@ -103,6 +104,16 @@
 `define VX_CSR_MPM_SCRB_VPU_H           12'hB93
 `define VX_CSR_MPM_SCRB_TCU             12'hB14
 `define VX_CSR_MPM_SCRB_TCU_H           12'hB94
+`define VX_CSR_MPM_SCHED_WAIT           12'hB15     // ready warp cycles not scheduled
+`define VX_CSR_MPM_SCHED_WAIT_H         12'hB95
+`define VX_CSR_MPM_SCHED_STARV          12'hB16     // max cycles a ready warp waited
+`define VX_CSR_MPM_SCHED_STARV_H        12'hB96
+`define VX_CSR_MPM_TLB_MISS             12'hB17     // L1 TLB misses
+`define VX_CSR_MPM_TLB_MISS_H           12'hB97
+`define VX_CSR_MPM_TLB_WALKS            12'hB18     // page-table walks
+`define VX_CSR_MPM_TLB_WALKS_H          12'hB98
+`define VX_CSR_MPM_TLB_LT               12'hB19     // address translation cycles
+`define VX_CSR_MPM_TLB_LT_H             12'hB99
 // PERF: memory
 `define VX_CSR_MPM_IFETCHES             12'hB0E
 `define VX_CSR_MPM_IFETCHES_H           12'hB8E
@@ -183,6 +194,35 @@
 `define VX_CSR_MPM_COALESCER_MISS       12'hB1F     // coalescer misses
 `define VX_CSR_MPM_COALESCER_MISS_H     12'hB9F
 
+// Machine Performance-monitoring dram counters (class 3) /////////////////////
+
+// PERF: dram
+`define VX_CSR_MPM_DRAM_READS           12'hB03     // read transactions
+`define VX_CSR_MPM_DRAM_READS_H         12'hB83
+`define VX_CSR_MPM_DRAM_WRITES          12'hB04     // write transactions
+`define VX_CSR_MPM_DRAM_WRITES_H        12'hB84
+`define VX_CSR_MPM_DRAM_ROW_HIT         12'hB05     // row buffer hits
+`define VX_CSR_MPM_DRAM_ROW_HIT_H       12'hB85
+`define VX_CSR_MPM_DRAM_ROW_MISS        12'hB06     // row buffer misses (closed bank)
+`define VX_CSR_MPM_DRAM_ROW_MISS_H      12'hB86
+`define VX_CSR_MPM_DRAM_ROW_CONF        12'hB07     // row buffer conflicts
+`define VX_CSR_MPM_DRAM_ROW_CONF_H      12'hB87
+`define VX_CSR_MPM_DRAM_RW_TURN         12'hB08     // read/write turnarounds
+`define VX_CSR_MPM_DRAM_RW_TURN_H       12'hB88
+`define VX_CSR_MPM_DRAM_QUEUE           12'hB09     // queue occupancy
+`define VX_CSR_MPM_DRAM_QUEUE_H         12'hB89
+`define VX_CSR_MPM_DRAM_READ_LT         12'hB0A     // read latency
+`define VX_CSR_MPM_DRAM_READ_LT_H       12'hB8A
+`define VX_CSR_MPM_DRAM_CYCLES          12'hB0B     // dram cycles
+`define VX_CSR_MPM_DRAM_CYCLES_H        12'hB8B
+`define VX_CSR_MPM_DRAM_BYTES           12'hB0C     // bytes transferred
+`define VX_CSR_MPM_DRAM_BYTES_H         12'hB8C
+`define VX_CSR_MPM_DRAM_CH_RD           12'hB0D     // bytes read per channel (8 counters)
+`define VX_CSR_MPM_DRAM_CH_RD_H         12'hB8D
+`define VX_CSR_MPM_DRAM_CH_WR           12'hB15     // bytes written per channel (8 counters)
+`define VX_CSR_MPM_DRAM_CH_WR_H         12'hB95
+`define VX_CSR_MPM_DRAM_CHANNELS        8
+
 // <Add your own counters: use addresses hB03..B1F, hB83..hB9F>
 
 // Machine Information Registers //////////////////////////////////////////////
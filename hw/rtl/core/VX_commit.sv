@@ -174,6 +174,19 @@ module VX_commit import VX_gpu_pkg::*; #(
         assign commit_arb_if[i].ready    = 1;
     end
 
+`ifdef VCD_OUTPUT
+`ifdef SV_DPI
+    // committed PCs can trigger waveform capture
+    for (genvar i = 0; i < `ISSUE_WIDTH * NUM_EX_UNITS; ++i) begin : g_trace_pc
+        always @(posedge clk) begin
+            if (commit_if[i].valid && commit_if[i].ready) begin
+                dpi_trace_pc(64'(to_fullPC(commit_if[i].data.PC)));
+            end
+        end
+    end
+`endif
+`endif
+
 `ifdef DBG_TRACE_PIPELINE
     for (genvar i = 0; i < `ISSUE_WIDTH; ++i) begin : g_trace
         for (genvar j = 0; j < NUM_EX_UNITS; ++j) begin : g_j
@@ -42,6 +42,12 @@ typedef struct {
   // set device memory access rights
   int (*mem_access) (vx_buffer_h hbuffer, uint64_t offset, uint64_t size, int flags);
 
+  // map device memory into the host address space
+  int (*mem_map) (vx_buffer_h hbuffer, uint64_t offset, uint64_t size, int flags, void** host_ptr);
+
+  // unmap device memory from the host address space
+  int (*mem_unmap) (vx_buffer_h hbuffer, void* host_ptr);
+
   // return device memory address
   int (*mem_address) (vx_buffer_h hbuffer, uint64_t* address);
 
@@ -54,8 +60,17 @@ typedef struct {
   // Copy bytes from device memory to host
   int (*copy_from_dev) (void* host_ptr, vx_buffer_h hbuffer, uint64_t src_offset, uint64_t size);
 
+  // Copy bytes between device buffers
+  int (*copy_dev_to_dev) (vx_buffer_h hdst, uint64_t dst_offset, vx_buffer_h hsrc, uint64_t src_offset, uint64_t size);
+
+  // Fill device memory with a repeating pattern
+  int (*mem_fill) (vx_buffer_h hbuffer, uint64_t offset, uint64_t size, const void* pattern, uint32_t pattern_size);
+
   // Start device execution
-  int (*start) (vx_device_h hdevice, vx_buffer_h hkernel, vx_buffer_h harguments);
+  int (*start) (vx_device_h hdevice, vx_buffer_h hkernel, vx_buffer_h harguments, int flags);
+
+  // Invalidate device caches
+  int (*cache_flush) (vx_device_h hdevice);
 
   // Wait for device ready with milliseconds timeout
   int (*ready_wait) (vx_device_h hdevice, uint64_t timeout);
@@ -69,6 +84,9 @@ typedef struct {
   // query device performance counter
   int (*mpm_query) (vx_device_h hdevice, uint32_t addr, uint32_t core_id, uint64_t* value);
 
+  // read all cores performance counters
+  int (*mpm_snapshot) (vx_device_h hdevice, uint64_t* values);
+
 } callbacks_t;
 
 int vx_dev_init(callbacks_t* callbacks);
@@ -23,6 +23,8 @@
 #include <cstdint>
 #include <unordered_map>
 #include <array>
+#include <vector>
+#include <algorithm>
 
 #define CACHE_BLOCK_SIZE  64
 
@@ -75,4 +77,86 @@ inline uint64_t aligned_size(uint64_t size, uint64_t alignment) {
 inline bool is_aligned(uint64_t addr, uint64_t alignment) {
   assert(0 == (alignment & (alignment - 1)));
   return 0 == (addr & (alignment - 1));
-}
\ No newline at end of file
+}
+
+// Device-side copy and fill through host staging, for devices without a
+// native command. Overlapping copies are processed backward when needed.
+template <typename Device>
+int staged_copy(Device* device, uint64_t dst_addr, uint64_t src_addr, uint64_t size) {
+  const uint64_t chunk_size = 1 << 20;
+  std::vector<uint8_t> buffer(std::min(size, chunk_size));
+  bool backward = (dst_addr > src_addr && dst_addr < src_addr + size);
+  for (uint64_t done = 0; done < size;) {
+    uint64_t chunk = std::min(size - done, chunk_size);
+    uint64_t offset = backward ? (size - done - chunk) : done;
+    CHECK_ERR(device->download(buffer.data(), src_addr + offset, chunk), {
+      return err;
+    });
+    CHECK_ERR(device->upload(dst_addr + offset, buffer.data(), chunk), {
+      return err;
+    });
+    done += chunk;
+  }
+  return 0;
+}
+
+template <typename Device>
+int staged_fill(Device* device, uint64_t addr, uint64_t size, const void* pattern, uint32_t pattern_size) {
+  // chunks hold whole periods, so each starts in phase
+  // (at least one period, for patterns larger than 1 MiB)
+  const uint64_t chunk_size = std::max<uint64_t>(pattern_size, (1 << 20) - ((1 << 20) % pattern_size));
+  auto p = (const uint8_t*)pattern;
+  std::vector<uint8_t> buffer(std::min(size, chunk_size));
+  for (uint64_t i = 0; i < buffer.size(); ++i) {
+    buffer[i] = p[i % pattern_size];
+  }
+  for (uint64_t done = 0; done < size;) {
+    uint64_t chunk = std::min<uint64_t>(size - done, buffer.size());
+    CHECK_ERR(device->upload(addr + done, buffer.data(), chunk), {
+      return err;
+    });
+    done += chunk;
+  }
+  return 0;
+}
+
+// Host staging of mapped device buffers, for devices without shared memory:
+// mapping downloads the range and unmapping uploads it back if writable.
+class MemStaging {
+public:
+  template <typename Device>
+  int map(Device* device, uint64_t dev_addr, uint64_t size, int flags, void** host_ptr) {
+    entry_t entry{dev_addr, flags, std::vector<uint8_t>(size)};
+    if (flags & VX_MEM_READ) {
+      CHECK_ERR(device->download(entry.data.data(), dev_addr, size), {
+        return err;
+      });
+    }
+    auto ptr = entry.data.data();
+    entries_.emplace(ptr, std::move(entry));
+    *host_ptr = ptr;
+    return 0;
+  }
+
+  template <typename Device>
+  int unmap(Device* device, void* host_ptr) {
+    auto it = entries_.find(host_ptr);
+    if (it == entries_.end())
+      return -1;
+    auto& entry = it->second;
+    int err = 0;
+    if (entry.flags & VX_MEM_WRITE) {
+      err = device->upload(entry.dev_addr, entry.data.data(), entry.data.size());
+    }
+    entries_.erase(it);
+    return err;
+  }
+
+private:
+  struct entry_t {
+    uint64_t dev_addr;
+    int flags;
+    std::vector<uint8_t> data;
+  };
+  std::unordered_map<void*, entry_t> entries_;
+};
@@ -25,6 +25,8 @@ extern "C" {
 
 typedef void* vx_device_h;
 typedef void* vx_buffer_h;
+typedef void* vx_queue_h;
+typedef void* vx_event_h;
 
 // device caps ids
 #define VX_CAPS_VERSION             0x0
@@ -71,6 +73,21 @@ typedef void* vx_buffer_h;
 #define VX_MEM_READ_WRITE           0x3
 #define VX_MEM_PIN_MEMORY           0x4
 
+// performance counters per core
+#define VX_MPM_NUM_COUNTERS         32
+
+// performance export formats
+#define VX_PERF_FORMAT_JSON         0x0
+#define VX_PERF_FORMAT_CSV          0x1
+
+// kernel launch flags
+#define VX_START_WARM_CACHES        0x1   // skip the cache initialization pass
+
+// command event status
+#define VX_EVENT_COMPLETE           0x0
+#define VX_EVENT_PENDING            0x1
+#define VX_EVENT_ERROR              0x2
+
 // open the device and connect to it
 int vx_dev_open(vx_device_h* hdevice);
 
@@ -92,6 +109,13 @@ int vx_mem_free(vx_buffer_h hbuffer);
 // set device memory access rights
 int vx_mem_access(vx_buffer_h hbuffer, uint64_t offset, uint64_t size, int flags);
 
+// map device memory into the host address space (VX_MEM_READ/VX_MEM_WRITE access),
+// shared with the device where supported, otherwise staged until unmapped
+int vx_mem_map(vx_buffer_h hbuffer, uint64_t offset, uint64_t size, int flags, void** host_ptr);
+
+// unmap device memory from the host address space
+int vx_mem_unmap(vx_buffer_h hbuffer, void* host_ptr);
+
 // return device memory address
 int vx_mem_address(vx_buffer_h hbuffer, uint64_t* address);
 
@@ -104,9 +128,21 @@ int vx_copy_to_dev(vx_buffer_h hbuffer, const void* host_ptr, uint64_t dst_offse
 // Copy bytes from device memory to host
 int vx_copy_from_dev(void* host_ptr, vx_buffer_h hbuffer, uint64_t src_offset, uint64_t size);
 
+// Copy bytes between device buffers of the same device (ranges may overlap)
+int vx_copy_dev_to_dev(vx_buffer_h hdst, uint64_t dst_offset, vx_buffer_h hsrc, uint64_t src_offset, uint64_t size);
+
+// Fill device memory with a repeating pattern
+int vx_mem_fill(vx_buffer_h hbuffer, uint64_t offset, uint64_t size, const void* pattern, uint32_t pattern_size);
+
 // Start device execution
 int vx_start(vx_device_h hdevice, vx_buffer_h hkernel, vx_buffer_h harguments);
 
+// Start device execution with launch flags
+int vx_start_ex(vx_device_h hdevice, vx_buffer_h hkernel, vx_buffer_h harguments, int flags);
+
+// Invalidate device caches, the next launch starts with cold caches
+int vx_cache_flush(vx_device_h hdevice);
+
 // Wait for device ready with milliseconds timeout
 int vx_ready_wait(vx_device_h hdevice, uint64_t timeout);
 
@@ -119,12 +155,72 @@ int vx_dcr_write(vx_device_h hdevice, uint32_t addr, uint32_t value);
 // query device performance counter
 int vx_mpm_query(vx_device_h hdevice, uint32_t addr, uint32_t core_id, uint64_t* value);
 
+// read all device performance counters in a single transfer
+// values[core_id * VX_MPM_NUM_COUNTERS + (addr - VX_CSR_MPM_BASE)], for all cores
+int vx_mpm_snapshot(vx_device_h hdevice, uint64_t* values);
+
+////////////////////////////// COMMAND QUEUES /////////////////////////////////
+
+// Commands in a queue execute in order on a background thread, overlapping with
+// host execution. A failed command fails all subsequent commands in its queue.
+// Host buffers passed to enqueued copies must remain valid until completion.
+// Event outputs are optional and must be released with vx_event_release.
+// A device runs one kernel at a time: a launch, from a queue or vx_start, waits
+// for the kernel in flight to complete. A running kernel does not block other
+// queues and host calls, though a driver may defer their memory accesses until
+// the kernel completes. The kernel binary, its arguments and any buffer the
+// kernel reads or writes must not be modified, freed or mapped until the launch
+// completes, and buffers the kernel writes must not be read back before then;
+// order such commands after the launch or its event.
+// Performance counters are only updated when a launch completes.
+
+// create a command queue on the device
+int vx_queue_create(vx_device_h hdevice, vx_queue_h* hqueue);
+
+// wait for pending commands and release the queue
+int vx_queue_destroy(vx_queue_h hqueue);
+
+// wait for pending commands with milliseconds timeout
+int vx_queue_finish(vx_queue_h hqueue, uint64_t timeout);
+
+// enqueue a copy from host to device memory
+int vx_enqueue_copy_to_dev(vx_queue_h hqueue, vx_buffer_h hbuffer, const void* host_ptr, uint64_t dst_offset, uint64_t size, vx_event_h* hevent);
+
+// enqueue a copy from device memory to host
+int vx_enqueue_copy_from_dev(vx_queue_h hqueue, void* host_ptr, vx_buffer_h hbuffer, uint64_t src_offset, uint64_t size, vx_event_h* hevent);
+
+// enqueue a copy between device buffers
+int vx_enqueue_copy_dev_to_dev(vx_queue_h hqueue, vx_buffer_h hdst, uint64_t dst_offset, vx_buffer_h hsrc, uint64_t src_offset, uint64_t size, vx_event_h* hevent);
+
+// enqueue a fill of device memory (the pattern is captured at enqueue time)
+int vx_enqueue_fill(vx_queue_h hqueue, vx_buffer_h hbuffer, uint64_t offset, uint64_t size, const void* pattern, uint32_t pattern_size, vx_event_h* hevent);
+
+// enqueue a kernel launch, completing when the device is ready
+int vx_enqueue_start(vx_queue_h hqueue, vx_buffer_h hkernel, vx_buffer_h harguments, vx_event_h* hevent);
+
+// enqueue a kernel launch with launch flags
+int vx_enqueue_start_ex(vx_queue_h hqueue, vx_buffer_h hkernel, vx_buffer_h harguments, int flags, vx_event_h* hevent);
+
+// enqueue a barrier, holding subsequent commands until the events (possibly from other queues) complete
+int vx_enqueue_barrier(vx_queue_h hqueue, uint32_t num_events, const vx_event_h* events, vx_event_h* hevent);
+
+// wait for an event with milliseconds timeout, returns the command status
+int vx_event_wait(vx_event_h hevent, uint64_t timeout);
+
+// query event status (VX_EVENT_*)
+int vx_event_query(vx_event_h hevent, int* status);
+
+// release an event
+int vx_event_release(vx_event_h hevent);
+
 ////////////////////////////// UTILITY FUNCTIONS //////////////////////////////
 
-// upload bytes to device
+// upload kernel image to device
+// (with VORTEX_KERNEL_CACHE=1, identical images share a refcounted resident
+// buffer, released with vx_mem_free, and keep their .data globals across launches)
 int vx_upload_kernel_bytes(vx_device_h hdevice, const void* content, uint64_t size, vx_buffer_h* hbuffer);
 
-// upload file to device
+// upload kernel file to device
 int vx_upload_kernel_file(vx_device_h hdevice, const char* filename, vx_buffer_h* hbuffer);
 
 // upload bytes to device
@@ -139,6 +235,9 @@ int vx_check_occupancy(vx_device_h hdevice, uint32_t group_size, uint32_t* max_l
 // performance counters
 int vx_dump_perf(vx_device_h hdevice, FILE* stream);
 
+// export performance counters and derived metrics (VX_PERF_FORMAT_*)
+int vx_export_perf(vx_device_h hdevice, FILE* stream, int format);
+
 #ifdef __cplusplus
 }
 #endif
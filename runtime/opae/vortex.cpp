@@ -377,7 +377,18 @@ public:
     return 0;
   }
 
-  int start(uint64_t krnl_addr, uint64_t args_addr) {
+  int copy(uint64_t dst_addr, uint64_t src_addr, uint64_t size) {
+    return staged_copy(this, dst_addr, src_addr, size);
+  }
+
+  int fill(uint64_t addr, uint64_t size, const void* pattern, uint32_t pattern_size) {
+    return staged_fill(this, addr, size, pattern, pattern_size);
+  }
+
+  int start(uint64_t krnl_addr, uint64_t args_addr, int flags) {
+    // launches always start from reset
+    __unused (flags);
+
     // set kernel info
     CHECK_ERR(this->dcr_write(VX_DCR_BASE_STARTUP_ADDR0, krnl_addr & 0xffffffff), {
       return err;
@@ -405,6 +416,7 @@ public:
 
   int ready_wait(uint64_t timeout) {
     std::unordered_map<uint32_t, std::stringstream> print_bufs;
+    bool poll = (0 == timeout); // a zero timeout only polls
 
     struct timespec sleep_time;
     sleep_time.tv_sec = 0;
@@ -449,7 +461,9 @@ public:
           }
         }
         if (state != 0) {
-          fprintf(stdout, "[VXDRV] ready-wait timed out: state=%d\n", state);
+          if (!poll) {
+            fprintf(stdout, "[VXDRV] ready-wait timed out: state=%d\n", state);
+          }
           return -1;
         }
         break;
@@ -462,6 +476,11 @@ public:
     return 0;
   }
 
+  int cache_flush() {
+    // caches are reset with each launch
+    return 0;
+  }
+
   int dcr_write(uint32_t addr, uint32_t value) {
     CHECK_FPGA_ERR(api_.fpgaWriteMMIO64(fpga_, 0, MMIO_CMD_ARG0, addr), {
       return -1;
@@ -494,6 +513,30 @@ public:
     return 0;
   }
 
+  int mpm_snapshot(uint64_t* values) {
+    // the counter blocks of all cores are contiguous
+    uint64_t num_cores;
+    CHECK_ERR(this->get_caps(VX_CAPS_NUM_CORES, &num_cores), {
+      return err;
+    });
+    CHECK_ERR(this->download(values, IO_MPM_ADDR, num_cores * 32 * sizeof(uint64_t)), {
+      return err;
+    });
+    for (uint32_t core_id = 0; core_id < num_cores; ++core_id) {
+      auto& block = mpm_cache_[core_id];
+      std::copy(values + core_id * 32, values + (core_id + 1) * 32, block.begin());
+    }
+    return 0;
+  }
+
+  int mem_map(uint64_t dev_addr, uint64_t size, int flags, void** host_ptr) {
+    return staging_.map(this, dev_addr, size, flags, host_ptr);
+  }
+
+  int mem_unmap(void* host_ptr) {
+    return staging_.unmap(this, host_ptr);
+  }
+
 private:
 
   int ensure_staging(uint64_t size) {
@@ -533,6 +576,7 @@ private:
   uint8_t *staging_ptr_;
   uint64_t staging_size_;
   std::unordered_map<uint32_t, std::array<uint64_t, 32>> mpm_cache_;
+  MemStaging staging_;
 };
 
 #include <callbacks.inc>
\ No newline at end of file
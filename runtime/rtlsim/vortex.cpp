@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <algorithm>
 #include <iostream>
 #include <future>
 #include <list>
@@ -125,6 +126,9 @@ public:
     if (dev_addr + asize > GLOBAL_MEM_SIZE)
       return -1;
 
+    if (future_.valid()) {
+      future_.wait(); // the simulation owns the memory while it runs
+    }
     if (flags | VX_MEM_WRITE) {
       flags |= VX_MEM_READ; // ensure caches can handle fill requests
     }
@@ -147,6 +151,9 @@ public:
     if (dest_addr + asize > GLOBAL_MEM_SIZE)
       return -1;
 
+    if (future_.valid()) {
+      future_.wait(); // the simulation owns the memory while it runs
+    }
     ram_.enable_acl(false);
     ram_.write((const uint8_t*)src, dest_addr, size);
     ram_.enable_acl(true);
@@ -168,6 +175,9 @@ public:
     if (src_addr + asize > GLOBAL_MEM_SIZE)
       return -1;
 
+    if (future_.valid()) {
+      future_.wait(); // the simulation owns the memory while it runs
+    }
     ram_.enable_acl(false);
     ram_.read((uint8_t*)dest, src_addr, size);
     ram_.enable_acl(true);
@@ -184,7 +194,41 @@ public:
     return 0;
   }
 
-  int start(uint64_t krnl_addr, uint64_t args_addr) {
+  int copy(uint64_t dst_addr, uint64_t src_addr, uint64_t size) {
+    uint64_t asize = aligned_size(size, CACHE_BLOCK_SIZE);
+    if (dst_addr + asize > GLOBAL_MEM_SIZE
+     || src_addr + asize > GLOBAL_MEM_SIZE)
+      return -1;
+
+    if (future_.valid()) {
+      future_.wait(); // the simulation owns the memory while it runs
+    }
+    ram_.enable_acl(false);
+    ram_.copy(dst_addr, src_addr, size);
+    ram_.enable_acl(true);
+
+    return 0;
+  }
+
+  int fill(uint64_t addr, uint64_t size, const void* pattern, uint32_t pattern_size) {
+    uint64_t asize = aligned_size(size, CACHE_BLOCK_SIZE);
+    if (addr + asize > GLOBAL_MEM_SIZE)
+      return -1;
+
+    if (future_.valid()) {
+      future_.wait(); // the simulation owns the memory while it runs
+    }
+    ram_.enable_acl(false);
+    ram_.fill(addr, size, pattern, pattern_size);
+    ram_.enable_acl(true);
+
+    return 0;
+  }
+
+  int start(uint64_t krnl_addr, uint64_t args_addr, int flags) {
+    // launches always start from reset
+    __unused (flags);
+
     // ensure prior run completed
     if (future_.valid()) {
       future_.wait();
@@ -210,6 +254,9 @@ public:
   int ready_wait(uint64_t timeout) {
     if (!future_.valid())
       return 0;
+    // a zero timeout only polls
+    if (0 == timeout)
+      return (future_.wait_for(std::chrono::seconds(0)) == std::future_status::ready) ? 0 : -1;
     uint64_t timeout_sec = timeout / 1000;
     std::chrono::seconds wait_time(1);
     for (;;) {
@@ -223,6 +270,11 @@ public:
     return 0;
   }
 
+  int cache_flush() {
+    // caches are reset with each launch
+    return 0;
+  }
+
   int dcr_write(uint32_t addr, uint32_t value) {
     if (future_.valid()) {
       future_.wait(); // ensure prior run completed
@@ -250,6 +302,30 @@ public:
     return 0;
   }
 
+  int mpm_snapshot(uint64_t* values) {
+    // the counter blocks of all cores are contiguous
+    uint64_t num_cores;
+    CHECK_ERR(this->get_caps(VX_CAPS_NUM_CORES, &num_cores), {
+      return err;
+    });
+    CHECK_ERR(this->download(values, IO_MPM_ADDR, num_cores * 32 * sizeof(uint64_t)), {
+      return err;
+    });
+    for (uint32_t core_id = 0; core_id < num_cores; ++core_id) {
+      auto& block = mpm_cache_[core_id];
+      std::copy(values + core_id * 32, values + (core_id + 1) * 32, block.begin());
+    }
+    return 0;
+  }
+
+  int mem_map(uint64_t dev_addr, uint64_t size, int flags, void** host_ptr) {
+    return staging_.map(this, dev_addr, size, flags, host_ptr);
+  }
+
+  int mem_unmap(void* host_ptr) {
+    return staging_.unmap(this, host_ptr);
+  }
+
 private:
 
   RAM                 ram_;
@@ -258,6 +334,7 @@ private:
   DeviceConfig        dcrs_;
   std::future<void>   future_;
   std::unordered_map<uint32_t, std::array<uint64_t, 32>> mpm_cache_;
+  MemStaging staging_;
 };
 
 #include <callbacks.inc>
\ No newline at end of file
@@ -21,7 +21,11 @@
 
 #include <assert.h>
 #include <chrono>
-#include <future>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <iostream>
 #include <stdint.h>
 #include <stdio.h>
@@ -42,33 +46,103 @@
 #include <mem.h>
 #include <processor.h>
 #include <unordered_map>
+#include <algorithm>
+#include <string.h>
+#include <vector>
 #endif
 
 using namespace vortex;
 
+// Devices open in the process are numbered from 0, a new device takes the
+// lowest free id. The simulator uses it to name per-device output files.
+static std::mutex g_device_ids_mutex;
+static std::vector<bool> g_device_ids;
+
+struct DeviceId {
+  DeviceId() : value(0) {
+    std::lock_guard<std::mutex> lock(g_device_ids_mutex);
+    while (value < g_device_ids.size() && g_device_ids[value]) {
+      ++value;
+    }
+    if (value == g_device_ids.size()) {
+      g_device_ids.push_back(false);
+    }
+    g_device_ids[value] = true;
+  }
+
+  ~DeviceId() {
+    std::lock_guard<std::mutex> lock(g_device_ids_mutex);
+    g_device_ids[value] = false;
+  }
+
+  uint32_t value;
+};
+
+// Single-producer single-consumer ring of pending kernel launches
+template <typename T, uint32_t Size>
+class LaunchQueue {
+public:
+  LaunchQueue() : head_(0), tail_(0) {}
+
+  bool try_push(const T& value) {
+    auto tail = tail_.load(std::memory_order_relaxed);
+    auto next = (tail + 1) % Size;
+    if (next == head_.load(std::memory_order_acquire))
+      return false;
+    slots_[tail] = value;
+    tail_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  bool try_pop(T* value) {
+    auto head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire))
+      return false;
+    *value = slots_[head];
+    head_.store((head + 1) % Size, std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const {
+    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+  }
+
+  bool full() const {
+    return (tail_.load(std::memory_order_acquire) + 1) % Size == head_.load(std::memory_order_acquire);
+  }
+
+private:
+  std::array<T, Size> slots_;
+  std::atomic<uint32_t> head_;
+  std::atomic<uint32_t> tail_;
+};
+
 class vx_device {
 public:
   vx_device()
-      : arch_(NUM_THREADS, NUM_WARPS, NUM_CORES), ram_(0, MEM_PAGE_SIZE), processor_(arch_), global_mem_(ALLOC_BASE_ADDR, GLOBAL_MEM_SIZE - ALLOC_BASE_ADDR, MEM_PAGE_SIZE, CACHE_BLOCK_SIZE) {
+      : arch_(NUM_THREADS, NUM_WARPS, NUM_CORES), ram_(0, MEM_PAGE_SIZE), processor_(arch_, device_id_.value), global_mem_(ALLOC_BASE_ADDR, GLOBAL_MEM_SIZE - ALLOC_BASE_ADDR, MEM_PAGE_SIZE, CACHE_BLOCK_SIZE) {
     // attach memory module
     processor_.attach_ram(&ram_);
 #ifdef VM_ENABLE
     std::cout << "*** VM ENABLED!! ***" << std::endl;
     CHECK_ERR(init_VM(), );
 #endif
+    // the simulation thread lives as long as the device
+    worker_ = std::thread([this] { this->run_launches(); });
   }
 
   ~vx_device() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      exiting_ = true;
+    }
+    cv_.notify_all();
+    worker_.join();
 #ifdef VM_ENABLE
     global_mem_.release(PAGE_TABLE_BASE_ADDR);
-    // for (auto i = addr_mapping.begin(); i != addr_mapping.end(); i++)
-    //   page_table_mem_->release(i->second << MEM_PAGE_SIZE);
     delete virtual_mem_;
     delete page_table_mem_;
 #endif
-    if (future_.valid()) {
-      future_.wait();
-    }
   }
 
   int init() {
@@ -119,22 +193,6 @@ public:
 
 #ifdef VM_ENABLE
 
-  // physical (ppn) to virtual (vpn) mapping
-  uint64_t map_p2v(uint64_t ppn, uint32_t flags) {
-    DBGPRINT(" [RT:MAP_P2V] ppn: %lx\n", ppn);
-    if (addr_mapping.find(ppn) != addr_mapping.end())
-      return addr_mapping[ppn];
-
-    // If ppn to vpn mapping doesnt exist, create mapping
-    DBGPRINT(" [RT:MAP_P2V] Not found. Allocate new page table or update a PTE.\n");
-    uint64_t vpn;
-    virtual_mem_->allocate(MEM_PAGE_SIZE, &vpn);
-    vpn = vpn >> MEM_PAGE_LOG2_SIZE;
-    CHECK_ERR(update_page_table(ppn, vpn, flags), );
-    addr_mapping[ppn] = vpn;
-    return vpn;
-  }
-
   bool need_trans(uint64_t dev_pAddr) {
 
     // Check if the satp is set and BARE mode
@@ -157,7 +215,7 @@ public:
     return 1;
   }
 
-  uint64_t phy_to_virt_map(uint64_t size, uint64_t *dev_pAddr, uint32_t flags) {
+  int phy_to_virt_map(uint64_t size, uint64_t *dev_pAddr, uint32_t flags) {
     DBGPRINT(" [RT:PTV_MAP] size = 0x%lx, dev_pAddr= 0x%lx, flags = 0x%x\n", size, *dev_pAddr, flags);
     DBGPRINT(" [RT:PTV_MAP] bit mode: %d\n", XLEN);
 
@@ -166,24 +224,34 @@ public:
       return 0;
     }
 
-    uint64_t init_pAddr = *dev_pAddr;
-    uint64_t init_vAddr = (map_p2v(init_pAddr >> MEM_PAGE_LOG2_SIZE, flags) << MEM_PAGE_LOG2_SIZE) | (init_pAddr & ((1 << MEM_PAGE_LOG2_SIZE) - 1));
-    uint64_t ppn = 0, vpn = 0;
-
-    // dev_pAddr can be of size greater than a page, but we have to map and update
-    // page tables on a page table granularity. So divide the allocation into pages.
-    // FUTURE Work: Super Page
-    for (ppn = (*dev_pAddr >> MEM_PAGE_LOG2_SIZE); ppn < ((*dev_pAddr) >> MEM_PAGE_LOG2_SIZE) + (size >> MEM_PAGE_LOG2_SIZE); ppn++) {
-      vpn = map_p2v(ppn, flags) >> MEM_PAGE_LOG2_SIZE;
-      DBGPRINT(" [RT:PTV_MAP] Search vpn in page table:0x%lx\n", vpn);
-      // Currently a 1-1 mapping is used, this can be changed here to support different
-      // mapping schemes
+    uint64_t pAddr = *dev_pAddr;
+
+    // Give the virtual range the same offset as the physical range within the
+    // largest page that fits, so that map_range() can use superpages.
+    uint64_t align = MEM_PAGE_SIZE;
+    for (uint32_t level = 1; level < PT_LEVEL; ++level) {
+      uint64_t page_size = uint64_t(1) << vAddr_t::page_bits(level);
+      if (page_size > size)
+        break;
+      align = page_size;
     }
-    DBGPRINT(" [RT:PTV_MAP] Mapped virtual addr: 0x%lx to physical addr: 0x%lx\n", init_vAddr, init_pAddr);
+    uint64_t vbase;
+    CHECK_ERR(virtual_mem_->allocate(size + align - MEM_PAGE_SIZE, &vbase), {
+      return err;
+    });
+    uint64_t vAddr = vbase + ((pAddr - vbase) & (align - 1));
+
+    CHECK_ERR(map_range(vAddr, pAddr, size, flags), {
+      virtual_mem_->release(vbase);
+      return err;
+    });
+    vm_ranges_[vAddr] = {vbase, pAddr, size};
+
+    DBGPRINT(" [RT:PTV_MAP] Mapped virtual addr: 0x%lx to physical addr: 0x%lx\n", vAddr, pAddr);
     // Sanity check
-    assert(page_table_walk(init_vAddr) == init_pAddr && "ERROR: translated virtual Addresses are not the same with physical Address\n");
+    assert(page_table_walk(vAddr) == pAddr && "ERROR: translated virtual Addresses are not the same with physical Address\n");
 
-    *dev_pAddr = init_vAddr; // commit vpn to be returned to host
+    *dev_pAddr = vAddr; // commit vpn to be returned to host
     DBGPRINT(" [RT:PTV_MAP] Translated device virtual addr: 0x%lx\n", *dev_pAddr);
 
     return 0;
@@ -210,7 +278,10 @@ public:
     *dev_addr = addr;
 #ifdef VM_ENABLE
     // VM address translation
-    phy_to_virt_map(asize, dev_addr, flags);
+    CHECK_ERR(phy_to_virt_map(asize, dev_addr, flags), {
+      global_mem_.release(addr);
+      return err;
+    });
 #endif
     return 0;
   }
@@ -233,9 +304,20 @@ public:
   }
 
   int mem_free(uint64_t dev_addr) {
+    this->wait_idle();
 #ifdef VM_ENABLE
-    uint64_t paddr = page_table_walk(dev_addr);
-    return global_mem_.release(paddr);
+    auto it = vm_ranges_.find(dev_addr);
+    if (it == vm_ranges_.end()) {
+      uint64_t paddr = page_table_walk(dev_addr);
+      return global_mem_.release(paddr);
+    }
+    auto range = it->second;
+    vm_ranges_.erase(it);
+    CHECK_ERR(unmap_range(dev_addr, range.size), {
+      return err;
+    });
+    virtual_mem_->release(range.vbase);
+    return global_mem_.release(range.paddr);
 #else
     return global_mem_.release(dev_addr);
 #endif
@@ -246,6 +328,7 @@ public:
     if (dev_addr + asize > GLOBAL_MEM_SIZE)
       return -1;
 
+    this->wait_idle();
     ram_.set_acl(dev_addr, size, flags);
     return 0;
   }
@@ -262,6 +345,7 @@ public:
     uint64_t asize = aligned_size(size, CACHE_BLOCK_SIZE);
     if (dest_addr + asize > GLOBAL_MEM_SIZE)
       return -1;
+    this->wait_idle();
 #ifdef VM_ENABLE
     uint64_t pAddr = page_table_walk(dest_addr);
     // uint64_t pAddr;
@@ -293,6 +377,7 @@ public:
     uint64_t asize = aligned_size(size, CACHE_BLOCK_SIZE);
     if (src_addr + asize > GLOBAL_MEM_SIZE)
       return -1;
+    this->wait_idle();
 #ifdef VM_ENABLE
     uint64_t pAddr = page_table_walk(src_addr);
     DBGPRINT("  [RT:download] Download data to vAddr = 0x%lx (pAddr=0x%lx)\n", src_addr, pAddr);
@@ -311,20 +396,89 @@ public:
     return 0;
   }
 
-  int start(uint64_t krnl_addr, uint64_t args_addr) {
-    // ensure prior run completed
-    if (future_.valid()) {
-      future_.wait();
-    }
+  int copy(uint64_t dst_addr, uint64_t src_addr, uint64_t size) {
+    uint64_t asize = aligned_size(size, CACHE_BLOCK_SIZE);
+    if (dst_addr + asize > GLOBAL_MEM_SIZE
+     || src_addr + asize > GLOBAL_MEM_SIZE)
+      return -1;
+    this->wait_idle();
+#ifdef VM_ENABLE
+    // allocations are physically contiguous
+    dst_addr = page_table_walk(dst_addr);
+    src_addr = page_table_walk(src_addr);
+#endif
 
-    // set kernel info
-    this->dcr_write(VX_DCR_BASE_STARTUP_ADDR0, krnl_addr & 0xffffffff);
-    this->dcr_write(VX_DCR_BASE_STARTUP_ADDR1, krnl_addr >> 32);
-    this->dcr_write(VX_DCR_BASE_STARTUP_ARG0, args_addr & 0xffffffff);
-    this->dcr_write(VX_DCR_BASE_STARTUP_ARG1, args_addr >> 32);
+    ram_.enable_acl(false);
+    ram_.copy(dst_addr, src_addr, size);
+    ram_.enable_acl(true);
 
-    // start new run
-    future_ = std::async(std::launch::async, [&] { processor_.run(); });
+    return 0;
+  }
+
+  int fill(uint64_t addr, uint64_t size, const void* pattern, uint32_t pattern_size) {
+    uint64_t asize = aligned_size(size, CACHE_BLOCK_SIZE);
+    if (addr + asize > GLOBAL_MEM_SIZE)
+      return -1;
+    this->wait_idle();
+#ifdef VM_ENABLE
+    addr = page_table_walk(addr);
+#endif
+
+    ram_.enable_acl(false);
+    ram_.fill(addr, size, pattern, pattern_size);
+    ram_.enable_acl(true);
+
+    return 0;
+  }
+
+  int mem_map(uint64_t dev_addr, uint64_t size, int flags, void** host_ptr) {
+    __unused (flags);
+    uint64_t asize = aligned_size(size, CACHE_BLOCK_SIZE);
+    if (dev_addr + asize > GLOBAL_MEM_SIZE)
+      return -1;
+    // pages cannot move while the device is running
+    this->wait_idle();
+#ifdef VM_ENABLE
+    // allocations are physically contiguous
+    dev_addr = page_table_walk(dev_addr);
+#endif
+    // the host shares the simulated memory directly
+    auto ptr = ram_.map(dev_addr, size);
+    if (ptr == nullptr)
+      return -1;
+    mapped_.emplace(ptr, dev_addr);
+    *host_ptr = ptr;
+    return 0;
+  }
+
+  int mem_unmap(void* host_ptr) {
+    auto it = mapped_.find(host_ptr);
+    if (it == mapped_.end())
+      return -1;
+    this->wait_idle();
+    ram_.unmap(it->second);
+    mapped_.erase(it);
+    return 0;
+  }
+
+  int start(uint64_t krnl_addr, uint64_t args_addr, int flags) {
+    // set kernel info
+    dcrs_.write(VX_DCR_BASE_STARTUP_ADDR0, krnl_addr & 0xffffffff);
+    dcrs_.write(VX_DCR_BASE_STARTUP_ADDR1, krnl_addr >> 32);
+    dcrs_.write(VX_DCR_BASE_STARTUP_ARG0, args_addr & 0xffffffff);
+    dcrs_.write(VX_DCR_BASE_STARTUP_ARG1, args_addr >> 32);
+
+    // hand the launch to the simulation thread
+    launch_t launch{krnl_addr, args_addr, flags};
+    while (!launches_.try_push(launch)) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&] { return !launches_.full(); });
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++submitted_;
+    }
+    cv_.notify_all();
 
     // clear mpm cache
     mpm_cache_.clear();
@@ -333,14 +487,15 @@ public:
   }
 
   int ready_wait(uint64_t timeout) {
-    if (!future_.valid())
-      return 0;
     uint64_t timeout_sec = timeout / 1000;
     std::chrono::seconds wait_time(1);
+    std::unique_lock<std::mutex> lock(mutex_);
+    // a zero timeout only polls
+    if (0 == timeout)
+      return (completed_ == submitted_) ? 0 : -1;
     for (;;) {
       // wait for 1 sec and check status
-      auto status = future_.wait_for(wait_time);
-      if (status == std::future_status::ready)
+      if (cv_.wait_for(lock, wait_time, [&] { return completed_ == submitted_; }))
         break;
       if (0 == timeout_sec--)
         return -1;
@@ -348,10 +503,14 @@ public:
     return 0;
   }
 
+  int cache_flush() {
+    this->wait_idle();
+    processor_.invalidate_caches();
+    return 0;
+  }
+
   int dcr_write(uint32_t addr, uint32_t value) {
-    if (future_.valid()) {
-      future_.wait(); // ensure prior run completed
-    }
+    this->wait_idle(); // ensure prior run completed
     processor_.dcr_write(addr, value);
     dcrs_.write(addr, value);
     return 0;
@@ -374,6 +533,22 @@ public:
     *value = mpm_cache_.at(core_id).at(offset);
     return 0;
   }
+
+  int mpm_snapshot(uint64_t* values) {
+    // the counter blocks of all cores are contiguous
+    uint64_t num_cores;
+    CHECK_ERR(this->get_caps(VX_CAPS_NUM_CORES, &num_cores), {
+      return err;
+    });
+    CHECK_ERR(this->download(values, IO_MPM_ADDR, num_cores * 32 * sizeof(uint64_t)), {
+      return err;
+    });
+    for (uint32_t core_id = 0; core_id < num_cores; ++core_id) {
+      auto& block = mpm_cache_[core_id];
+      std::copy(values + core_id * 32, values + (core_id + 1) * 32, block.begin());
+    }
+    return 0;
+  }
 #ifdef VM_ENABLE
   /* VM Management */
 
@@ -465,54 +640,106 @@ public:
     return processor_.get_satp_mode();
   }
 
-  int16_t update_page_table(uint64_t ppn, uint64_t vpn, uint32_t flag) {
-    DBGPRINT("  [RT:Update PT] Mapping vpn 0x%05lx to ppn 0x%05lx(flags = %u)\n", vpn, ppn, flag);
-    // sanity check
-#if VM_ADDR_MODE == SV39
-    assert((((ppn >> 44) == 0) && ((vpn >> 27) == 0)) && "Upper bits are not zero!");
-    uint8_t level = 3;
-#else // Default is SV32, BARE will not reach this point.
-    assert((((ppn >> 20) == 0) && ((vpn >> 20) == 0)) && "Upper 12 bits are not zero!");
-    uint8_t level = 2;
-#endif
-    int i = level - 1;
-    vAddr_t vaddr(vpn << MEM_PAGE_LOG2_SIZE);
-    uint64_t pte_addr = 0, pte_bytes = 0;
-    uint64_t pt_addr = 0;
+  // Return the base ppn of the page table holding the level-`level` PTE of
+  // vAddr, allocating the intermediate tables as needed.
+  int get_page_table(uint64_t vAddr, uint32_t level, uint64_t *table_ppn) {
+    vAddr_t vaddr(vAddr);
     uint64_t cur_base_ppn = get_base_ppn();
-
-    while (i >= 0) {
-      DBGPRINT("  [RT:Update PT]Start %u-level page table\n", i);
-      pte_addr = get_pte_address(cur_base_ppn, vaddr.vpn[i]);
-      pte_bytes = read_pte(pte_addr);
-      PTE_t pte_chk(pte_bytes);
-      DBGPRINT("  [RT:Update PT] PTE addr 0x%lx, PTE bytes 0x%lx\n", pte_addr, pte_bytes);
-      if (pte_chk.v == 1 && ((pte_bytes & 0xFFFFFFFF) != 0xbaadf00d)) {
-        DBGPRINT("  [RT:Update PT] PTE valid (ppn 0x%lx), continuing the walk...\n", pte_chk.ppn);
-        cur_base_ppn = pte_chk.ppn;
+    for (int i = PT_LEVEL - 1; i > (int)level; --i) {
+      uint64_t pte_addr = get_pte_address(cur_base_ppn, vaddr.vpn[i]);
+      PTE_t pte(read_pte(pte_addr));
+      if (pte.v) {
+        // a superpage already covers this address
+        if (pte.r | pte.w | pte.x)
+          return -1;
+        cur_base_ppn = pte.ppn;
       } else {
-        // If valid bit not set, allocate a next level page table
-        DBGPRINT("  [RT:Update PT] PTE Invalid (ppn 0x%lx) ...\n", pte_chk.ppn);
-        if (i == 0) {
-          // Reach to leaf
-          DBGPRINT("  [RT:Update PT] Reached to level 0. This should be a leaf node(flag = %x) \n", flag);
-          uint32_t pte_flag = (flag << 1) | 0x3;
-          PTE_t new_pte(ppn << MEM_PAGE_LOG2_SIZE, pte_flag);
-          write_pte(pte_addr, new_pte.pte_bytes);
+        // Set rwx = 000 in PTE to indicate this is a pointer to the next level of the page table.
+        uint64_t pt_addr;
+        CHECK_ERR(alloc_page_table(&pt_addr), { return err; });
+        PTE_t new_pte(pt_addr, 0x1);
+        write_pte(pte_addr, new_pte.pte_bytes);
+        cur_base_ppn = new_pte.ppn;
+      }
+    }
+    *table_ppn = cur_base_ppn;
+    return 0;
+  }
+
+  // Map [vAddr, vAddr + size) to [pAddr, pAddr + size).
+  // Each step writes a run of leaf PTEs in one page table, using the largest
+  // page size that the alignment of both addresses and the remaining size permit.
+  int map_range(uint64_t vAddr, uint64_t pAddr, uint64_t size, uint32_t flags) {
+    DBGPRINT("  [RT:map_range] vAddr=0x%lx, pAddr=0x%lx, size=0x%lx, flags=%u\n", vAddr, pAddr, size, flags);
+    // flag would READ: 0x1, Write 0x2, RW:0x3, which is matched with PTE flags if it is lsh by one.
+    uint32_t pte_flags = (flags << 1) | 0x3;
+    uint64_t entries = PT_SIZE / PTE_SIZE;
+    std::vector<uint8_t> ptes;
+    int level = PT_LEVEL - 1;
+    while (size != 0) {
+      uint64_t page_size = uint64_t(1) << vAddr_t::page_bits(level);
+      if (level > 0 && (((vAddr | pAddr) & (page_size - 1)) != 0 || size < page_size)) {
+        --level;
+        continue;
+      }
+      vAddr_t vaddr(vAddr);
+      uint64_t table_ppn;
+      CHECK_ERR(get_page_table(vAddr, level, &table_ppn), { return err; });
+      uint64_t pte_addr = get_pte_address(table_ppn, vaddr.vpn[level]);
+      if (level > 0 && PTE_t(read_pte(pte_addr)).v) {
+        // the slot already points to a lower-level table
+        --level;
+        continue;
+      }
+      uint64_t count = std::min(entries - vaddr.vpn[level], size / page_size);
+      ptes.resize(count * PTE_SIZE);
+      for (uint64_t k = 0; k < count; ++k) {
+        PTE_t new_pte(pAddr + k * page_size, pte_flags);
+        memcpy(ptes.data() + k * PTE_SIZE, &new_pte.pte_bytes, PTE_SIZE);
+      }
+      ram_.enable_acl(false);
+      ram_.write(ptes.data(), pte_addr, ptes.size());
+      ram_.enable_acl(true);
+      vAddr += count * page_size;
+      pAddr += count * page_size;
+      size  -= count * page_size;
+      level = PT_LEVEL - 1;
+    }
+    return 0;
+  }
+
+  // Clear the leaf PTEs mapping [vAddr, vAddr + size), one table run at a time.
+  int unmap_range(uint64_t vAddr, uint64_t size) {
+    DBGPRINT("  [RT:unmap_range] vAddr=0x%lx, size=0x%lx\n", vAddr, size);
+    uint64_t entries = PT_SIZE / PTE_SIZE;
+    std::vector<uint8_t> zeros;
+    while (size != 0) {
+      vAddr_t vaddr(vAddr);
+      uint64_t cur_base_ppn = get_base_ppn();
+      int level = PT_LEVEL - 1;
+      uint64_t pte_addr;
+      for (;;) {
+        pte_addr = get_pte_address(cur_base_ppn, vaddr.vpn[level]);
+        PTE_t pte(read_pte(pte_addr));
+        if (!pte.v)
+          return -1;
+        if ((pte.r | pte.w | pte.x) || level == 0)
           break;
-        } else {
-          //  in device memory and store ppn in PTE. Set rwx = 000 in PTE
-          // to indicate this is a pointer to the next level of the page table.
-          // flag would READ: 0x1, Write 0x2, RW:0x3, which is matched with PTE flags if it is lsh by one.
-          alloc_page_table(&pt_addr);
-          uint32_t pte_flag = 0x1;
-          PTE_t new_pte(pt_addr, pte_flag);
-          write_pte(pte_addr, new_pte.pte_bytes);
-          cur_base_ppn = new_pte.ppn;
-        }
+        cur_base_ppn = pte.ppn;
+        --level;
       }
-      i--;
+      uint64_t page_size = uint64_t(1) << vAddr_t::page_bits(level);
+      uint64_t count = std::min(entries - vaddr.vpn[level], (size + page_size - 1) / page_size);
+      zeros.assign(count * PTE_SIZE, 0);
+      ram_.enable_acl(false);
+      ram_.write(zeros.data(), pte_addr, zeros.size());
+      ram_.enable_acl(true);
+      count *= page_size;
+      vAddr += count;
+      size  -= std::min(size, count);
     }
+    // drop stale translations cached by the cores
+    processor_.tlb_flush();
     return 0;
   }
 
@@ -559,12 +786,17 @@ public:
         if (pte.r == 0) {
           throw Page_Fault_Exception("  [RT:PTW] Page Fault : TYPE LOAD, Incorrect permissions.");
         }
+        // Leaves above level 0 map superpages, which must be aligned to their size.
+        if (pte.ppn & ((uint64_t(1) << (i * vAddr_t::VPN_BITS)) - 1)) {
+          throw Page_Fault_Exception("  [RT:PTW] Page Fault : Misaligned superpage.");
+        }
         cur_base_ppn = pte.ppn;
         DBGPRINT("  [RT:PTW] Found PT_Base_Address(0x%lx) on Level %d.\n", pte.ppn, i);
         break;
       }
     }
-    uint64_t paddr = (cur_base_ppn << MEM_PAGE_LOG2_SIZE) + vaddr.pgoff;
+    uint64_t page_mask = (uint64_t(1) << vAddr_t::page_bits(i)) - 1;
+    uint64_t paddr = (cur_base_ppn << MEM_PAGE_LOG2_SIZE) + (vAddr_bits & page_mask);
     return paddr;
   }
 
@@ -579,42 +811,83 @@ public:
 
   void write_pte(uint64_t addr, uint64_t value = 0xbaadf00d) {
     DBGPRINT("  [RT:Write_pte] writing pte 0x%lx to pAddr: 0x%lx\n", value, addr);
-    uint8_t *src = new uint8_t[PTE_SIZE];
+    uint8_t src[PTE_SIZE];
     for (uint64_t i = 0; i < PTE_SIZE; ++i) {
       src[i] = (value >> (i << 3)) & 0xff;
     }
-    // std::cout << "writing PTE to RAM addr 0x" << std::hex << addr << std::endl;
     ram_.enable_acl(false);
     ram_.write((const uint8_t *)src, addr, PTE_SIZE);
     ram_.enable_acl(true);
   }
 
   uint64_t read_pte(uint64_t addr) {
-    uint8_t *dest = new uint8_t[PTE_SIZE];
-#ifdef XLEN_32
-    uint64_t mask = 0x00000000FFFFFFFF;
-#else // 64bit
-    uint64_t mask = 0xFFFFFFFFFFFFFFFF;
-#endif
-
-    ram_.read((uint8_t *)dest, addr, PTE_SIZE);
-    uint64_t ret = (*(uint64_t *)((uint8_t *)dest)) & mask;
+    uint64_t ret = 0;
+    ram_.read((uint8_t *)&ret, addr, PTE_SIZE);
     DBGPRINT("  [RT:read_pte] reading PTE 0x%lx from RAM addr 0x%lx\n", ret, addr);
-
     return ret;
   }
 #endif // VM_ENABLE
 
 private:
+  struct launch_t {
+    uint64_t krnl_addr;
+    uint64_t args_addr;
+    int flags;
+  };
+
+  // host accesses to the memory wait for the running launches, the simulation
+  // thread owns the memory while they run
+  void wait_idle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&] { return completed_ == submitted_; });
+  }
+
+  void run_launches() {
+    for (;;) {
+      launch_t launch;
+      if (!launches_.try_pop(&launch)) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&] { return exiting_ || !launches_.empty(); });
+        if (launches_.empty())
+          break;
+        continue;
+      }
+      // startup registers are applied with the launch
+      processor_.set_startup(launch.krnl_addr, launch.args_addr);
+      processor_.set_warm_start(launch.flags & VX_START_WARM_CACHES);
+      processor_.run();
+
+      // completion also wakes a host waiting on a full queue
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++completed_;
+      }
+      cv_.notify_all();
+    }
+  }
+
   Arch arch_;
+  DeviceId device_id_; // released after the processor
   RAM ram_;
   Processor processor_;
   MemoryAllocator global_mem_;
   DeviceConfig dcrs_;
-  std::future<void> future_;
+  LaunchQueue<launch_t, 64> launches_;
+  std::thread worker_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  uint64_t submitted_ = 0;
+  uint64_t completed_ = 0;
+  bool exiting_ = false;
   std::unordered_map<uint32_t, std::array<uint64_t, 32>> mpm_cache_;
+  std::unordered_multimap<void*, uint64_t> mapped_; // host pointer -> device address
 #ifdef VM_ENABLE
-  std::unordered_map<uint64_t, uint64_t> addr_mapping; // HW: key: ppn; value: vpn
+  struct vm_range_t {
+    uint64_t vbase; // virtual allocation, may start below the mapping
+    uint64_t paddr;
+    uint64_t size;
+  };
+  std::unordered_map<uint64_t, vm_range_t> vm_ranges_; // key: mapped virtual address
   MemoryAllocator *page_table_mem_;
   MemoryAllocator *virtual_mem_;
 #endif
@@ -19,6 +19,8 @@
 #include <cstring>
 #include <vector>
 #include <unordered_map>
+#include <string>
+#include <nlohmann_json.hpp>
 #include <vortex.h>
 #include <assert.h>
 
@@ -46,10 +48,10 @@ int get_profiling_mode() {
   return gProfilingMode.perf_class();
 }
 
-extern int vx_upload_kernel_bytes(vx_device_h hdevice, const void* content, uint64_t size, vx_buffer_h* hbuffer) {
-  if (nullptr == hdevice || nullptr == content || size <= 8 || nullptr == hbuffer)
-    return -1;
+int kernel_cache_upload(vx_device_h hdevice, const void* content, uint64_t size, vx_buffer_h* hbuffer,
+                        int (*upload)(vx_device_h, const void*, uint64_t, vx_buffer_h*));
 
+static int upload_kernel_image(vx_device_h hdevice, const void* content, uint64_t size, vx_buffer_h* hbuffer) {
   auto bytes = reinterpret_cast<const uint64_t*>(content);
 
   auto min_vma = *bytes++;
@@ -84,6 +86,14 @@ extern int vx_upload_kernel_bytes(vx_device_h hdevice, const void* content, uint
   return 0;
 }
 
+extern int vx_upload_kernel_bytes(vx_device_h hdevice, const void* content, uint64_t size, vx_buffer_h* hbuffer) {
+  if (nullptr == hdevice || nullptr == content || size <= 2 * 8 || nullptr == hbuffer)
+    return -1;
+
+  // identical images share a resident device buffer
+  return kernel_cache_upload(hdevice, content, size, hbuffer, upload_kernel_image);
+}
+
 extern int vx_upload_kernel_file(vx_device_h hdevice, const char* filename, vx_buffer_h* hbuffer) {
   if (nullptr == hdevice || nullptr == filename || nullptr == hbuffer)
     return -1;
@@ -195,6 +205,11 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
   uint64_t stores = 0;
   uint64_t ifetch_lat = 0;
   uint64_t load_lat   = 0;
+  uint64_t sched_wait = 0;
+  uint64_t sched_starv = 0;
+  uint64_t tlb_misses = 0;
+  uint64_t tlb_walks = 0;
+  uint64_t tlb_lat = 0;
   // PERF: l2cache
   uint64_t l2cache_reads = 0;
   uint64_t l2cache_writes = 0;
@@ -214,12 +229,45 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
   uint64_t mem_writes = 0;
   uint64_t mem_lat = 0;
   uint64_t mem_bank_stalls = 0;
+  // PERF: dram
+  uint64_t dram_reads = 0;
+  uint64_t dram_writes = 0;
+  uint64_t dram_row_hits = 0;
+  uint64_t dram_row_misses = 0;
+  uint64_t dram_row_conflicts = 0;
+  uint64_t dram_rw_turns = 0;
+  uint64_t dram_queue = 0;
+  uint64_t dram_read_lat = 0;
+  uint64_t dram_cycles = 0;
+  uint64_t dram_bytes = 0;
+  uint64_t dram_ch_reads[VX_CSR_MPM_DRAM_CHANNELS] = {};
+  uint64_t dram_ch_writes[VX_CSR_MPM_DRAM_CHANNELS] = {};
 
   uint64_t num_cores;
   CHECK_ERR(vx_dev_caps(hdevice, VX_CAPS_NUM_CORES, &num_cores), {
     return err;
   });
 
+  uint64_t num_mem_banks;
+  CHECK_ERR(vx_dev_caps(hdevice, VX_CAPS_NUM_MEM_BANKS, &num_mem_banks), {
+    return err;
+  });
+  uint32_t num_dram_channels = std::min<uint64_t>(num_mem_banks, VX_CSR_MPM_DRAM_CHANNELS);
+
+  // fetch all counters at once
+  std::vector<uint64_t> mpm_values(num_cores * VX_MPM_NUM_COUNTERS);
+  CHECK_ERR(vx_mpm_snapshot(hdevice, mpm_values.data()), {
+    return err;
+  });
+
+  auto mpm_read = [&](uint32_t addr, uint32_t core_id, uint64_t* value)->int {
+    uint32_t offset = addr - VX_CSR_MPM_BASE;
+    if (offset >= VX_MPM_NUM_COUNTERS || core_id >= num_cores)
+      return -1;
+    *value = mpm_values.at(core_id * VX_MPM_NUM_COUNTERS + offset);
+    return 0;
+  };
+
   uint64_t isa_flags;
   CHECK_ERR(vx_dev_caps(hdevice, VX_CAPS_ISA_FLAGS, &isa_flags), {
     return err;
@@ -243,12 +291,12 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
 
   for (unsigned core_id = 0; core_id < num_cores; ++core_id) {
     uint64_t cycles_per_core;
-    CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MCYCLE, core_id, &cycles_per_core), {
+    CHECK_ERR(mpm_read(VX_CSR_MCYCLE, core_id, &cycles_per_core), {
       return err;
     });
 
     uint64_t instrs_per_core;
-    CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MINSTRET, core_id, &instrs_per_core), {
+    CHECK_ERR(mpm_read(VX_CSR_MINSTRET, core_id, &instrs_per_core), {
       return err;
     });
 
@@ -258,7 +306,7 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
       // scheduler idles
       {
         uint64_t sched_idles_per_core;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_SCHED_ID, core_id, &sched_idles_per_core), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_SCHED_ID, core_id, &sched_idles_per_core), {
           return err;
         });
         if (num_cores > 1) {
@@ -270,7 +318,7 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
       // scheduler stalls
       {
         uint64_t sched_stalls_per_core;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_SCHED_ST, core_id, &sched_stalls_per_core), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_SCHED_ST, core_id, &sched_stalls_per_core), {
           return err;
         });
         if (num_cores > 1) {
@@ -282,7 +330,7 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
       // ibuffer stalls
       {
         uint64_t ibuffer_stalls_per_core;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_IBUF_ST, core_id, &ibuffer_stalls_per_core), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_IBUF_ST, core_id, &ibuffer_stalls_per_core), {
           return err;
         });
         if (num_cores > 1) {
@@ -294,35 +342,35 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
       // scoreboard stalls
       {
         uint64_t scrb_stalls_per_core;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_SCRB_ST, core_id, &scrb_stalls_per_core), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_SCRB_ST, core_id, &scrb_stalls_per_core), {
           return err;
         });
         uint64_t scrb_alu_per_core;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_SCRB_ALU, core_id, &scrb_alu_per_core), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_SCRB_ALU, core_id, &scrb_alu_per_core), {
           return err;
         });
         uint64_t scrb_fpu_per_core;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_SCRB_FPU, core_id, &scrb_fpu_per_core), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_SCRB_FPU, core_id, &scrb_fpu_per_core), {
           return err;
         });
         uint64_t scrb_lsu_per_core;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_SCRB_LSU, core_id, &scrb_lsu_per_core), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_SCRB_LSU, core_id, &scrb_lsu_per_core), {
           return err;
         });
         uint64_t scrb_vpu_per_core;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_SCRB_VPU, core_id, &scrb_vpu_per_core), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_SCRB_VPU, core_id, &scrb_vpu_per_core), {
           return err;
         });
         uint64_t scrb_tcu_per_core;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_SCRB_TCU, core_id, &scrb_tcu_per_core), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_SCRB_TCU, core_id, &scrb_tcu_per_core), {
           return err;
         });
         uint64_t scrb_csrs_per_core;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_SCRB_CSRS, core_id, &scrb_csrs_per_core), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_SCRB_CSRS, core_id, &scrb_csrs_per_core), {
           return err;
         });
         uint64_t scrb_wctl_per_core;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_SCRB_WCTL, core_id, &scrb_wctl_per_core), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_SCRB_WCTL, core_id, &scrb_wctl_per_core), {
           return err;
         });
         scrb_alu += scrb_alu_per_core;
@@ -369,7 +417,7 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
       // operands stalls
       {
         uint64_t opds_stalls_per_core;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_OPDS_ST, core_id, &opds_stalls_per_core), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_OPDS_ST, core_id, &opds_stalls_per_core), {
           return err;
         });
         if (num_cores > 1) {
@@ -382,14 +430,14 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
       // ifetches
       {
         uint64_t ifetches_per_core;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_IFETCHES, core_id, &ifetches_per_core), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_IFETCHES, core_id, &ifetches_per_core), {
           return err;
         });
         if (num_cores > 1) fprintf(stream, "PERF: core%d: ifetches=%ld\n", core_id, ifetches_per_core);
         ifetches += ifetches_per_core;
 
         uint64_t ifetch_lat_per_core;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_IFETCH_LT, core_id, &ifetch_lat_per_core), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_IFETCH_LT, core_id, &ifetch_lat_per_core), {
           return err;
         });
         if (num_cores > 1) {
@@ -401,14 +449,14 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
       // loads
       {
         uint64_t loads_per_core;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_LOADS, core_id, &loads_per_core), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_LOADS, core_id, &loads_per_core), {
           return err;
         });
         if (num_cores > 1) fprintf(stream, "PERF: core%d: loads=%ld\n", core_id, loads_per_core);
         loads += loads_per_core;
 
         uint64_t load_lat_per_core;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_LOAD_LT, core_id, &load_lat_per_core), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_LOAD_LT, core_id, &load_lat_per_core), {
           return err;
         });
         if (num_cores > 1) {
@@ -420,26 +468,63 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
       // stores
       {
         uint64_t stores_per_core;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_STORES, core_id, &stores_per_core), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_STORES, core_id, &stores_per_core), {
           return err;
         });
         if (num_cores > 1) fprintf(stream, "PERF: core%d: stores=%ld\n", core_id, stores_per_core);
         stores += stores_per_core;
       }
+      // warp scheduler fairness
+      {
+        uint64_t sched_wait_per_core;
+        CHECK_ERR(mpm_read(VX_CSR_MPM_SCHED_WAIT, core_id, &sched_wait_per_core), {
+          return err;
+        });
+        uint64_t sched_starv_per_core;
+        CHECK_ERR(mpm_read(VX_CSR_MPM_SCHED_STARV, core_id, &sched_starv_per_core), {
+          return err;
+        });
+        if (num_cores > 1 && sched_wait_per_core != 0) {
+          fprintf(stream, "PERF: core%d: scheduler wait=%ld, max starvation=%ld cycles\n", core_id, sched_wait_per_core, sched_starv_per_core);
+        }
+        sched_wait += sched_wait_per_core;
+        sched_starv = std::max<uint64_t>(sched_starv, sched_starv_per_core);
+      }
+      // address translation
+      {
+        uint64_t tlb_misses_per_core;
+        CHECK_ERR(mpm_read(VX_CSR_MPM_TLB_MISS, core_id, &tlb_misses_per_core), {
+          return err;
+        });
+        uint64_t tlb_walks_per_core;
+        CHECK_ERR(mpm_read(VX_CSR_MPM_TLB_WALKS, core_id, &tlb_walks_per_core), {
+          return err;
+        });
+        uint64_t tlb_lat_per_core;
+        CHECK_ERR(mpm_read(VX_CSR_MPM_TLB_LT, core_id, &tlb_lat_per_core), {
+          return err;
+        });
+        if (num_cores > 1 && tlb_misses_per_core != 0) {
+          fprintf(stream, "PERF: core%d: tlb misses=%ld, page walks=%ld, translation=%ld cycles\n", core_id, tlb_misses_per_core, tlb_walks_per_core, tlb_lat_per_core);
+        }
+        tlb_misses += tlb_misses_per_core;
+        tlb_walks += tlb_walks_per_core;
+        tlb_lat += tlb_lat_per_core;
+      }
     } break;
     case VX_DCR_MPM_CLASS_MEM: {
       if (lmem_enable) {
         // PERF: lmem
         uint64_t lmem_reads;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_LMEM_READS, core_id, &lmem_reads), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_LMEM_READS, core_id, &lmem_reads), {
           return err;
         });
         uint64_t lmem_writes;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_LMEM_WRITES, core_id, &lmem_writes), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_LMEM_WRITES, core_id, &lmem_writes), {
           return err;
         });
         uint64_t lmem_bank_stalls;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_LMEM_BANK_ST, core_id, &lmem_bank_stalls), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_LMEM_BANK_ST, core_id, &lmem_bank_stalls), {
           return err;
         });
         int lmem_bank_utilization = calcAvgPercent(lmem_reads + lmem_writes, lmem_reads + lmem_writes + lmem_bank_stalls);
@@ -451,15 +536,15 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
       if (icache_enable) {
         // PERF: Icache
         uint64_t icache_reads;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_ICACHE_READS, core_id, &icache_reads), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_ICACHE_READS, core_id, &icache_reads), {
           return err;
         });
         uint64_t icache_read_misses;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_ICACHE_MISS_R, core_id, &icache_read_misses), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_ICACHE_MISS_R, core_id, &icache_read_misses), {
           return err;
         });
         uint64_t icache_mshr_stalls;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_ICACHE_MSHR_ST, core_id, &icache_mshr_stalls), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_ICACHE_MSHR_ST, core_id, &icache_mshr_stalls), {
           return err;
         });
         int icache_read_hit_ratio = calcRatio(icache_read_misses, icache_reads);
@@ -474,28 +559,28 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
       if (dcache_enable) {
         // PERF: Dcache
         uint64_t dcache_reads;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_DCACHE_READS, core_id, &dcache_reads), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_DCACHE_READS, core_id, &dcache_reads), {
           return err;
         });
         uint64_t dcache_writes;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_DCACHE_WRITES, core_id, &dcache_writes), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_DCACHE_WRITES, core_id, &dcache_writes), {
           return err;
         });
         dcache_requests_per_core += dcache_reads + dcache_writes;
         uint64_t dcache_read_misses;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_DCACHE_MISS_R, core_id, &dcache_read_misses), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_DCACHE_MISS_R, core_id, &dcache_read_misses), {
           return err;
         });
         uint64_t dcache_write_misses;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_DCACHE_MISS_W, core_id, &dcache_write_misses), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_DCACHE_MISS_W, core_id, &dcache_write_misses), {
           return err;
         });
         uint64_t dcache_bank_stalls;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_DCACHE_BANK_ST, core_id, &dcache_bank_stalls), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_DCACHE_BANK_ST, core_id, &dcache_bank_stalls), {
           return err;
         });
         uint64_t dcache_mshr_stalls;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_DCACHE_MSHR_ST, core_id, &dcache_mshr_stalls), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_DCACHE_MSHR_ST, core_id, &dcache_mshr_stalls), {
           return err;
         });
         int dcache_read_hit_ratio = calcRatio(dcache_read_misses, dcache_reads);
@@ -512,7 +597,7 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
 
       // PERF: coalescer
       uint64_t coalescer_misses;
-      CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_COALESCER_MISS, core_id, &coalescer_misses), {
+      CHECK_ERR(mpm_read(VX_CSR_MPM_COALESCER_MISS, core_id, &coalescer_misses), {
         return err;
       });
       int coalescer_utilization = calcAvgPercent(dcache_requests_per_core - coalescer_misses, dcache_requests_per_core);
@@ -521,32 +606,32 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
       if (l2cache_enable) {
         // PERF: L2cache
         uint64_t tmp;
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_L2CACHE_READS, core_id, &tmp), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_L2CACHE_READS, core_id, &tmp), {
           return err;
         });
         l2cache_reads += tmp;
 
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_L2CACHE_WRITES, core_id, &tmp), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_L2CACHE_WRITES, core_id, &tmp), {
           return err;
         });
         l2cache_writes += tmp;
 
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_L2CACHE_MISS_R, core_id, &tmp), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_L2CACHE_MISS_R, core_id, &tmp), {
           return err;
         });
         l2cache_read_misses += tmp;
 
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_L2CACHE_MISS_W, core_id, &tmp), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_L2CACHE_MISS_W, core_id, &tmp), {
           return err;
         });
         l2cache_write_misses += tmp;
 
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_L2CACHE_BANK_ST, core_id, &tmp), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_L2CACHE_BANK_ST, core_id, &tmp), {
           return err;
         });
         l2cache_bank_stalls += tmp;
 
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_L2CACHE_MSHR_ST, core_id, &tmp), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_L2CACHE_MSHR_ST, core_id, &tmp), {
           return err;
         });
         l2cache_mshr_stalls += tmp;
@@ -554,38 +639,81 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
       if (0 == core_id) {
         if (l3cache_enable) {
           // PERF: L3cache
-          CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_L3CACHE_READS, core_id, &l3cache_reads), {
+          CHECK_ERR(mpm_read(VX_CSR_MPM_L3CACHE_READS, core_id, &l3cache_reads), {
             return err;
           });
-          CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_L3CACHE_WRITES, core_id, &l3cache_writes), {
+          CHECK_ERR(mpm_read(VX_CSR_MPM_L3CACHE_WRITES, core_id, &l3cache_writes), {
             return err;
           });
-          CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_L3CACHE_MISS_R, core_id, &l3cache_read_misses), {
+          CHECK_ERR(mpm_read(VX_CSR_MPM_L3CACHE_MISS_R, core_id, &l3cache_read_misses), {
             return err;
           });
-          CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_L3CACHE_MISS_W, core_id, &l3cache_write_misses), {
+          CHECK_ERR(mpm_read(VX_CSR_MPM_L3CACHE_MISS_W, core_id, &l3cache_write_misses), {
             return err;
           });
-          CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_L3CACHE_BANK_ST, core_id, &l3cache_bank_stalls), {
+          CHECK_ERR(mpm_read(VX_CSR_MPM_L3CACHE_BANK_ST, core_id, &l3cache_bank_stalls), {
             return err;
           });
-          CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_L3CACHE_MSHR_ST, core_id, &l3cache_mshr_stalls), {
+          CHECK_ERR(mpm_read(VX_CSR_MPM_L3CACHE_MSHR_ST, core_id, &l3cache_mshr_stalls), {
             return err;
           });
         }
         // PERF: memory
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_MEM_READS, core_id, &mem_reads), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_MEM_READS, core_id, &mem_reads), {
+          return err;
+        });
+        CHECK_ERR(mpm_read(VX_CSR_MPM_MEM_WRITES, core_id, &mem_writes), {
+          return err;
+        });
+        CHECK_ERR(mpm_read(VX_CSR_MPM_MEM_LT, core_id, &mem_lat), {
+          return err;
+        });
+        CHECK_ERR(mpm_read(VX_CSR_MPM_MEM_BANK_ST, core_id, &mem_bank_stalls), {
+          return err;
+        });
+      }
+    } break;
+    case VX_DCR_MPM_CLASS_DRAM: {
+      if (0 == core_id) {
+        // PERF: dram
+        CHECK_ERR(mpm_read(VX_CSR_MPM_DRAM_READS, core_id, &dram_reads), {
+          return err;
+        });
+        CHECK_ERR(mpm_read(VX_CSR_MPM_DRAM_WRITES, core_id, &dram_writes), {
+          return err;
+        });
+        CHECK_ERR(mpm_read(VX_CSR_MPM_DRAM_ROW_HIT, core_id, &dram_row_hits), {
+          return err;
+        });
+        CHECK_ERR(mpm_read(VX_CSR_MPM_DRAM_ROW_MISS, core_id, &dram_row_misses), {
+          return err;
+        });
+        CHECK_ERR(mpm_read(VX_CSR_MPM_DRAM_ROW_CONF, core_id, &dram_row_conflicts), {
+          return err;
+        });
+        CHECK_ERR(mpm_read(VX_CSR_MPM_DRAM_RW_TURN, core_id, &dram_rw_turns), {
+          return err;
+        });
+        CHECK_ERR(mpm_read(VX_CSR_MPM_DRAM_QUEUE, core_id, &dram_queue), {
           return err;
         });
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_MEM_WRITES, core_id, &mem_writes), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_DRAM_READ_LT, core_id, &dram_read_lat), {
           return err;
         });
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_MEM_LT, core_id, &mem_lat), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_DRAM_CYCLES, core_id, &dram_cycles), {
           return err;
         });
-        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_MEM_BANK_ST, core_id, &mem_bank_stalls), {
+        CHECK_ERR(mpm_read(VX_CSR_MPM_DRAM_BYTES, core_id, &dram_bytes), {
           return err;
         });
+        for (uint32_t i = 0; i < num_dram_channels; ++i) {
+          CHECK_ERR(mpm_read(VX_CSR_MPM_DRAM_CH_RD + i, core_id, &dram_ch_reads[i]), {
+            return err;
+          });
+          CHECK_ERR(mpm_read(VX_CSR_MPM_DRAM_CH_WR + i, core_id, &dram_ch_writes[i]), {
+            return err;
+          });
+        }
       }
     } break;
     default:
@@ -636,6 +764,12 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
     fprintf(stream, "PERF: stores=%ld\n", stores);
     fprintf(stream, "PERF: ifetch latency=%d cycles\n", ifetch_avg_lat);
     fprintf(stream, "PERF: load latency=%d cycles\n", load_avg_lat);
+    if (sched_wait != 0) {
+      fprintf(stream, "PERF: scheduler wait=%ld, max starvation=%ld cycles\n", sched_wait, sched_starv);
+    }
+    if (tlb_misses != 0) {
+      fprintf(stream, "PERF: tlb misses=%ld, page walks=%ld, translation=%ld cycles\n", tlb_misses, tlb_walks, tlb_lat);
+    }
   } break;
   case VX_DCR_MPM_CLASS_MEM: {
     if (l2cache_enable) {
@@ -679,6 +813,26 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
       fprintf(stream, "PERF: memory bank stalls=%ld (utilization=%d%%)\n", mem_bank_stalls, mem_bank_utilization);
     }
   } break;
+  case VX_DCR_MPM_CLASS_DRAM: {
+    uint64_t dram_row_accesses = dram_row_hits + dram_row_misses + dram_row_conflicts;
+    fprintf(stream, "PERF: dram requests=%ld (reads=%ld, writes=%ld)\n", dram_reads + dram_writes, dram_reads, dram_writes);
+    fprintf(stream, "PERF: dram row hits=%d%%, misses=%d%%, conflicts=%d%%\n"
+      , calcAvgPercent(dram_row_hits, dram_row_accesses)
+      , calcAvgPercent(dram_row_misses, dram_row_accesses)
+      , calcAvgPercent(dram_row_conflicts, dram_row_accesses)
+    );
+    fprintf(stream, "PERF: dram read/write turnarounds=%ld\n", dram_rw_turns);
+    fprintf(stream, "PERF: dram read latency=%d dram cycles\n", int(caclAverage(dram_read_lat, dram_reads)));
+    fprintf(stream, "PERF: dram queue occupancy=%f\n", caclAverage(dram_queue, dram_cycles));
+    fprintf(stream, "PERF: dram bandwidth=%f bytes/dram cycle\n", caclAverage(dram_bytes, dram_cycles));
+    for (uint32_t i = 0; i < num_dram_channels; ++i) {
+      fprintf(stream, "PERF: dram channel%d bandwidth=%f bytes/dram cycle (reads=%f, writes=%f)\n", i
+        , caclAverage(dram_ch_reads[i] + dram_ch_writes[i], dram_cycles)
+        , caclAverage(dram_ch_reads[i], dram_cycles)
+        , caclAverage(dram_ch_writes[i], dram_cycles)
+      );
+    }
+  } break;
   default:
     break;
   }
@@ -691,6 +845,341 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
   return 0;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+enum class PerfScope {
+  Core,    // per-core counter, totals are summed
+  Cluster, // shared per-cluster counter, totals are averaged over cores
+  Device   // device-wide counter, reported by core 0
+};
+
+struct perf_counter_t {
+  uint32_t    addr;
+  const char* name;
+  PerfScope   scope;
+  uint64_t    isa_mask; // required device feature, zero if none
+};
+
+const perf_counter_t core_counters[] = {
+  {VX_CSR_MPM_SCHED_ID,    "sched_idles",    PerfScope::Core, 0},
+  {VX_CSR_MPM_SCHED_ST,    "sched_stalls",   PerfScope::Core, 0},
+  {VX_CSR_MPM_IBUF_ST,     "ibuffer_stalls", PerfScope::Core, 0},
+  {VX_CSR_MPM_SCRB_ST,     "scrb_stalls",    PerfScope::Core, 0},
+  {VX_CSR_MPM_OPDS_ST,     "opds_stalls",    PerfScope::Core, 0},
+  {VX_CSR_MPM_SCRB_ALU,    "scrb_alu",       PerfScope::Core, 0},
+  {VX_CSR_MPM_SCRB_FPU,    "scrb_fpu",       PerfScope::Core, VX_ISA_STD_F},
+  {VX_CSR_MPM_SCRB_LSU,    "scrb_lsu",       PerfScope::Core, 0},
+  {VX_CSR_MPM_SCRB_SFU,    "scrb_sfu",       PerfScope::Core, 0},
+  {VX_CSR_MPM_SCRB_CSRS,   "scrb_csrs",      PerfScope::Core, 0},
+  {VX_CSR_MPM_SCRB_WCTL,   "scrb_wctl",      PerfScope::Core, 0},
+  {VX_CSR_MPM_SCRB_VPU,    "scrb_vpu",       PerfScope::Core, VX_ISA_STD_V},
+  {VX_CSR_MPM_SCRB_TCU,    "scrb_tcu",       PerfScope::Core, VX_ISA_EXT_TCU},
+  {VX_CSR_MPM_SCHED_WAIT,  "sched_wait",     PerfScope::Core, 0},
+  {VX_CSR_MPM_SCHED_STARV, "sched_starv",    PerfScope::Core, 0},
+  {VX_CSR_MPM_TLB_MISS,    "tlb_misses",     PerfScope::Core, 0},
+  {VX_CSR_MPM_TLB_WALKS,   "tlb_walks",      PerfScope::Core, 0},
+  {VX_CSR_MPM_TLB_LT,      "tlb_lat",        PerfScope::Core, 0},
+  {VX_CSR_MPM_IFETCHES,    "ifetches",       PerfScope::Core, 0},
+  {VX_CSR_MPM_LOADS,       "loads",          PerfScope::Core, 0},
+  {VX_CSR_MPM_STORES,      "stores",         PerfScope::Core, 0},
+  {VX_CSR_MPM_IFETCH_LT,   "ifetch_lat",     PerfScope::Core, 0},
+  {VX_CSR_MPM_LOAD_LT,     "load_lat",       PerfScope::Core, 0},
+};
+
+const perf_counter_t mem_counters[] = {
+  {VX_CSR_MPM_ICACHE_READS,    "icache_reads",         PerfScope::Core,    VX_ISA_EXT_ICACHE},
+  {VX_CSR_MPM_ICACHE_MISS_R,   "icache_read_misses",   PerfScope::Core,    VX_ISA_EXT_ICACHE},
+  {VX_CSR_MPM_ICACHE_MSHR_ST,  "icache_mshr_stalls",   PerfScope::Core,    VX_ISA_EXT_ICACHE},
+  {VX_CSR_MPM_DCACHE_READS,    "dcache_reads",         PerfScope::Core,    VX_ISA_EXT_DCACHE},
+  {VX_CSR_MPM_DCACHE_WRITES,   "dcache_writes",        PerfScope::Core,    VX_ISA_EXT_DCACHE},
+  {VX_CSR_MPM_DCACHE_MISS_R,   "dcache_read_misses",   PerfScope::Core,    VX_ISA_EXT_DCACHE},
+  {VX_CSR_MPM_DCACHE_MISS_W,   "dcache_write_misses",  PerfScope::Core,    VX_ISA_EXT_DCACHE},
+  {VX_CSR_MPM_DCACHE_BANK_ST,  "dcache_bank_stalls",   PerfScope::Core,    VX_ISA_EXT_DCACHE},
+  {VX_CSR_MPM_DCACHE_MSHR_ST,  "dcache_mshr_stalls",   PerfScope::Core,    VX_ISA_EXT_DCACHE},
+  {VX_CSR_MPM_COALESCER_MISS,  "coalescer_misses",     PerfScope::Core,    0},
+  {VX_CSR_MPM_LMEM_READS,      "lmem_reads",           PerfScope::Core,    VX_ISA_EXT_LMEM},
+  {VX_CSR_MPM_LMEM_WRITES,     "lmem_writes",          PerfScope::Core,    VX_ISA_EXT_LMEM},
+  {VX_CSR_MPM_LMEM_BANK_ST,    "lmem_bank_stalls",     PerfScope::Core,    VX_ISA_EXT_LMEM},
+  {VX_CSR_MPM_L2CACHE_READS,   "l2cache_reads",        PerfScope::Cluster, VX_ISA_EXT_L2CACHE},
+  {VX_CSR_MPM_L2CACHE_WRITES,  "l2cache_writes",       PerfScope::Cluster, VX_ISA_EXT_L2CACHE},
+  {VX_CSR_MPM_L2CACHE_MISS_R,  "l2cache_read_misses",  PerfScope::Cluster, VX_ISA_EXT_L2CACHE},
+  {VX_CSR_MPM_L2CACHE_MISS_W,  "l2cache_write_misses", PerfScope::Cluster, VX_ISA_EXT_L2CACHE},
+  {VX_CSR_MPM_L2CACHE_BANK_ST, "l2cache_bank_stalls",  PerfScope::Cluster, VX_ISA_EXT_L2CACHE},
+  {VX_CSR_MPM_L2CACHE_MSHR_ST, "l2cache_mshr_stalls",  PerfScope::Cluster, VX_ISA_EXT_L2CACHE},
+  {VX_CSR_MPM_L3CACHE_READS,   "l3cache_reads",        PerfScope::Device,  VX_ISA_EXT_L3CACHE},
+  {VX_CSR_MPM_L3CACHE_WRITES,  "l3cache_writes",       PerfScope::Device,  VX_ISA_EXT_L3CACHE},
+  {VX_CSR_MPM_L3CACHE_MISS_R,  "l3cache_read_misses",  PerfScope::Device,  VX_ISA_EXT_L3CACHE},
+  {VX_CSR_MPM_L3CACHE_MISS_W,  "l3cache_write_misses", PerfScope::Device,  VX_ISA_EXT_L3CACHE},
+  {VX_CSR_MPM_L3CACHE_BANK_ST, "l3cache_bank_stalls",  PerfScope::Device,  VX_ISA_EXT_L3CACHE},
+  {VX_CSR_MPM_L3CACHE_MSHR_ST, "l3cache_mshr_stalls",  PerfScope::Device,  VX_ISA_EXT_L3CACHE},
+  {VX_CSR_MPM_MEM_READS,       "mem_reads",            PerfScope::Device,  0},
+  {VX_CSR_MPM_MEM_WRITES,      "mem_writes",           PerfScope::Device,  0},
+  {VX_CSR_MPM_MEM_LT,          "mem_lat",              PerfScope::Device,  0},
+  {VX_CSR_MPM_MEM_BANK_ST,     "mem_bank_stalls",      PerfScope::Device,  0},
+};
+
+const perf_counter_t dram_counters[] = {
+  {VX_CSR_MPM_DRAM_READS,    "dram_reads",         PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_WRITES,   "dram_writes",        PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_ROW_HIT,  "dram_row_hits",      PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_ROW_MISS, "dram_row_misses",    PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_ROW_CONF, "dram_row_conflicts", PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_RW_TURN,  "dram_rw_turns",      PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_QUEUE,    "dram_queue",         PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_READ_LT,  "dram_read_lat",      PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_CYCLES,   "dram_cycles",        PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_BYTES,    "dram_bytes",         PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_CH_RD+0,  "dram_ch0_read_bytes",  PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_CH_WR+0,  "dram_ch0_write_bytes", PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_CH_RD+1,  "dram_ch1_read_bytes",  PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_CH_WR+1,  "dram_ch1_write_bytes", PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_CH_RD+2,  "dram_ch2_read_bytes",  PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_CH_WR+2,  "dram_ch2_write_bytes", PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_CH_RD+3,  "dram_ch3_read_bytes",  PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_CH_WR+3,  "dram_ch3_write_bytes", PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_CH_RD+4,  "dram_ch4_read_bytes",  PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_CH_WR+4,  "dram_ch4_write_bytes", PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_CH_RD+5,  "dram_ch5_read_bytes",  PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_CH_WR+5,  "dram_ch5_write_bytes", PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_CH_RD+6,  "dram_ch6_read_bytes",  PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_CH_WR+6,  "dram_ch6_write_bytes", PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_CH_RD+7,  "dram_ch7_read_bytes",  PerfScope::Device, 0},
+  {VX_CSR_MPM_DRAM_CH_WR+7,  "dram_ch7_write_bytes", PerfScope::Device, 0},
+};
+static_assert(VX_CSR_MPM_DRAM_CHANNELS == 8, "invalid DRAM channel counters");
+
+// DRAM channel of a per-channel counter, -1 for other counters
+int dram_counter_channel(uint32_t addr) {
+  if (addr >= VX_CSR_MPM_DRAM_CH_RD && addr < VX_CSR_MPM_DRAM_CH_RD + VX_CSR_MPM_DRAM_CHANNELS)
+    return addr - VX_CSR_MPM_DRAM_CH_RD;
+  if (addr >= VX_CSR_MPM_DRAM_CH_WR && addr < VX_CSR_MPM_DRAM_CH_WR + VX_CSR_MPM_DRAM_CHANNELS)
+    return addr - VX_CSR_MPM_DRAM_CH_WR;
+  return -1;
+}
+
+// ordered (name, value) metrics of one core or of the whole device
+typedef std::vector<std::pair<std::string, double>> perf_metrics_t;
+
+double perf_ratio(double part, double total) {
+  return (total != 0) ? (part / total) : 0;
+}
+
+void add_derived_metrics(int perf_class, perf_metrics_t& metrics) {
+  std::unordered_map<std::string, double> m(metrics.begin(), metrics.end());
+  auto add = [&](const char* name, double value) {
+    metrics.emplace_back(name, value);
+  };
+  auto has = [&](const char* name) {
+    return m.count(name) != 0;
+  };
+  add("ipc", perf_ratio(m["instrs"], m["cycles"]));
+  switch (perf_class) {
+  case VX_DCR_MPM_CLASS_CORE:
+    add("sched_idle_rate", perf_ratio(m["sched_idles"], m["cycles"]));
+    add("sched_stall_rate", perf_ratio(m["sched_stalls"], m["cycles"]));
+    add("ibuffer_stall_rate", perf_ratio(m["ibuffer_stalls"], m["cycles"]));
+    add("scrb_stall_rate", perf_ratio(m["scrb_stalls"], m["cycles"]));
+    add("ifetch_latency", perf_ratio(m["ifetch_lat"], m["ifetches"]));
+    add("load_latency", perf_ratio(m["load_lat"], m["loads"]));
+    break;
+  case VX_DCR_MPM_CLASS_MEM:
+    if (has("icache_reads")) {
+      add("icache_read_miss_rate", perf_ratio(m["icache_read_misses"], m["icache_reads"]));
+    }
+    if (has("dcache_reads")) {
+      auto requests = m["dcache_reads"] + m["dcache_writes"];
+      add("dcache_read_miss_rate", perf_ratio(m["dcache_read_misses"], m["dcache_reads"]));
+      add("dcache_write_miss_rate", perf_ratio(m["dcache_write_misses"], m["dcache_writes"]));
+      add("dcache_bank_utilization", perf_ratio(requests, requests + m["dcache_bank_stalls"]));
+      add("coalescer_hit_rate", perf_ratio(requests - m["coalescer_misses"], requests));
+    }
+    if (has("lmem_reads")) {
+      auto requests = m["lmem_reads"] + m["lmem_writes"];
+      add("lmem_bank_utilization", perf_ratio(requests, requests + m["lmem_bank_stalls"]));
+    }
+    if (has("l2cache_reads")) {
+      add("l2cache_read_miss_rate", perf_ratio(m["l2cache_read_misses"], m["l2cache_reads"]));
+      add("l2cache_write_miss_rate", perf_ratio(m["l2cache_write_misses"], m["l2cache_writes"]));
+    }
+    if (has("l3cache_reads")) {
+      add("l3cache_read_miss_rate", perf_ratio(m["l3cache_read_misses"], m["l3cache_reads"]));
+      add("l3cache_write_miss_rate", perf_ratio(m["l3cache_write_misses"], m["l3cache_writes"]));
+    }
+    if (has("mem_reads")) {
+      auto requests = m["mem_reads"] + m["mem_writes"];
+      add("mem_latency", perf_ratio(m["mem_lat"], m["mem_reads"]));
+      add("mem_bank_utilization", perf_ratio(requests, requests + m["mem_bank_stalls"]));
+    }
+    break;
+  case VX_DCR_MPM_CLASS_DRAM:
+    if (has("dram_reads")) {
+      auto accesses = m["dram_row_hits"] + m["dram_row_misses"] + m["dram_row_conflicts"];
+      add("dram_row_hit_rate", perf_ratio(m["dram_row_hits"], accesses));
+      add("dram_row_conflict_rate", perf_ratio(m["dram_row_conflicts"], accesses));
+      add("dram_read_latency", perf_ratio(m["dram_read_lat"], m["dram_reads"]));
+      add("dram_queue_occupancy", perf_ratio(m["dram_queue"], m["dram_cycles"]));
+      add("dram_bandwidth", perf_ratio(m["dram_bytes"], m["dram_cycles"]));
+      for (uint32_t i = 0; i < VX_CSR_MPM_DRAM_CHANNELS; ++i) {
+        auto prefix = "dram_ch" + std::to_string(i);
+        if (!has((prefix + "_read_bytes").c_str()))
+          break;
+        add((prefix + "_read_bandwidth").c_str(), perf_ratio(m[prefix + "_read_bytes"], m["dram_cycles"]));
+        add((prefix + "_write_bandwidth").c_str(), perf_ratio(m[prefix + "_write_bytes"], m["dram_cycles"]));
+      }
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+}
+
+extern int vx_export_perf(vx_device_h hdevice, FILE* stream, int format) {
+  if (nullptr == hdevice || nullptr == stream)
+    return -1;
+  if (format != VX_PERF_FORMAT_JSON && format != VX_PERF_FORMAT_CSV)
+    return -1;
+
+  uint64_t num_cores;
+  CHECK_ERR(vx_dev_caps(hdevice, VX_CAPS_NUM_CORES, &num_cores), {
+    return err;
+  });
+
+  uint64_t isa_flags;
+  CHECK_ERR(vx_dev_caps(hdevice, VX_CAPS_ISA_FLAGS, &isa_flags), {
+    return err;
+  });
+
+  uint64_t num_mem_banks;
+  CHECK_ERR(vx_dev_caps(hdevice, VX_CAPS_NUM_MEM_BANKS, &num_mem_banks), {
+    return err;
+  });
+
+  // counters of missing features or DRAM channels are not exported
+  auto is_exported = [&](const perf_counter_t& counter) {
+    if (counter.isa_mask != 0 && 0 == (isa_flags & counter.isa_mask))
+      return false;
+    return dram_counter_channel(counter.addr) < int(num_mem_banks);
+  };
+
+  std::vector<uint64_t> values(num_cores * VX_MPM_NUM_COUNTERS);
+  CHECK_ERR(vx_mpm_snapshot(hdevice, values.data()), {
+    return err;
+  });
+  auto value = [&](uint32_t core_id, uint32_t addr) {
+    return values.at(core_id * VX_MPM_NUM_COUNTERS + (addr - VX_CSR_MPM_BASE));
+  };
+
+  auto perf_class = get_profiling_mode();
+  const perf_counter_t* counters = nullptr;
+  size_t num_counters = 0;
+  switch (perf_class) {
+  case VX_DCR_MPM_CLASS_CORE:
+    counters = core_counters;
+    num_counters = std::size(core_counters);
+    break;
+  case VX_DCR_MPM_CLASS_MEM:
+    counters = mem_counters;
+    num_counters = std::size(mem_counters);
+    break;
+  case VX_DCR_MPM_CLASS_DRAM:
+    counters = dram_counters;
+    num_counters = std::size(dram_counters);
+    break;
+  default:
+    break;
+  }
+
+  std::vector<perf_metrics_t> cores(num_cores);
+  perf_metrics_t total;
+  uint64_t total_instrs = 0;
+  uint64_t max_cycles = 0;
+  std::vector<double> sums(num_counters, 0);
+
+  for (uint32_t core_id = 0; core_id < num_cores; ++core_id) {
+    auto& metrics = cores.at(core_id);
+    auto instrs = value(core_id, VX_CSR_MINSTRET);
+    auto cycles = value(core_id, VX_CSR_MCYCLE);
+    metrics.emplace_back("instrs", instrs);
+    metrics.emplace_back("cycles", cycles);
+    total_instrs += instrs;
+    max_cycles = std::max(max_cycles, cycles);
+    for (size_t i = 0; i < num_counters; ++i) {
+      auto& counter = counters[i];
+      if (!is_exported(counter))
+        continue;
+      auto v = value(core_id, counter.addr);
+      if (counter.scope != PerfScope::Device) {
+        metrics.emplace_back(counter.name, v);
+      }
+      if (counter.scope != PerfScope::Device || core_id == 0) {
+        sums[i] += v;
+      }
+    }
+    add_derived_metrics(perf_class, metrics);
+  }
+
+  // the device runs as long as its slowest core
+  total.emplace_back("instrs", total_instrs);
+  total.emplace_back("cycles", max_cycles);
+  for (size_t i = 0; i < num_counters; ++i) {
+    auto& counter = counters[i];
+    if (!is_exported(counter))
+      continue;
+    auto v = sums[i];
+    if (counter.scope == PerfScope::Cluster) {
+      v /= num_cores;
+    }
+    total.emplace_back(counter.name, v);
+  }
+  add_derived_metrics(perf_class, total);
+
+  if (format == VX_PERF_FORMAT_JSON) {
+    auto to_json = [](const perf_metrics_t& metrics) {
+      auto obj = nlohmann::ordered_json::object();
+      for (auto& it : metrics) {
+        if (it.second == double(uint64_t(it.second))) {
+          obj[it.first] = uint64_t(it.second);
+        } else {
+          obj[it.first] = it.second;
+        }
+      }
+      return obj;
+    };
+    nlohmann::ordered_json root;
+    root["perf_class"] = perf_class;
+    root["num_cores"] = num_cores;
+    root["total"] = to_json(total);
+    auto& json_cores = root["cores"] = nlohmann::ordered_json::array();
+    for (auto& metrics : cores) {
+      json_cores.push_back(to_json(metrics));
+    }
+    fprintf(stream, "%s\n", root.dump(2).c_str());
+  } else {
+    fprintf(stream, "core,metric,value\n");
+    auto dump_csv = [&](const char* core, const perf_metrics_t& metrics) {
+      for (auto& it : metrics) {
+        if (it.second == double(uint64_t(it.second))) {
+          fprintf(stream, "%s,%s,%lu\n", core, it.first.c_str(), uint64_t(it.second));
+        } else {
+          fprintf(stream, "%s,%s,%f\n", core, it.first.c_str(), it.second);
+        }
+      }
+    };
+    dump_csv("total", total);
+    for (uint32_t core_id = 0; core_id < num_cores; ++core_id) {
+      dump_csv(std::to_string(core_id).c_str(), cores.at(core_id));
+    }
+  }
+
+  fflush(stream);
+
+  return 0;
+}
+
 int vx_check_occupancy(vx_device_h hdevice, uint32_t group_size, uint32_t* max_localmem) {
    // check group size
   uint64_t warps_per_core, threads_per_warp;
@@ -15,10 +15,22 @@
 
 #include <unistd.h>
 #include <string.h>
+#include <stdlib.h>
 #include <string>
 #include <cstdlib>
 #include <dlfcn.h>
 #include <iostream>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 int get_profiling_mode();
 
@@ -55,6 +67,433 @@ static void* g_drv_handle = nullptr;
 
 typedef int (*vx_dev_init_t)(callbacks_t*);
 
+///////////////////////////////////////////////////////////////////////////////
+
+// Driver callbacks are not thread-safe: calls on a device, from the host or
+// from its queue threads, are serialized by a per-device lock. The exception
+// is ready_wait, which runs without the lock so that the device stays usable
+// while a kernel runs; a single thread at a time waits on the driver.
+
+struct vx_queue;
+
+// resident kernel image, shared by identical uploads
+struct kernel_entry_t {
+  vx_buffer_h buffer;
+  uint64_t hash;
+  std::vector<uint8_t> content;
+  uint64_t bin_addr;    // read-only binary range
+  uint64_t bin_size;
+  uint64_t runtime_addr; // full reserved range
+  uint64_t runtime_size;
+  uint32_t refs;
+  bool valid;           // still matches its content
+};
+
+struct device_ctx_t {
+  std::recursive_mutex mutex;
+  std::unordered_set<vx_queue*> queues;
+  // kernel cache, guarded by the device lock
+  std::unordered_multimap<uint64_t, std::shared_ptr<kernel_entry_t>> kernels;
+  std::unordered_map<vx_buffer_h, std::shared_ptr<kernel_entry_t>> kernel_buffers;
+  // launches counted for per-launch perf export
+  uint32_t launches = 0;
+  bool perf_pending = false;
+  // a device runs one kernel at a time: the launch in flight, whether a
+  // thread waits for it on the driver, and the completion of that wait
+  bool running = false;
+  bool waiting = false;
+  std::condition_variable_any launch_cv;
+};
+
+static std::mutex g_registry_mutex;
+static std::unordered_map<vx_device_h, std::shared_ptr<device_ctx_t>> g_devices;
+static std::unordered_map<vx_buffer_h, std::shared_ptr<device_ctx_t>> g_buffers;
+
+static std::shared_ptr<device_ctx_t> find_device(vx_device_h hdevice) {
+  std::lock_guard<std::mutex> guard(g_registry_mutex);
+  auto it = g_devices.find(hdevice);
+  return (it != g_devices.end()) ? it->second : nullptr;
+}
+
+static std::shared_ptr<device_ctx_t> find_buffer(vx_buffer_h hbuffer) {
+  std::lock_guard<std::mutex> guard(g_registry_mutex);
+  auto it = g_buffers.find(hbuffer);
+  return (it != g_buffers.end()) ? it->second : nullptr;
+}
+
+class DeviceLock {
+public:
+  DeviceLock(std::shared_ptr<device_ctx_t> ctx) : ctx_(std::move(ctx)) {
+    if (ctx_) {
+      ctx_->mutex.lock();
+    }
+  }
+
+  ~DeviceLock() {
+    if (ctx_) {
+      ctx_->mutex.unlock();
+    }
+  }
+
+  DeviceLock(const DeviceLock&) = delete;
+  DeviceLock& operator=(const DeviceLock&) = delete;
+
+private:
+  std::shared_ptr<device_ctx_t> ctx_;
+};
+
+static void export_perf(vx_device_h hdevice, const std::string& filename) {
+  // format selected by the file extension
+  bool csv = filename.size() > 4 && filename.compare(filename.size() - 4, 4, ".csv") == 0;
+  auto stream = fopen(filename.c_str(), "w");
+  if (stream) {
+    vx_export_perf(hdevice, stream, csv ? VX_PERF_FORMAT_CSV : VX_PERF_FORMAT_JSON);
+    fclose(stream);
+  } else {
+    std::cerr << "Error: failed to open " << filename << std::endl;
+  }
+}
+
+// a %d in VORTEX_PERF_EXPORT exports the counters after each launch,
+// numbered from 0, instead of once when the device is closed
+static const char* get_launch_export() {
+  auto export_file = getenv("VORTEX_PERF_EXPORT");
+  if (export_file == nullptr || strstr(export_file, "%d") == nullptr)
+    return nullptr;
+  return export_file;
+}
+
+static void export_launch_perf(device_ctx_t* ctx, vx_device_h hdevice) {
+  if (nullptr == ctx || !ctx->perf_pending)
+    return;
+  ctx->perf_pending = false;
+  auto export_file = get_launch_export();
+  if (nullptr == export_file)
+    return;
+  std::string filename(export_file);
+  filename.replace(filename.find("%d"), 2, std::to_string(ctx->launches - 1));
+  export_perf(hdevice, filename);
+}
+
+// Wait for the launch in flight, with the device lock held once by the
+// caller. The lock is released while waiting.
+static int wait_kernel(device_ctx_t* ctx, vx_device_h hdevice, uint64_t timeout) {
+  if (nullptr == ctx)
+    return (g_callbacks.ready_wait)(hdevice, timeout);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+  while (ctx->running) {
+    if (ctx->waiting) {
+      // another thread waits on the driver
+      if (ctx->launch_cv.wait_until(ctx->mutex, deadline) == std::cv_status::timeout
+       && ctx->running)
+        return -1;
+      continue;
+    }
+    ctx->waiting = true;
+    ctx->mutex.unlock();
+    int err = (g_callbacks.ready_wait)(hdevice, timeout);
+    ctx->mutex.lock();
+    ctx->waiting = false;
+    if (0 == err) {
+      ctx->running = false;
+    }
+    ctx->launch_cv.notify_all();
+    if (err != 0)
+      return err;
+  }
+  export_launch_perf(ctx, hdevice);
+  return 0;
+}
+
+static int start_kernel(device_ctx_t* ctx, vx_device_h hdevice, vx_buffer_h hkernel, vx_buffer_h harguments, int flags) {
+  // the launch in flight completes first, its counters are exported before
+  // they are reset
+  CHECK_ERR(wait_kernel(ctx, hdevice, VX_MAX_TIMEOUT), {
+    return err;
+  });
+  int profiling_mode = get_profiling_mode();
+  if (profiling_mode != 0) {
+    CHECK_ERR((g_callbacks.dcr_write)(hdevice, VX_DCR_BASE_MPM_CLASS, profiling_mode), {
+      return err;
+    });
+  }
+  int err = (g_callbacks.start)(hdevice, hkernel, harguments, flags);
+  if (err != 0)
+    return err;
+  if (ctx) {
+    ++ctx->launches;
+    ctx->perf_pending = true;
+    ctx->running = true;
+  }
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Kernel binary cache: identical images uploaded with vx_upload_kernel_bytes
+// share a refcounted device buffer that stays resident after its last
+// vx_mem_free. Idle images are evicted when an allocation fails or a new image
+// needs their address range, and any image is invalidated when its binary range
+// is written. Device writes are not tracked: a reused image keeps the .data
+// globals of its previous launches, so the cache is only enabled with
+// VORTEX_KERNEL_CACHE=1, for kernels that do not modify initialized globals.
+
+static bool kernel_cache_enabled() {
+  static bool s_enabled = [] {
+    auto env = getenv("VORTEX_KERNEL_CACHE");
+    return (env != nullptr && std::atoi(env) != 0);
+  }();
+  return s_enabled;
+}
+
+static uint64_t content_hash(const void* content, uint64_t size) {
+  // FNV-1a
+  auto bytes = reinterpret_cast<const uint8_t*>(content);
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (uint64_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+static int release_kernel(device_ctx_t* ctx, std::shared_ptr<kernel_entry_t> entry) {
+  ctx->kernel_buffers.erase(entry->buffer);
+  {
+    std::lock_guard<std::mutex> guard(g_registry_mutex);
+    g_buffers.erase(entry->buffer);
+  }
+  return (g_callbacks.mem_free)(entry->buffer);
+}
+
+static void invalidate_kernel(device_ctx_t* ctx, std::shared_ptr<kernel_entry_t> entry) {
+  auto range = ctx->kernels.equal_range(entry->hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second == entry) {
+      ctx->kernels.erase(it);
+      break;
+    }
+  }
+  entry->valid = false;
+  if (entry->refs == 0) {
+    release_kernel(ctx, entry);
+  }
+}
+
+// invalidate cached images whose binary overlaps a device write
+static void invalidate_kernels(device_ctx_t* ctx, vx_buffer_h hbuffer, uint64_t offset, uint64_t size) {
+  if (ctx == nullptr || ctx->kernels.empty())
+    return;
+  uint64_t addr;
+  if ((g_callbacks.mem_address)(hbuffer, &addr) != 0)
+    return;
+  addr += offset;
+  std::vector<std::shared_ptr<kernel_entry_t>> stale;
+  for (auto& it : ctx->kernels) {
+    auto& entry = it.second;
+    if (addr < entry->bin_addr + entry->bin_size && entry->bin_addr < addr + size) {
+      stale.push_back(entry);
+    }
+  }
+  for (auto& entry : stale) {
+    invalidate_kernel(ctx, entry);
+  }
+}
+
+// release idle images, returns true if any was released
+static bool evict_kernels(device_ctx_t* ctx, uint64_t addr = 0, uint64_t size = ~0ull) {
+  if (ctx == nullptr)
+    return false;
+  std::vector<std::shared_ptr<kernel_entry_t>> idle;
+  for (auto& it : ctx->kernels) {
+    auto& entry = it.second;
+    if (entry->refs == 0
+     && addr < entry->runtime_addr + entry->runtime_size
+     && entry->runtime_addr < addr + size) {
+      idle.push_back(entry);
+    }
+  }
+  for (auto& entry : idle) {
+    invalidate_kernel(ctx, entry);
+  }
+  return !idle.empty();
+}
+
+int kernel_cache_upload(vx_device_h hdevice, const void* content, uint64_t size, vx_buffer_h* hbuffer,
+                        int (*upload)(vx_device_h, const void*, uint64_t, vx_buffer_h*)) {
+  auto ctx = find_device(hdevice);
+  if (ctx == nullptr || !kernel_cache_enabled())
+    return upload(hdevice, content, size, hbuffer);
+
+  DeviceLock lock(ctx);
+
+  auto hash = content_hash(content, size);
+  auto range = ctx->kernels.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    auto& entry = it->second;
+    if (entry->content.size() == size
+     && 0 == memcmp(entry->content.data(), content, size)) {
+      ++entry->refs;
+      *hbuffer = entry->buffer;
+      return 0;
+    }
+  }
+
+  // images are linked at fixed addresses, release idle ones in the way
+  auto header = reinterpret_cast<const uint64_t*>(content);
+  auto min_vma = header[0];
+  auto max_vma = header[1];
+  evict_kernels(ctx.get(), min_vma, max_vma - min_vma);
+
+  vx_buffer_h _hbuffer;
+  CHECK_ERR(upload(hdevice, content, size, &_hbuffer), {
+    return err;
+  });
+
+  auto bytes = reinterpret_cast<const uint8_t*>(content);
+  auto entry = std::make_shared<kernel_entry_t>();
+  entry->buffer = _hbuffer;
+  entry->hash = hash;
+  entry->content.assign(bytes, bytes + size);
+  entry->bin_addr = min_vma;
+  entry->bin_size = size - 2 * 8;
+  entry->runtime_addr = min_vma;
+  entry->runtime_size = max_vma - min_vma;
+  entry->refs = 1;
+  entry->valid = true;
+  ctx->kernels.emplace(hash, entry);
+  ctx->kernel_buffers[_hbuffer] = entry;
+
+  *hbuffer = _hbuffer;
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct vx_event {
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::atomic<uint32_t> refs;
+  int status;
+  int result;
+
+  vx_event() : refs(1), status(VX_EVENT_PENDING), result(0) {}
+
+  void complete(int err) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      result = err;
+      status = err ? VX_EVENT_ERROR : VX_EVENT_COMPLETE;
+    }
+    cv.notify_all();
+  }
+
+  int wait(uint64_t timeout) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!cv.wait_for(lock, std::chrono::milliseconds(timeout),
+                     [&] { return status != VX_EVENT_PENDING; }))
+      return -1;
+    return result;
+  }
+
+  void retain() {
+    ++refs;
+  }
+
+  void release() {
+    if (--refs == 0) {
+      delete this;
+    }
+  }
+};
+
+struct vx_queue {
+  struct command_t {
+    std::function<int()> exec;
+    vx_event* event;
+  };
+
+  vx_device_h device;
+  std::shared_ptr<device_ctx_t> ctx;
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<command_t> commands;
+  uint32_t pending; // queued or executing commands
+  bool stop;
+  int error;        // sticky error, only accessed by the worker
+  std::thread worker;
+
+  vx_queue(vx_device_h device, std::shared_ptr<device_ctx_t> ctx)
+    : device(device)
+    , ctx(std::move(ctx))
+    , pending(0)
+    , stop(false)
+    , error(0) {
+    worker = std::thread([this] { this->run(); });
+  }
+
+  ~vx_queue() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    cv.notify_all();
+    worker.join();
+  }
+
+  int enqueue(std::function<int()> exec, vx_event_h* hevent) {
+    auto event = new vx_event();
+    if (hevent) {
+      event->retain();
+      *hevent = event;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      commands.push_back({std::move(exec), event});
+      ++pending;
+    }
+    cv.notify_all();
+    return 0;
+  }
+
+  int finish(uint64_t timeout) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!cv.wait_for(lock, std::chrono::milliseconds(timeout),
+                     [&] { return pending == 0; }))
+      return -1;
+    return 0;
+  }
+
+  void run() {
+    for (;;) {
+      command_t cmd;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return stop || !commands.empty(); });
+        if (commands.empty())
+          return;
+        cmd = std::move(commands.front());
+        commands.pop_front();
+      }
+      // commands following a failure are not executed
+      int err = error;
+      if (err == 0) {
+        err = cmd.exec();
+        error = err;
+      }
+      cmd.event->complete(err);
+      cmd.event->release();
+      cmd.exec = nullptr;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        --pending;
+      }
+      cv.notify_all();
+    }
+  }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 extern int vx_dev_open(vx_device_h* hdevice) {
   {
     const char* driverName = getenv("VORTEX_DRIVER");
@@ -87,6 +526,11 @@ extern int vx_dev_open(vx_device_h* hdevice) {
     return err;
   });
 
+  {
+    std::lock_guard<std::mutex> guard(g_registry_mutex);
+    g_devices[_hdevice] = std::make_shared<device_ctx_t>();
+  }
+
   CHECK_ERR(dcr_initialize(_hdevice), {
     return err;
   });
@@ -97,71 +541,194 @@ extern int vx_dev_open(vx_device_h* hdevice) {
 }
 
 extern int vx_dev_close(vx_device_h hdevice) {
+  auto ctx = find_device(hdevice);
+  if (ctx) {
+    // drain and release the device queues
+    std::vector<vx_queue*> queues;
+    {
+      std::lock_guard<std::mutex> guard(g_registry_mutex);
+      queues.assign(ctx->queues.begin(), ctx->queues.end());
+    }
+    for (auto queue : queues) {
+      vx_queue_destroy(queue);
+    }
+  }
   vx_dump_perf(hdevice, stdout);
-  int ret = (g_callbacks.dev_close)(hdevice);
+  if (get_launch_export() != nullptr) {
+    DeviceLock lock(ctx);
+    if (ctx && ctx->perf_pending) {
+      wait_kernel(ctx.get(), hdevice, VX_MAX_TIMEOUT);
+    }
+  } else {
+    auto export_file = getenv("VORTEX_PERF_EXPORT");
+    if (export_file != nullptr && export_file[0] != '\0') {
+      export_perf(hdevice, export_file);
+    }
+  }
+  int ret;
+  {
+    DeviceLock lock(ctx);
+    ret = (g_callbacks.dev_close)(hdevice);
+  }
+  {
+    std::lock_guard<std::mutex> guard(g_registry_mutex);
+    g_devices.erase(hdevice);
+    for (auto it = g_buffers.begin(); it != g_buffers.end();) {
+      if (it->second == ctx) {
+        it = g_buffers.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
   dlclose(g_drv_handle);
   return ret;
 }
 
 extern int vx_dev_caps(vx_device_h hdevice, uint32_t caps_id, uint64_t* value) {
+  DeviceLock lock(find_device(hdevice));
   return (g_callbacks.dev_caps)(hdevice, caps_id, value);
 }
 
 extern int vx_mem_alloc(vx_device_h hdevice, uint64_t size, int flags, vx_buffer_h* hbuffer) {
-  return (g_callbacks.mem_alloc)(hdevice, size, flags, hbuffer);
+  auto ctx = find_device(hdevice);
+  DeviceLock lock(ctx);
+  int err = (g_callbacks.mem_alloc)(hdevice, size, flags, hbuffer);
+  if (err != 0 && evict_kernels(ctx.get())) {
+    err = (g_callbacks.mem_alloc)(hdevice, size, flags, hbuffer);
+  }
+  if (err != 0)
+    return err;
+  std::lock_guard<std::mutex> guard(g_registry_mutex);
+  g_buffers[*hbuffer] = ctx;
+  return 0;
 }
 
 extern int vx_mem_reserve(vx_device_h hdevice, uint64_t address, uint64_t size, int flags, vx_buffer_h* hbuffer) {
-  return (g_callbacks.mem_reserve)(hdevice, address, size, flags, hbuffer);
+  auto ctx = find_device(hdevice);
+  DeviceLock lock(ctx);
+  int err = (g_callbacks.mem_reserve)(hdevice, address, size, flags, hbuffer);
+  if (err != 0 && evict_kernels(ctx.get(), address, size)) {
+    err = (g_callbacks.mem_reserve)(hdevice, address, size, flags, hbuffer);
+  }
+  if (err != 0)
+    return err;
+  std::lock_guard<std::mutex> guard(g_registry_mutex);
+  g_buffers[*hbuffer] = ctx;
+  return 0;
 }
 
 extern int vx_mem_free(vx_buffer_h hbuffer) {
+  auto ctx = find_buffer(hbuffer);
+  DeviceLock lock(ctx);
+  if (ctx) {
+    auto it = ctx->kernel_buffers.find(hbuffer);
+    if (it != ctx->kernel_buffers.end()) {
+      auto entry = it->second;
+      if (entry->refs == 0)
+        return -1;
+      // cached images stay resident
+      if (--entry->refs != 0 || entry->valid)
+        return 0;
+      return release_kernel(ctx.get(), entry);
+    }
+  }
+  {
+    std::lock_guard<std::mutex> guard(g_registry_mutex);
+    g_buffers.erase(hbuffer);
+  }
   return (g_callbacks.mem_free)(hbuffer);
 }
 
 extern int vx_mem_access(vx_buffer_h hbuffer, uint64_t offset, uint64_t size, int flags) {
+  DeviceLock lock(find_buffer(hbuffer));
   return (g_callbacks.mem_access)(hbuffer, offset, size, flags);
 }
 
+extern int vx_mem_map(vx_buffer_h hbuffer, uint64_t offset, uint64_t size, int flags, void** host_ptr) {
+  auto ctx = find_buffer(hbuffer);
+  DeviceLock lock(ctx);
+  if (flags & VX_MEM_WRITE) {
+    invalidate_kernels(ctx.get(), hbuffer, offset, size);
+  }
+  return (g_callbacks.mem_map)(hbuffer, offset, size, flags, host_ptr);
+}
+
+extern int vx_mem_unmap(vx_buffer_h hbuffer, void* host_ptr) {
+  DeviceLock lock(find_buffer(hbuffer));
+  return (g_callbacks.mem_unmap)(hbuffer, host_ptr);
+}
+
 extern int vx_mem_address(vx_buffer_h hbuffer, uint64_t* address) {
   return (g_callbacks.mem_address)(hbuffer, address);
 }
 
 extern int vx_mem_info(vx_device_h hdevice, uint64_t* mem_free, uint64_t* mem_used) {
+  DeviceLock lock(find_device(hdevice));
   return (g_callbacks.mem_info)(hdevice, mem_free, mem_used);
 }
 
 extern int vx_copy_to_dev(vx_buffer_h hbuffer, const void* host_ptr, uint64_t dst_offset, uint64_t size) {
+  auto ctx = find_buffer(hbuffer);
+  DeviceLock lock(ctx);
+  invalidate_kernels(ctx.get(), hbuffer, dst_offset, size);
   return (g_callbacks.copy_to_dev)(hbuffer, host_ptr, dst_offset, size);
 }
 
 extern int vx_copy_from_dev(void* host_ptr, vx_buffer_h hbuffer, uint64_t src_offset, uint64_t size) {
+  DeviceLock lock(find_buffer(hbuffer));
   return (g_callbacks.copy_from_dev)(host_ptr, hbuffer, src_offset, size);
 }
 
+extern int vx_copy_dev_to_dev(vx_buffer_h hdst, uint64_t dst_offset, vx_buffer_h hsrc, uint64_t src_offset, uint64_t size) {
+  auto ctx = find_buffer(hdst);
+  if (ctx != find_buffer(hsrc))
+    return -1;
+  DeviceLock lock(ctx);
+  invalidate_kernels(ctx.get(), hdst, dst_offset, size);
+  return (g_callbacks.copy_dev_to_dev)(hdst, dst_offset, hsrc, src_offset, size);
+}
+
+extern int vx_mem_fill(vx_buffer_h hbuffer, uint64_t offset, uint64_t size, const void* pattern, uint32_t pattern_size) {
+  auto ctx = find_buffer(hbuffer);
+  DeviceLock lock(ctx);
+  invalidate_kernels(ctx.get(), hbuffer, offset, size);
+  return (g_callbacks.mem_fill)(hbuffer, offset, size, pattern, pattern_size);
+}
+
 extern int vx_start(vx_device_h hdevice, vx_buffer_h hkernel, vx_buffer_h harguments) {
-  int profiling_mode = get_profiling_mode();
-  if (profiling_mode != 0) {
-    CHECK_ERR(vx_dcr_write(hdevice, VX_DCR_BASE_MPM_CLASS, profiling_mode), {
-      return err;
-    });
-  }
-  return (g_callbacks.start)(hdevice, hkernel, harguments);
+  return vx_start_ex(hdevice, hkernel, harguments, 0);
+}
+
+extern int vx_start_ex(vx_device_h hdevice, vx_buffer_h hkernel, vx_buffer_h harguments, int flags) {
+  auto ctx = find_device(hdevice);
+  DeviceLock lock(ctx);
+  return start_kernel(ctx.get(), hdevice, hkernel, harguments, flags);
+}
+
+extern int vx_cache_flush(vx_device_h hdevice) {
+  DeviceLock lock(find_device(hdevice));
+  return (g_callbacks.cache_flush)(hdevice);
 }
 
 extern int vx_ready_wait(vx_device_h hdevice, uint64_t timeout) {
-  return (g_callbacks.ready_wait)(hdevice, timeout);
+  auto ctx = find_device(hdevice);
+  DeviceLock lock(ctx);
+  return wait_kernel(ctx.get(), hdevice, timeout);
 }
 
 extern int vx_dcr_read(vx_device_h hdevice, uint32_t addr, uint32_t* value) {
+  DeviceLock lock(find_device(hdevice));
   return (g_callbacks.dcr_read)(hdevice, addr, value);
 }
 
 extern int vx_dcr_write(vx_device_h hdevice, uint32_t addr, uint32_t value) {
+  DeviceLock lock(find_device(hdevice));
   return (g_callbacks.dcr_write)(hdevice, addr, value);
 }
 
 extern int vx_mpm_query(vx_device_h hdevice, uint32_t addr, uint32_t core_id, uint64_t* value) {
+  DeviceLock lock(find_device(hdevice));
   if (core_id == 0xffffffff) {
     uint64_t num_cores;
     CHECK_ERR((g_callbacks.dev_caps)(hdevice, VX_CAPS_NUM_CORES, &num_cores), {
@@ -180,4 +747,160 @@ extern int vx_mpm_query(vx_device_h hdevice, uint32_t addr, uint32_t core_id, ui
   } else {
     return (g_callbacks.mpm_query)(hdevice, addr, core_id, value);
   }
-}
\ No newline at end of file
+}
+
+extern int vx_mpm_snapshot(vx_device_h hdevice, uint64_t* values) {
+  DeviceLock lock(find_device(hdevice));
+  return (g_callbacks.mpm_snapshot)(hdevice, values);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+extern int vx_queue_create(vx_device_h hdevice, vx_queue_h* hqueue) {
+  if (nullptr == hqueue)
+    return -1;
+  auto ctx = find_device(hdevice);
+  if (nullptr == ctx)
+    return -1;
+  auto queue = new vx_queue(hdevice, ctx);
+  {
+    std::lock_guard<std::mutex> guard(g_registry_mutex);
+    ctx->queues.insert(queue);
+  }
+  *hqueue = queue;
+  return 0;
+}
+
+extern int vx_queue_destroy(vx_queue_h hqueue) {
+  if (nullptr == hqueue)
+    return -1;
+  auto queue = (vx_queue*)hqueue;
+  {
+    std::lock_guard<std::mutex> guard(g_registry_mutex);
+    queue->ctx->queues.erase(queue);
+  }
+  delete queue; // drains pending commands
+  return 0;
+}
+
+extern int vx_queue_finish(vx_queue_h hqueue, uint64_t timeout) {
+  if (nullptr == hqueue)
+    return -1;
+  return ((vx_queue*)hqueue)->finish(timeout);
+}
+
+extern int vx_enqueue_copy_to_dev(vx_queue_h hqueue, vx_buffer_h hbuffer, const void* host_ptr, uint64_t dst_offset, uint64_t size, vx_event_h* hevent) {
+  if (nullptr == hqueue || nullptr == hbuffer || nullptr == host_ptr)
+    return -1;
+  auto queue = (vx_queue*)hqueue;
+  return queue->enqueue([queue, hbuffer, host_ptr, dst_offset, size]() {
+    DeviceLock lock(queue->ctx);
+    invalidate_kernels(queue->ctx.get(), hbuffer, dst_offset, size);
+    return (g_callbacks.copy_to_dev)(hbuffer, host_ptr, dst_offset, size);
+  }, hevent);
+}
+
+extern int vx_enqueue_copy_from_dev(vx_queue_h hqueue, void* host_ptr, vx_buffer_h hbuffer, uint64_t src_offset, uint64_t size, vx_event_h* hevent) {
+  if (nullptr == hqueue || nullptr == hbuffer || nullptr == host_ptr)
+    return -1;
+  auto queue = (vx_queue*)hqueue;
+  return queue->enqueue([queue, host_ptr, hbuffer, src_offset, size]() {
+    DeviceLock lock(queue->ctx);
+    return (g_callbacks.copy_from_dev)(host_ptr, hbuffer, src_offset, size);
+  }, hevent);
+}
+
+extern int vx_enqueue_copy_dev_to_dev(vx_queue_h hqueue, vx_buffer_h hdst, uint64_t dst_offset, vx_buffer_h hsrc, uint64_t src_offset, uint64_t size, vx_event_h* hevent) {
+  if (nullptr == hqueue || nullptr == hdst || nullptr == hsrc)
+    return -1;
+  auto queue = (vx_queue*)hqueue;
+  return queue->enqueue([queue, hdst, dst_offset, hsrc, src_offset, size]() {
+    DeviceLock lock(queue->ctx);
+    invalidate_kernels(queue->ctx.get(), hdst, dst_offset, size);
+    return (g_callbacks.copy_dev_to_dev)(hdst, dst_offset, hsrc, src_offset, size);
+  }, hevent);
+}
+
+extern int vx_enqueue_fill(vx_queue_h hqueue, vx_buffer_h hbuffer, uint64_t offset, uint64_t size, const void* pattern, uint32_t pattern_size, vx_event_h* hevent) {
+  if (nullptr == hqueue || nullptr == hbuffer || nullptr == pattern || 0 == pattern_size)
+    return -1;
+  auto queue = (vx_queue*)hqueue;
+  auto p = (const uint8_t*)pattern;
+  std::vector<uint8_t> _pattern(p, p + pattern_size);
+  return queue->enqueue([queue, hbuffer, offset, size, _pattern]() {
+    DeviceLock lock(queue->ctx);
+    invalidate_kernels(queue->ctx.get(), hbuffer, offset, size);
+    return (g_callbacks.mem_fill)(hbuffer, offset, size, _pattern.data(), _pattern.size());
+  }, hevent);
+}
+
+extern int vx_enqueue_start(vx_queue_h hqueue, vx_buffer_h hkernel, vx_buffer_h harguments, vx_event_h* hevent) {
+  return vx_enqueue_start_ex(hqueue, hkernel, harguments, 0, hevent);
+}
+
+extern int vx_enqueue_start_ex(vx_queue_h hqueue, vx_buffer_h hkernel, vx_buffer_h harguments, int flags, vx_event_h* hevent) {
+  if (nullptr == hqueue || nullptr == hkernel || nullptr == harguments)
+    return -1;
+  auto queue = (vx_queue*)hqueue;
+  return queue->enqueue([queue, hkernel, harguments, flags]() {
+    DeviceLock lock(queue->ctx);
+    CHECK_ERR(start_kernel(queue->ctx.get(), queue->device, hkernel, harguments, flags), {
+      return err;
+    });
+    // other queues can use the device while the kernel runs
+    return wait_kernel(queue->ctx.get(), queue->device, VX_MAX_TIMEOUT);
+  }, hevent);
+}
+
+extern int vx_enqueue_barrier(vx_queue_h hqueue, uint32_t num_events, const vx_event_h* events, vx_event_h* hevent) {
+  if (nullptr == hqueue || (num_events != 0 && nullptr == events))
+    return -1;
+  auto queue = (vx_queue*)hqueue;
+  // hold the events until the barrier is released
+  auto deps = std::shared_ptr<std::vector<vx_event*>>(
+    new std::vector<vx_event*>(), [](std::vector<vx_event*>* list) {
+      for (auto event : *list) {
+        event->release();
+      }
+      delete list;
+    });
+  for (uint32_t i = 0; i < num_events; ++i) {
+    if (nullptr == events[i])
+      return -1;
+    auto event = (vx_event*)events[i];
+    event->retain();
+    deps->push_back(event);
+  }
+  return queue->enqueue([deps]() {
+    int ret = 0;
+    for (auto event : *deps) {
+      int err = event->wait(VX_MAX_TIMEOUT);
+      if (ret == 0) {
+        ret = err;
+      }
+    }
+    return ret;
+  }, hevent);
+}
+
+extern int vx_event_wait(vx_event_h hevent, uint64_t timeout) {
+  if (nullptr == hevent)
+    return -1;
+  return ((vx_event*)hevent)->wait(timeout);
+}
+
+extern int vx_event_query(vx_event_h hevent, int* status) {
+  if (nullptr == hevent || nullptr == status)
+    return -1;
+  auto event = (vx_event*)hevent;
+  std::lock_guard<std::mutex> lock(event->mutex);
+  *status = event->status;
+  return 0;
+}
+
+extern int vx_event_release(vx_event_h hevent) {
+  if (nullptr == hevent)
+    return -1;
+  ((vx_event*)hevent)->release();
+  return 0;
+}
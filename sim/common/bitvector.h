@@ -17,6 +17,131 @@
 
 namespace vortex {
 
+// Word storage with inline capacity for N words,
+// falling back to the heap for larger sizes.
+template <typename T, size_t N>
+class BitWords {
+public:
+  BitWords() : size_(0), capacity_(N), heap_(nullptr) {}
+
+  BitWords(const BitWords& other) : BitWords() {
+    this->assign(other);
+  }
+
+  BitWords(BitWords&& other) noexcept : BitWords() {
+    this->steal(other);
+  }
+
+  ~BitWords() {
+    delete[] heap_;
+  }
+
+  BitWords& operator=(const BitWords& other) {
+    if (this != &other) {
+      this->assign(other);
+    }
+    return *this;
+  }
+
+  BitWords& operator=(BitWords&& other) noexcept {
+    if (this != &other) {
+      delete[] heap_;
+      heap_ = nullptr;
+      capacity_ = N;
+      this->steal(other);
+    }
+    return *this;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  T* data() {
+    return heap_ ? heap_ : inline_;
+  }
+
+  const T* data() const {
+    return heap_ ? heap_ : inline_;
+  }
+
+  T& operator[](size_t i) {
+    return this->data()[i];
+  }
+
+  const T& operator[](size_t i) const {
+    return this->data()[i];
+  }
+
+  T& at(size_t i) {
+    if (i >= size_) throw std::out_of_range("Index out of range");
+    return this->data()[i];
+  }
+
+  const T& at(size_t i) const {
+    if (i >= size_) throw std::out_of_range("Index out of range");
+    return this->data()[i];
+  }
+
+  T& back() {
+    return this->data()[size_ - 1];
+  }
+
+  T* begin() { return this->data(); }
+  T* end() { return this->data() + size_; }
+  const T* begin() const { return this->data(); }
+  const T* end() const { return this->data() + size_; }
+
+  void clear() {
+    size_ = 0;
+  }
+
+  void resize(size_t size, T value = 0) {
+    if (size > capacity_) {
+      // grow onto the heap
+      T* words = new T[size];
+      std::copy(this->begin(), this->end(), words);
+      delete[] heap_;
+      heap_ = words;
+      capacity_ = size;
+    }
+    if (size > size_) {
+      std::fill(this->data() + size_, this->data() + size, value);
+    }
+    size_ = size;
+  }
+
+  bool operator==(const BitWords& other) const {
+    return size_ == other.size_ && std::equal(this->begin(), this->end(), other.begin());
+  }
+
+private:
+
+  void assign(const BitWords& other) {
+    size_ = 0;
+    this->resize(other.size_);
+    std::copy(other.begin(), other.end(), this->data());
+  }
+
+  void steal(BitWords& other) {
+    if (other.heap_) {
+      heap_ = other.heap_;
+      capacity_ = other.capacity_;
+      other.heap_ = nullptr;
+      other.capacity_ = N;
+    } else {
+      std::copy(other.inline_, other.inline_ + other.size_, inline_);
+    }
+    size_ = other.size_;
+    other.size_ = 0;
+  }
+
+  size_t size_;
+  size_t capacity_;
+  T* heap_;
+  T inline_[N];
+};
+
 template <typename T = uint32_t>
 class BitVector {
 private:
@@ -46,11 +171,56 @@ private:
   };
 
   static constexpr size_t BITS_PER_WORD = sizeof(T) * 8;
+
+  // masks up to INLINE_BITS wide are stored without heap allocation
+  static constexpr size_t INLINE_BITS = 256;
+  static constexpr size_t INLINE_WORDS = (INLINE_BITS + BITS_PER_WORD - 1) / BITS_PER_WORD;
+
   size_t size_;
   T single_word_;
-  std::vector<T> words_;
+  BitWords<T, INLINE_WORDS> words_;
   bool all_zero_;
 
+  static size_t popcount(T word) {
+    if constexpr (sizeof(T) <= sizeof(unsigned int)) {
+      return __builtin_popcount(word);
+    } else if constexpr (sizeof(T) <= sizeof(unsigned long)) {
+      return __builtin_popcountl(word);
+    } else {
+      return __builtin_popcountll(word);
+    }
+  }
+
+  // index of the lowest set bit, word must not be zero
+  static size_t ctz(T word) {
+    if constexpr (sizeof(T) <= sizeof(unsigned int)) {
+      return __builtin_ctz(word);
+    } else if constexpr (sizeof(T) <= sizeof(unsigned long)) {
+      return __builtin_ctzl(word);
+    } else {
+      return __builtin_ctzll(word);
+    }
+  }
+
+  // index of the highest set bit, word must not be zero
+  static size_t msb(T word) {
+    if constexpr (sizeof(T) <= sizeof(unsigned int)) {
+      return sizeof(unsigned int) * 8 - 1 - __builtin_clz(word);
+    } else if constexpr (sizeof(T) <= sizeof(unsigned long)) {
+      return sizeof(unsigned long) * 8 - 1 - __builtin_clzl(word);
+    } else {
+      return sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(word);
+    }
+  }
+
+  size_t num_words() const {
+    return (size_ <= BITS_PER_WORD) ? 1 : words_.size();
+  }
+
+  T get_word(size_t idx) const {
+    return (size_ <= BITS_PER_WORD) ? single_word_ : words_[idx];
+  }
+
   constexpr size_t wordIndex(size_t pos) const {
     return pos / BITS_PER_WORD;
   }
@@ -197,6 +367,9 @@ public:
     } else {
       size_t num_blocks = (new_size + (BITS_PER_WORD - 1)) / BITS_PER_WORD;
       words_.resize(num_blocks, 0);
+      if (size_ <= BITS_PER_WORD) {
+        words_[0] = single_word_; // move the inline word
+      }
     }
     size_ = new_size;
     this->clearUnusedBits();
@@ -313,7 +486,8 @@ public:
     } else {
       size_t remaining_bits = size_ % BITS_PER_WORD;
       if (remaining_bits != 0) {
-        std::vector<T> reversed_words(words_.size(), 0);
+        BitWords<T, INLINE_WORDS> reversed_words;
+        reversed_words.resize(words_.size(), 0);
         for (size_t i = 0; i < size_; ++i) {
           size_t reversed_pos = size_ - 1 - i;
           size_t src_word = i / BITS_PER_WORD;
@@ -335,29 +509,63 @@ public:
   }
 
   size_t count() const {
-   if (size_ <= BITS_PER_WORD) {
-      if constexpr (sizeof(T) <= sizeof(unsigned int)) {
-        return __builtin_popcount(single_word_);
-      } else if constexpr (sizeof(T) <= sizeof(unsigned long)) {
-        return __builtin_popcountl(single_word_);
-      } else {
-        return __builtin_popcountll(single_word_);
-      }
+    if (size_ <= BITS_PER_WORD) {
+      return popcount(single_word_);
     } else {
       size_t count = 0;
       for (auto word : words_) {
-        if constexpr (sizeof(T) <= sizeof(unsigned int)) {
-          count += __builtin_popcount(word);
-        } else if constexpr (sizeof(T) <= sizeof(unsigned long)) {
-          count += __builtin_popcountl(word);
-        } else {
-          count += __builtin_popcountll(word);
-        }
+        count += popcount(word);
       }
       return count;
     }
   }
 
+  // index of the lowest set bit, or size() if none
+  size_t find_first() const {
+    for (size_t i = 0, n = this->num_words(); i < n; ++i) {
+      T word = this->get_word(i);
+      if (word != 0)
+        return i * BITS_PER_WORD + ctz(word);
+    }
+    return size_;
+  }
+
+  // index of the lowest set bit after pos, or size() if none
+  size_t find_next(size_t pos) const {
+    ++pos;
+    if (pos >= size_)
+      return size_;
+    size_t i = this->wordIndex(pos);
+    T word = this->get_word(i) & ~(this->wordOffset(pos) - 1);
+    for (size_t n = this->num_words();;) {
+      if (word != 0)
+        return i * BITS_PER_WORD + ctz(word);
+      if (++i == n)
+        return size_;
+      word = this->get_word(i);
+    }
+  }
+
+  // index of the highest set bit, or size() if none
+  size_t find_last() const {
+    for (size_t i = this->num_words(); i-- != 0;) {
+      T word = this->get_word(i);
+      if (word != 0)
+        return i * BITS_PER_WORD + msb(word);
+    }
+    return size_;
+  }
+
+  // invoke f(index) for each set bit, in increasing order
+  template <typename F>
+  void for_each_set(F&& f) const {
+    for (size_t i = 0, n = this->num_words(); i < n; ++i) {
+      for (T word = this->get_word(i); word != 0; word &= word - 1) {
+        f(i * BITS_PER_WORD + ctz(word));
+      }
+    }
+  }
+
   bool none() const {
     return all_zero_;
   }
@@ -458,6 +666,9 @@ public:
     if (size_ > sizeof(unsigned long) * 8) {
       throw std::overflow_error("BitVector size exceeds unsigned long capacity");
     }
+    if (size_ <= BITS_PER_WORD) {
+      return single_word_;
+    }
 
     unsigned long result = 0;
     for (size_t i = 0; i < size_; ++i) {
@@ -472,6 +683,9 @@ public:
     if (size_ > sizeof(unsigned long long) * 8) {
       throw std::overflow_error("BitVector size exceeds unsigned long long capacity");
     }
+    if (size_ <= BITS_PER_WORD) {
+      return single_word_;
+    }
 
     unsigned long long result = 0;
     for (size_t i = 0; i < size_; ++i) {
@@ -14,6 +14,13 @@
 #include "dram_sim.h"
 #include "util.h"
 #include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <stdlib.h>
+#include <assert.h>
 
 DISABLE_WARNING_PUSH
 DISABLE_WARNING_UNUSED_PARAMETER
@@ -23,14 +30,92 @@ DISABLE_WARNING_MISSING_FIELD_INITIALIZERS
 #include <base/config.h>
 #include <frontend/frontend.h>
 #include <memory_system/memory_system.h>
+#include <dram/dram.h>
+#include <dram_controller/controller.h>
+#include <dram_controller/plugin.h>
 DISABLE_WARNING_POP
 
 using namespace vortex;
 
+namespace {
+
+// per-channel statistics recorded by the memory controllers
+struct dram_ctrl_stats_t {
+	DramSim::PerfStats* perf_stats;
+	uint32_t access_size;         // bytes counted per access
+	std::vector<int> last_access; // last access type per channel, -1 if none
+};
+
+// statistics of the DramSim instance whose memory system is being built
+thread_local dram_ctrl_stats_t* g_ctrl_stats = nullptr;
+
+}
+
+namespace Ramulator {
+
+// Classifies each request the way the controller schedules it. Plugins run
+// right before the controller issues the selected command, so the row-buffer
+// state seen here is the one the controller uses for its own statistics.
+class VortexDramStats : public IControllerPlugin, public Implementation {
+	RAMULATOR_REGISTER_IMPLEMENTATION(IControllerPlugin, VortexDramStats, "VortexDramStats", "Collects Vortex DRAM statistics.")
+private:
+	IDRAM* m_dram = nullptr;
+	dram_ctrl_stats_t* m_stats = nullptr;
+	int m_channel = -1;
+
+public:
+	void init() override {
+		m_stats = g_ctrl_stats;
+	}
+
+	void setup(IFrontEnd* frontend, IMemorySystem* memory_system) override {
+		__unused (frontend, memory_system);
+		m_ctrl = cast_parent<IDRAMController>();
+		m_dram = m_ctrl->m_dram;
+		m_channel = m_ctrl->m_channel_id;
+	}
+
+	void update(bool request_found, ReqBuffer::iterator& req_it) override {
+		if (!request_found || m_stats == nullptr)
+			return;
+		int type = req_it->type_id;
+		if (type != Request::Type::Read && type != Request::Type::Write)
+			return;
+		auto& perf_stats = *m_stats->perf_stats;
+		if (!req_it->is_stat_updated) {
+			// first command issued for this request
+			if (m_dram->check_rowbuffer_hit(req_it->final_command, req_it->addr_vec)) {
+				++perf_stats.row_hits;
+			} else if (m_dram->check_node_open(req_it->final_command, req_it->addr_vec)) {
+				++perf_stats.row_conflicts;
+			} else {
+				++perf_stats.row_misses;
+			}
+		}
+		if (!m_dram->m_command_meta(req_it->command).is_accessing)
+			return;
+		auto& last_access = m_stats->last_access.at(m_channel);
+		if (last_access != -1 && last_access != type) {
+			++perf_stats.rw_turnarounds;
+		}
+		last_access = type;
+		if (uint32_t(m_channel) < DramSim::MAX_CHANNELS) {
+			if (type == Request::Type::Read) {
+				perf_stats.channel_read_bytes[m_channel] += m_stats->access_size;
+			} else {
+				perf_stats.channel_write_bytes[m_channel] += m_stats->access_size;
+			}
+		}
+	}
+};
+
+}
+
 class DramSim::Impl {
 private:
 	struct mem_req_t {
 		uint64_t addr;
+		int channel; // requested channel, -1 if selected by the address mapper
 		bool is_write;
 		ResponseCallback callback;
 		void* arg;
@@ -44,6 +129,30 @@ private:
 	static const uint32_t tick_cycles_ = 1000;
 	static const uint32_t dram_channel_size_ = 16; // 128 bits
 	std::queue<mem_req_t> pending_reqs_;
+	uint32_t num_inflight_;
+	uint32_t num_channels_;
+	uint32_t lg2_num_channels_;
+	uint32_t lg2_tx_size_;
+	PerfStats perf_stats_;
+	dram_ctrl_stats_t ctrl_stats_;
+
+	// time-series export, enabled with VORTEX_DRAM_TIMELINE=<file>[:<interval>]
+	std::ofstream timeline_;
+	uint64_t timeline_interval_;
+	PerfStats timeline_last_;
+
+	void update_read_stats(const Ramulator::Request& dram_req, int channel) {
+		// address vector: channel, ..., bank, row, column
+		uint32_t dram_channel = dram_req.addr_vec.at(0);
+		if (channel != -1 && dram_channel != uint32_t(channel)) {
+			// the address mapper does not keep the channel in the low bits
+			if (perf_stats_.channel_mismatches++ == 0) {
+				std::cerr << "Warning: DRAM request for channel " << channel
+				          << " decoded to channel " << dram_channel << std::endl;
+			}
+		}
+		perf_stats_.read_latency += dram_req.depart - dram_req.arrive;
+	}
 
 	void handle_pending_requests() {
 		if (pending_reqs_.empty())
@@ -52,9 +161,16 @@ private:
 		auto req_type = req.is_write ? Ramulator::Request::Type::Write : Ramulator::Request::Type::Read;
 		std::function<void(Ramulator::Request&)> callback = nullptr;
 		if (req.callback) {
-			callback = [req_callback = std::move(req.callback), req_arg = std::move(req.arg)](Ramulator::Request& /*dram_req*/) {
+			callback = [this, channel = req.channel, req_callback = std::move(req.callback), req_arg = std::move(req.arg)](Ramulator::Request& dram_req) {
+				--num_inflight_;
+				this->update_read_stats(dram_req, channel);
 				req_callback(req_arg);
 			};
+		} else if (!req.is_write) {
+			// statistics only
+			callback = [this, channel = req.channel](Ramulator::Request& dram_req) {
+				this->update_read_stats(dram_req, channel);
+			};
 		}
 		if (ramulator_frontend_->receive_external_requests(req_type, req.addr, 0, callback)) {
 			if (req.is_write) {
@@ -62,13 +178,66 @@ private:
 				if (req.callback) {
 					req.callback(req.arg);
 				}
+			} else if (req.callback) {
+				++num_inflight_;
 			}
+			perf_stats_.reads += !req.is_write;
+			perf_stats_.writes += req.is_write;
+			perf_stats_.bytes += dram_channel_size_;
 			pending_reqs_.pop();
 		}
 	}
 
+	void open_timeline() {
+		auto env = getenv("VORTEX_DRAM_TIMELINE");
+		if (env == nullptr || env[0] == '\0')
+			return;
+		std::string value(env);
+		auto sep = value.find(':');
+		auto filename = value.substr(0, sep);
+		timeline_.open(filename);
+		if (!timeline_) {
+			std::cerr << "Error: failed to open DRAM timeline file: " << filename << std::endl;
+			return;
+		}
+		timeline_interval_ = 1000;
+		if (sep != std::string::npos) {
+			timeline_interval_ = std::max<int64_t>(1, std::atoll(value.c_str() + sep + 1));
+		}
+		timeline_ << "cycle,reads,writes,bytes,row_hits,row_misses,row_conflicts,rw_turnarounds,avg_queue";
+		for (uint32_t i = 0; i < this->num_stat_channels(); ++i) {
+			timeline_ << ",ch" << i << "_read_bytes,ch" << i << "_write_bytes";
+		}
+		timeline_ << std::endl;
+	}
+
+	void dump_timeline() {
+		// one row per interval, with counts relative to the previous row
+		auto& cur = perf_stats_;
+		auto& last = timeline_last_;
+		uint64_t cycles = cur.cycles - last.cycles;
+		timeline_ << cur.cycles
+		          << "," << (cur.reads - last.reads)
+		          << "," << (cur.writes - last.writes)
+		          << "," << (cur.bytes - last.bytes)
+		          << "," << (cur.row_hits - last.row_hits)
+		          << "," << (cur.row_misses - last.row_misses)
+		          << "," << (cur.row_conflicts - last.row_conflicts)
+		          << "," << (cur.rw_turnarounds - last.rw_turnarounds)
+		          << "," << (cycles ? double(cur.queue_occupancy - last.queue_occupancy) / cycles : 0.0);
+		for (uint32_t i = 0; i < this->num_stat_channels(); ++i) {
+			timeline_ << "," << (cur.channel_read_bytes[i] - last.channel_read_bytes[i])
+			          << "," << (cur.channel_write_bytes[i] - last.channel_write_bytes[i]);
+		}
+		timeline_ << std::endl;
+		timeline_last_ = cur;
+	}
+
 public:
-	Impl(uint32_t num_channels, uint32_t channel_size, float clock_ratio) {
+	Impl(uint32_t num_channels, uint32_t channel_size, float clock_ratio)
+		: num_channels_(num_channels)
+		, ctrl_stats_({&perf_stats_, dram_channel_size_, std::vector<int>(num_channels, -1)})
+		, timeline_interval_(0) {
 		YAML::Node dram_config;
 		dram_config["Frontend"]["impl"] = "GEM5";
 		dram_config["MemorySystem"]["impl"] = "GenericDRAM";
@@ -88,19 +257,40 @@ public:
 			draw_plugin["ControllerPlugin"]["path"] = "./trace/ramulator.log";
 			dram_config["MemorySystem"]["Controller"]["plugins"].push_back(draw_plugin);
 		}
-		dram_config["MemorySystem"]["AddrMapper"]["impl"] = "RoBaRaCoCh";
+		{
+			YAML::Node stats_plugin;
+			stats_plugin["ControllerPlugin"]["impl"] = "VortexDramStats";
+			dram_config["MemorySystem"]["Controller"]["plugins"].push_back(stats_plugin);
+		}
+		{
+			// channel/rank/bank/row/column bit order, e.g. RoBaRaCoCh, ChRaBaRoCo or MOP4CLXOR
+			auto addr_map = getenv("VORTEX_DRAM_ADDR_MAP");
+			dram_config["MemorySystem"]["AddrMapper"]["impl"] = (addr_map && addr_map[0] != '\0') ? addr_map : "RoBaRaCoCh";
+		}
 
+		// the controller plugins pick up this instance's statistics while being built
+		g_ctrl_stats = &ctrl_stats_;
 		ramulator_frontend_ = Ramulator::Factory::create_frontend(dram_config);
 		ramulator_memorysystem_ = Ramulator::Factory::create_memory_system(dram_config);
 		ramulator_frontend_->connect_memory_system(ramulator_memorysystem_);
 		ramulator_memorysystem_->connect_frontend(ramulator_frontend_);
+		g_ctrl_stats = nullptr;
+
+		// the linear address mappers place the channel right above the transaction offset
+		auto dram = ramulator_memorysystem_->get_ifce<Ramulator::IDRAM>();
+		lg2_num_channels_ = log2ceil(num_channels);
+		lg2_tx_size_ = log2ceil(dram->m_internal_prefetch_size * dram->m_channel_width / 8);
 
 		cpu_channel_size_ = channel_size;
 		scaled_dram_cycles_ = static_cast<uint64_t>(clock_ratio * tick_cycles_);
+		this->open_timeline();
 		this->reset();
 	}
 
 	~Impl() {
+		if (timeline_.is_open() && perf_stats_.cycles != timeline_last_.cycles) {
+			this->dump_timeline();
+		}
 		std::ofstream nullstream("ramulator.stats.log");
 		auto original_buf = std::cout.rdbuf();
 		std::cout.rdbuf(nullstream.rdbuf());
@@ -111,6 +301,29 @@ public:
 
 	void reset() {
 		cpu_cycles_ = 0;
+		num_inflight_ = 0;
+		std::fill(ctrl_stats_.last_access.begin(), ctrl_stats_.last_access.end(), -1);
+		if (timeline_.is_open() && perf_stats_.cycles != timeline_last_.cycles) {
+			this->dump_timeline();
+		}
+		perf_stats_ = PerfStats();
+		timeline_last_ = PerfStats();
+	}
+
+	const PerfStats& perf_stats() const {
+		return perf_stats_;
+	}
+
+	uint32_t num_channels() const {
+		return num_channels_;
+	}
+
+	uint32_t num_stat_channels() const {
+		return std::min(num_channels_, DramSim::MAX_CHANNELS);
+	}
+
+	bool busy() const {
+		return !pending_reqs_.empty() || num_inflight_ != 0;
 	}
 
 	void tick() {
@@ -119,29 +332,64 @@ public:
 			this->handle_pending_requests();
 			ramulator_memorysystem_->tick();
 			cpu_cycles_ -= scaled_dram_cycles_;
+			perf_stats_.queue_occupancy += pending_reqs_.size() + num_inflight_;
+			++perf_stats_.cycles;
+			if (timeline_interval_ != 0 && (perf_stats_.cycles % timeline_interval_) == 0) {
+				this->dump_timeline();
+			}
 		}
 	}
 
-	void send_request(uint64_t addr, bool is_write, ResponseCallback response_cb, void* arg) {
+	void skip(uint64_t cycles) {
+		// the controllers have nothing to schedule, only the cycle count moves,
+		// the Ramulator clock resumes where the memory went idle
+		assert(!this->busy());
+		cpu_cycles_ += cycles * tick_cycles_;
+		uint64_t dram_cycles = cpu_cycles_ / scaled_dram_cycles_;
+		cpu_cycles_ -= dram_cycles * scaled_dram_cycles_;
+		uint64_t end_cycles = perf_stats_.cycles + dram_cycles;
+		if (timeline_interval_ != 0) {
+			// keep the idle rows of the timeline
+			for (uint64_t c = (perf_stats_.cycles / timeline_interval_ + 1) * timeline_interval_; c <= end_cycles; c += timeline_interval_) {
+				perf_stats_.cycles = c;
+				this->dump_timeline();
+			}
+		}
+		perf_stats_.cycles = end_cycles;
+	}
+
+	void send_request(int channel, uint64_t addr, bool is_write, ResponseCallback response_cb, void* arg) {
 		// enqueue the request
 		if (cpu_channel_size_ > dram_channel_size_) {
 			uint32_t n = cpu_channel_size_ / dram_channel_size_;
 			for (uint32_t i = 0; i < n; ++i) {
-				uint64_t dram_byte_addr = (addr / cpu_channel_size_) * dram_channel_size_ + (i * dram_channel_size_);
+				uint64_t dram_byte_addr = this->channel_addr(channel, (addr / cpu_channel_size_) * dram_channel_size_ + (i * dram_channel_size_));
 				if (i == 0) {
-					pending_reqs_.push({dram_byte_addr, is_write, response_cb, arg});
+					pending_reqs_.push({dram_byte_addr, channel, is_write, response_cb, arg});
 				} else {
-					pending_reqs_.push({dram_byte_addr, is_write, nullptr, nullptr});
+					pending_reqs_.push({dram_byte_addr, channel, is_write, nullptr, nullptr});
 				}
 			}
 		} else if (cpu_channel_size_ < dram_channel_size_) {
-			uint64_t dram_byte_addr = (addr / cpu_channel_size_) * dram_channel_size_;
-			pending_reqs_.push({dram_byte_addr, is_write, response_cb, arg});
+			uint64_t dram_byte_addr = this->channel_addr(channel, (addr / cpu_channel_size_) * dram_channel_size_);
+			pending_reqs_.push({dram_byte_addr, channel, is_write, response_cb, arg});
 		} else {
-			uint64_t dram_byte_addr = addr;
-			pending_reqs_.push({dram_byte_addr, is_write, response_cb, arg});
+			uint64_t dram_byte_addr = this->channel_addr(channel, addr);
+			pending_reqs_.push({dram_byte_addr, channel, is_write, response_cb, arg});
 		}
 	}
+
+private:
+
+	// insert the channel index above the transaction offset of a per-channel address
+	uint64_t channel_addr(int channel, uint64_t addr) const {
+		if (channel == -1)
+			return addr;
+		uint64_t tx_mask = (uint64_t(1) << lg2_tx_size_) - 1;
+		return ((addr & ~tx_mask) << lg2_num_channels_)
+		     | (uint64_t(channel) << lg2_tx_size_)
+		     | (addr & tx_mask);
+	}
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -162,6 +410,23 @@ void DramSim::tick() {
   impl_->tick();
 }
 
+void DramSim::skip(uint64_t cycles) {
+  impl_->skip(cycles);
+}
+
+bool DramSim::busy() const {
+  return impl_->busy();
+}
+
 void DramSim::send_request(uint64_t addr, bool is_write, ResponseCallback callback, void* arg) {
-  impl_->send_request(addr, is_write, callback, arg);
+  impl_->send_request(-1, addr, is_write, callback, arg);
+}
+
+void DramSim::send_request(uint32_t channel, uint64_t addr, bool is_write, ResponseCallback callback, void* arg) {
+  assert(channel < impl_->num_channels());
+  impl_->send_request(channel, addr, is_write, callback, arg);
+}
+
+const DramSim::PerfStats& DramSim::perf_stats() const {
+  return impl_->perf_stats();
 }
\ No newline at end of file
@@ -11,6 +11,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#pragma once
+
 #include <stdint.h>
 
 namespace vortex {
@@ -19,6 +21,60 @@ class DramSim {
 public:
   typedef void (*ResponseCallback)(void *arg);
 
+  // channels with their own bandwidth counters
+  static constexpr uint32_t MAX_CHANNELS = 8;
+
+  struct PerfStats {
+    uint64_t reads;          // DRAM read transactions
+    uint64_t writes;         // DRAM write transactions
+    uint64_t row_hits;       // requests to the open row, as scheduled by the controller
+    uint64_t row_misses;     // requests to a bank without an open row
+    uint64_t row_conflicts;  // requests to a bank with another open row
+    uint64_t rw_turnarounds; // switches between read and write accesses on a channel
+    uint64_t queue_occupancy;// queued and in-flight requests, summed over DRAM cycles
+    uint64_t read_latency;   // read latency in DRAM cycles, summed over reads
+    uint64_t cycles;         // DRAM cycles
+    uint64_t bytes;          // bytes transferred
+    uint64_t channel_mismatches; // requests decoded to another channel than the one requested
+    uint64_t channel_read_bytes[MAX_CHANNELS];  // bytes read per channel
+    uint64_t channel_write_bytes[MAX_CHANNELS]; // bytes written per channel
+
+    PerfStats()
+      : reads(0)
+      , writes(0)
+      , row_hits(0)
+      , row_misses(0)
+      , row_conflicts(0)
+      , rw_turnarounds(0)
+      , queue_occupancy(0)
+      , read_latency(0)
+      , cycles(0)
+      , bytes(0)
+      , channel_mismatches(0)
+      , channel_read_bytes()
+      , channel_write_bytes()
+    {}
+
+    PerfStats& operator+=(const PerfStats& rhs) {
+      this->reads += rhs.reads;
+      this->writes += rhs.writes;
+      this->row_hits += rhs.row_hits;
+      this->row_misses += rhs.row_misses;
+      this->row_conflicts += rhs.row_conflicts;
+      this->rw_turnarounds += rhs.rw_turnarounds;
+      this->queue_occupancy += rhs.queue_occupancy;
+      this->read_latency += rhs.read_latency;
+      this->cycles += rhs.cycles;
+      this->bytes += rhs.bytes;
+      this->channel_mismatches += rhs.channel_mismatches;
+      for (uint32_t i = 0; i < MAX_CHANNELS; ++i) {
+        this->channel_read_bytes[i] += rhs.channel_read_bytes[i];
+        this->channel_write_bytes[i] += rhs.channel_write_bytes[i];
+      }
+      return *this;
+    }
+  };
+
   DramSim(uint32_t num_channels, uint32_t channel_size, float clock_ratio);
   ~DramSim();
 
@@ -26,9 +82,20 @@ public:
 
   void tick();
 
-  // addr: per-channel block address
+  // advance the clock by the given CPU cycles, the memory must be idle
+  void skip(uint64_t cycles);
+
+  // has queued requests or pending read responses
+  bool busy() const;
+
+  // addr: device address, the DRAM address mapper selects the channel
   void send_request(uint64_t addr, bool is_write, ResponseCallback response_cb, void* arg);
 
+  // addr: address within the given channel, for callers doing their own channel interleave
+  void send_request(uint32_t channel, uint64_t addr, bool is_write, ResponseCallback response_cb, void* arg);
+
+  const PerfStats& perf_stats() const;
+
 private:
 	class Impl;
 	Impl* impl_;
@@ -16,9 +16,13 @@
 #include <iostream>
 #include <fstream>
 #include <assert.h>
+#include <string.h>
+#include <algorithm>
 #include "util.h"
 #include <VX_config.h>
 #include <bitset>
+#include <stdio.h>
+#include <stdlib.h>
 
 using namespace vortex;
 
@@ -30,6 +34,187 @@ using namespace vortex;
 // #endif
 #endif
 
+#ifdef VM_ENABLE
+namespace {
+
+// TLB hierarchy geometry, selected at runtime with
+// VORTEX_TLB=<l1_entries>:<l1_ways>[,<l2_entries>:<l2_ways>] (default: a
+// fully-associative L1 of TLB_SIZE entries, no L2) and
+// VORTEX_TLB_PWC=<entries> (default: 0, no page-walk cache).
+// L1 misses cost VORTEX_TLB_LATENCY=<l2_hit>:<pte_read> cycles
+// (default: 8 for an L2 hit, 40 per page-table entry read).
+struct tlb_config_t {
+  uint32_t l1_entries;
+  uint32_t l1_ways;
+  uint32_t l2_entries;
+  uint32_t l2_ways;
+  uint32_t pwc_entries;
+  uint32_t l2_latency;
+  uint32_t pte_latency;
+
+  tlb_config_t()
+    : l1_entries(TLB_SIZE)
+    , l1_ways(TLB_SIZE)
+    , l2_entries(0)
+    , l2_ways(0)
+    , pwc_entries(0)
+    , l2_latency(8)
+    , pte_latency(40) {
+    auto env = getenv("VORTEX_TLB");
+    if (env != nullptr && env[0] != '\0') {
+      int n = sscanf(env, "%u:%u,%u:%u", &l1_entries, &l1_ways, &l2_entries, &l2_ways);
+      if ((n != 2 && n != 4)
+       || !is_valid(l1_entries, l1_ways)
+       || (l2_entries != 0 && !is_valid(l2_entries, l2_ways))) {
+        std::cerr << "Error: invalid TLB configuration: " << env << std::endl;
+        std::abort();
+      }
+    }
+    auto pwc = getenv("VORTEX_TLB_PWC");
+    if (pwc != nullptr && pwc[0] != '\0') {
+      pwc_entries = std::atoi(pwc);
+    }
+    auto latency = getenv("VORTEX_TLB_LATENCY");
+    if (latency != nullptr && latency[0] != '\0') {
+      if (sscanf(latency, "%u:%u", &l2_latency, &pte_latency) != 2) {
+        std::cerr << "Error: invalid TLB latency: " << latency << std::endl;
+        std::abort();
+      }
+    }
+  }
+
+  static bool is_valid(uint32_t entries, uint32_t ways) {
+    return entries != 0 && ways != 0 && (entries % ways) == 0;
+  }
+};
+
+const tlb_config_t& tlb_config() {
+  static tlb_config_t s_config;
+  return s_config;
+}
+
+}
+
+TLB::TLB(uint32_t num_entries, uint32_t num_ways)
+  : entries_(num_entries)
+  , num_sets_(num_ways ? (num_entries / num_ways) : 0)
+  , num_ways_(num_ways) {
+  this->flush();
+}
+
+TLB::entry_t* TLB::lookup(uint64_t vAddr) {
+  // probe the set of each cached page size
+  for (uint32_t mask = size_mask_; mask != 0; mask &= mask - 1) {
+    uint32_t size_bits = __builtin_ctz(mask);
+    uint64_t vpn = vAddr >> size_bits;
+    auto set = &entries_.at((vpn % num_sets_) * num_ways_);
+    for (uint32_t w = 0; w < num_ways_; ++w) {
+      auto& entry = set[w];
+      if (entry.valid && entry.size_bits == size_bits && entry.vpn == vpn) {
+        entry.lru = ++lru_tick_;
+        return &entry;
+      }
+    }
+  }
+  return nullptr;
+}
+
+bool TLB::insert(uint64_t vAddr, uint64_t pfn, uint32_t flags, uint8_t size_bits) {
+  if (!this->enabled())
+    return false;
+  uint64_t vpn = vAddr >> size_bits;
+  auto set = &entries_.at((vpn % num_sets_) * num_ways_);
+  // refresh a matching entry, else fill a free way, else replace the LRU way
+  entry_t* victim = nullptr;
+  for (uint32_t w = 0; w < num_ways_; ++w) {
+    auto& entry = set[w];
+    if (entry.valid && entry.size_bits == size_bits && entry.vpn == vpn) {
+      victim = &entry;
+      break;
+    }
+    if (victim == nullptr
+     || (victim->valid && (!entry.valid || entry.lru < victim->lru))) {
+      victim = &entry;
+    }
+  }
+  bool evicted = victim->valid && !(victim->size_bits == size_bits && victim->vpn == vpn);
+  victim->vpn = vpn;
+  victim->pfn = pfn;
+  victim->lru = ++lru_tick_;
+  victim->flags = flags;
+  victim->size_bits = size_bits;
+  victim->valid = true;
+  size_mask_ |= (1u << size_bits);
+  return evicted;
+}
+
+void TLB::invalidate(uint64_t vAddr) {
+  while (auto entry = this->lookup(vAddr)) {
+    entry->valid = false;
+  }
+}
+
+void TLB::flush() {
+  for (auto& entry : entries_) {
+    entry.valid = false;
+  }
+  size_mask_ = 0;
+  lru_tick_ = 0;
+}
+
+PageWalkCache::PageWalkCache(uint32_t num_entries)
+  : entries_(num_entries) {
+  this->flush();
+}
+
+int PageWalkCache::lookup(uint64_t vAddr, uint64_t* base_ppn) {
+  entry_t* match = nullptr;
+  for (auto& entry : entries_) {
+    if (!entry.valid)
+      continue;
+    if (match != nullptr && entry.level >= match->level)
+      continue;
+    if (entry.tag == (vAddr >> vAddr_t::page_bits(entry.level + 1))) {
+      match = &entry;
+    }
+  }
+  if (match == nullptr)
+    return -1;
+  match->lru = ++lru_tick_;
+  *base_ppn = match->base_ppn;
+  return match->level;
+}
+
+void PageWalkCache::insert(uint64_t vAddr, uint32_t level, uint64_t base_ppn) {
+  if (entries_.empty())
+    return;
+  uint64_t tag = vAddr >> vAddr_t::page_bits(level + 1);
+  entry_t* victim = nullptr;
+  for (auto& entry : entries_) {
+    if (entry.valid && entry.level == level && entry.tag == tag) {
+      victim = &entry;
+      break;
+    }
+    if (victim == nullptr
+     || (victim->valid && (!entry.valid || entry.lru < victim->lru))) {
+      victim = &entry;
+    }
+  }
+  victim->tag = tag;
+  victim->base_ppn = base_ppn;
+  victim->lru = ++lru_tick_;
+  victim->level = level;
+  victim->valid = true;
+}
+
+void PageWalkCache::flush() {
+  for (auto& entry : entries_) {
+    entry.valid = false;
+  }
+  lru_tick_ = 0;
+}
+#endif
+
 
 RamMemDevice::RamMemDevice(const char *filename, uint32_t wordSize)
   : wordSize_(wordSize) {
@@ -133,8 +318,13 @@ void MemoryUnit::ADecoder::write(const void* data, uint64_t addr, uint64_t size)
 ///////////////////////////////////////////////////////////////////////////////
 
 MemoryUnit::MemoryUnit(uint64_t pageSize)
+#ifdef VM_ENABLE
+  : l1_tlb_(tlb_config().l1_entries, tlb_config().l1_ways)
+  , l2_tlb_(tlb_config().l2_entries, tlb_config().l2_ways)
+  , pwc_(tlb_config().pwc_entries)
+  , pageSize_(pageSize)
+#else
   : pageSize_(pageSize)
-#ifndef VM_ENABLE
   , enableVM_(pageSize != 0)
 #endif
   , amo_reservation_({0x0, false})
@@ -142,7 +332,13 @@ MemoryUnit::MemoryUnit(uint64_t pageSize)
   , TLB_HIT(0)
   , TLB_MISS(0)
   , TLB_EVICT(0)
+  , TLB_L2_HIT(0)
   , PTW(0)
+  , PERF_UNIQUE_PTW(0)
+  , PWC_HIT(0)
+  , PTE_READS(0)
+  , TLB_CYCLES(0)
+  , pending_latency_(0)
   , satp_(NULL) {};
 #else
   {
@@ -159,67 +355,14 @@ void MemoryUnit::attach(MemDevice &m, uint64_t start, uint64_t end) {
 
 
 #ifdef VM_ENABLE
-std::pair<bool, uint64_t> MemoryUnit::tlbLookup(uint64_t vAddr, ACCESS_TYPE type, uint64_t* size_bits) {
-
-  //Find entry while accounting for different sizes.
-  for (auto entry : tlb_)
-  {
-    if(entry.first == vAddr >> entry.second.size_bits)
-    {
-        *size_bits = entry.second.size_bits;
-        vAddr = vAddr >> (*size_bits);
-    }
-  }
-
-
-  auto iter = tlb_.find(vAddr);
-  if (iter != tlb_.end()) {
-    TLBEntry e = iter->second;
-
-    //Set mru bit if it is a hit.
-    iter->second.mru_bit = true;
-
-    //If at full capacity and no other unset bits.
-    // Clear all bits except the one we just looked up.
-    if (tlb_.size() == TLB_SIZE)
-    {
-      // bool no_cleared = true;
-      // for (auto& entry : tlb_)
-      // {
-      //   no_cleared = no_cleared & entry.second.mru_bit;
-      // }
-
-      // if(no_cleared)
-      // {
-        for (auto& entry : tlb_)
-        {
-          entry.second.mru_bit = false;
-        }
-        iter->second.mru_bit = true;
-      //}
-
-    }
-    //Check access permissions.
-    if ( (type == ACCESS_TYPE::FETCH) & ((e.r == 0) | (e.x == 0)) )
-    {
-      throw Page_Fault_Exception("Page Fault : Incorrect permissions.");
-    }
-    else if ( (type == ACCESS_TYPE::LOAD) & (e.r == 0) )
-    {
-      throw Page_Fault_Exception("Page Fault : Incorrect permissions.");
-    }
-    else if ( (type == ACCESS_TYPE::STORE) & (e.w == 0) )
-    {
-      throw Page_Fault_Exception("Page Fault : Incorrect permissions.");
-    }
-    else
-    {
-      //TLB Hit
-      return std::make_pair(true, iter->second.pfn);
-    }
-  } else {
-    //TLB Miss
-    return std::make_pair(false, 0);
+void MemoryUnit::check_access(uint32_t flags, ACCESS_TYPE type) {
+  bool r = flags & 0x2;
+  bool w = flags & 0x4;
+  bool x = flags & 0x8;
+  if (((type == ACCESS_TYPE::FETCH) && (!r || !x))
+   || ((type == ACCESS_TYPE::LOAD) && !r)
+   || ((type == ACCESS_TYPE::STORE) && !w)) {
+    throw Page_Fault_Exception("Page Fault : Incorrect permissions.");
   }
 }
 #else
@@ -308,42 +451,39 @@ bool MemoryUnit::amo_check(uint64_t addr) {
 
 #ifdef VM_ENABLE
 
-void MemoryUnit::tlbAdd(uint64_t virt, uint64_t phys, uint32_t flags, uint64_t size_bits) {
-  // HW: evict TLB by Most Recently Used
-  if (tlb_.size() == TLB_SIZE - 1) {
-    for (auto& entry : tlb_)
-    {
-      entry.second.mru_bit = false;
-    }
-
-  } else if (tlb_.size() == TLB_SIZE) {
-    uint64_t del;
-    for (auto entry : tlb_) {
-      if (!entry.second.mru_bit)
-      {
-        del = entry.first;
-        break;
-      }
-    }
-    tlb_.erase(tlb_.find(del));
-    TLB_EVICT++;
-  }
-  tlb_[virt / pageSize_] = TLBEntry(phys / pageSize_, flags, size_bits);
+void MemoryUnit::tlbRm(uint64_t va) {
+  l1_tlb_.invalidate(va);
+  l2_tlb_.invalidate(va);
+  pwc_.flush();
 }
-#else
 
-void MemoryUnit::tlbAdd(uint64_t virt, uint64_t phys, uint32_t flags) {
-  tlb_[virt / pageSize_] = TLBEntry(phys / pageSize_, flags);
+void MemoryUnit::tlbFlush() {
+  l1_tlb_.flush();
+  l2_tlb_.flush();
+  pwc_.flush();
 }
-#endif
+#else
 
 void MemoryUnit::tlbRm(uint64_t va) {
   if (tlb_.find(va / pageSize_) != tlb_.end())
     tlb_.erase(tlb_.find(va / pageSize_));
 }
 
+void MemoryUnit::tlbFlush() {
+  tlb_.clear();
+}
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 
+// granularity of the ACL page summary
+static constexpr uint32_t ACL_PAGE_BITS = 12;
+
+ACLManager::ACLManager()
+  : last_page_index_(-1)
+  , last_page_flags_(0)
+{}
+
 void ACLManager::set(uint64_t addr, uint64_t size, int flags) {
   if (size == 0)
     return;
@@ -393,9 +533,74 @@ void ACLManager::set(uint64_t addr, uint64_t size, int flags) {
       acl_map_.erase(next);
     }
   }
+
+  // refresh the page summary: only the boundary pages can be partially covered
+  uint64_t first_page = addr >> ACL_PAGE_BITS;
+  uint64_t last_page = (end - 1) >> ACL_PAGE_BITS;
+  this->update_page(first_page);
+  if (last_page != first_page) {
+    this->update_page(last_page);
+  }
+  for (uint64_t page = first_page + 1; page < last_page; ++page) {
+    if (flags != 0) {
+      page_flags_[page] = flags;
+    } else {
+      page_flags_.erase(page);
+    }
+  }
+  last_page_index_ = -1;
+}
+
+void ACLManager::update_page(uint64_t page_index) {
+  uint64_t page_start = page_index << ACL_PAGE_BITS;
+  uint64_t page_end = page_start + (1ull << ACL_PAGE_BITS);
+
+  // first entry overlapping the page
+  auto it = acl_map_.upper_bound(page_start);
+  if (it != acl_map_.begin()) {
+    auto prev = std::prev(it);
+    if (prev->second.end > page_start) {
+      it = prev;
+    }
+  }
+
+  if (it == acl_map_.end() || it->first >= page_end) {
+    page_flags_.erase(page_index);
+  } else if (it->first <= page_start && it->second.end >= page_end) {
+    page_flags_[page_index] = it->second.flags;
+  } else {
+    page_flags_[page_index] = MIXED_FLAGS;
+  }
+}
+
+int32_t ACLManager::page_flags(uint64_t page_index) const {
+  if (page_index != last_page_index_) {
+    auto it = page_flags_.find(page_index);
+    last_page_flags_ = (it != page_flags_.end()) ? it->second : 0;
+    last_page_index_ = page_index;
+  }
+  return last_page_flags_;
 }
 
 bool ACLManager::check(uint64_t addr, uint64_t size, int flags) const {
+  if (size == 0)
+    return this->check_range(addr, size, flags);
+
+  // fast path: every page touched has uniform permissions
+  uint64_t first_page = addr >> ACL_PAGE_BITS;
+  uint64_t last_page = (addr + size - 1) >> ACL_PAGE_BITS;
+  for (uint64_t page = first_page; page <= last_page; ++page) {
+    auto page_flags = this->page_flags(page);
+    if (page_flags == 0)
+      continue; // not covered by any range
+    if (page_flags == MIXED_FLAGS || (page_flags & flags) != flags)
+      return this->check_range(addr, size, flags);
+  }
+
+  return true;
+}
+
+bool ACLManager::check_range(uint64_t addr, uint64_t size, int flags) const {
   uint64_t end = addr + size;
 
   auto it = acl_map_.lower_bound(addr);
@@ -439,14 +644,29 @@ RAM::~RAM() {
 
 void RAM::clear() {
   for (auto& page : pages_) {
-    delete[] page.second;
+    if (this->find_region(page.first) == regions_.end()) {
+      delete[] page.second;
+    }
   }
+  for (auto& region : regions_) {
+    delete[] region.second.data;
+  }
+  pages_.clear();
+  regions_.clear();
+  last_page_ = nullptr;
 }
 
 uint64_t RAM::size() const {
   return uint64_t(pages_.size()) << page_bits_;
 }
 
+static void fill_uninitialized(uint8_t* data, uint64_t size) {
+  // set uninitialized data to "baadf00d"
+  for (uint64_t i = 0; i < size; ++i) {
+    data[i] = (0xbaadf00d >> ((i & 0x3) * 8)) & 0xff;
+  }
+}
+
 uint8_t *RAM::get(uint64_t address) const {
   if (capacity_ != 0 && address >= capacity_) {
     throw OutOfRange();
@@ -464,10 +684,7 @@ uint8_t *RAM::get(uint64_t address) const {
       page = it->second;
     } else {
       uint8_t *ptr = new uint8_t[page_size];
-      // set uninitialized data to "baadf00d"
-      for (uint32_t i = 0; i < page_size; ++i) {
-        ptr[i] = (0xbaadf00d >> ((i & 0x3) * 8)) & 0xff;
-      }
+      fill_uninitialized(ptr, page_size);
       pages_.emplace(page_index, ptr);
       page = ptr;
     }
@@ -483,9 +700,15 @@ void RAM::read(void* data, uint64_t addr, uint64_t size) {
   if (check_acl_ && acl_mngr_.check(addr, size, 0x1) == false) {
     throw BadAddress();
   }
-  uint8_t* d = (uint8_t*)data;
-  for (uint64_t i = 0; i < size; i++) {
-    d[i] = *this->get(addr + i);
+  // copy page by page
+  uint64_t page_size = 1ull << page_bits_;
+  auto d = (uint8_t*)data;
+  while (size != 0) {
+    uint64_t chunk = std::min(size, page_size - (addr & (page_size - 1)));
+    memcpy(d, this->get(addr), chunk);
+    d += chunk;
+    addr += chunk;
+    size -= chunk;
   }
 }
 
@@ -493,9 +716,141 @@ void RAM::write(const void* data, uint64_t addr, uint64_t size) {
   if (check_acl_ && acl_mngr_.check(addr, size, 0x2) == false) {
     throw BadAddress();
   }
-  const uint8_t* d = (const uint8_t*)data;
-  for (uint64_t i = 0; i < size; i++) {
-    *this->get(addr + i) = d[i];
+  // copy page by page
+  uint64_t page_size = 1ull << page_bits_;
+  auto d = (const uint8_t*)data;
+  while (size != 0) {
+    uint64_t chunk = std::min(size, page_size - (addr & (page_size - 1)));
+    memcpy(this->get(addr), d, chunk);
+    d += chunk;
+    addr += chunk;
+    size -= chunk;
+  }
+}
+
+void RAM::copy(uint64_t dst_addr, uint64_t src_addr, uint64_t size) {
+  if (check_acl_ && (acl_mngr_.check(src_addr, size, 0x1) == false
+                  || acl_mngr_.check(dst_addr, size, 0x2) == false)) {
+    throw BadAddress();
+  }
+  // copy page by page, backward if the destination overlaps the source tail
+  uint64_t page_mask = (1ull << page_bits_) - 1;
+  if (dst_addr > src_addr && dst_addr < src_addr + size) {
+    uint64_t src_end = src_addr + size;
+    uint64_t dst_end = dst_addr + size;
+    while (size != 0) {
+      uint64_t chunk = std::min({size, ((src_end - 1) & page_mask) + 1, ((dst_end - 1) & page_mask) + 1});
+      src_end -= chunk;
+      dst_end -= chunk;
+      auto src = this->get(src_end);
+      memmove(this->get(dst_end), src, chunk);
+      size -= chunk;
+    }
+  } else {
+    while (size != 0) {
+      uint64_t chunk = std::min({size, page_mask + 1 - (src_addr & page_mask), page_mask + 1 - (dst_addr & page_mask)});
+      auto src = this->get(src_addr);
+      memmove(this->get(dst_addr), src, chunk);
+      src_addr += chunk;
+      dst_addr += chunk;
+      size -= chunk;
+    }
+  }
+}
+
+void RAM::fill(uint64_t addr, uint64_t size, const void* pattern, uint32_t pattern_size) {
+  if (check_acl_ && acl_mngr_.check(addr, size, 0x2) == false) {
+    throw BadAddress();
+  }
+  uint64_t page_size = 1ull << page_bits_;
+  // replicate the pattern over a page plus one period, so that any chunk
+  // can be copied from the offset matching its phase
+  auto p = (const uint8_t*)pattern;
+  std::vector<uint8_t> line(page_size + pattern_size);
+  for (uint64_t i = 0; i < line.size(); ++i) {
+    line[i] = p[i % pattern_size];
+  }
+  uint64_t offset = 0;
+  while (offset < size) {
+    uint64_t chunk = std::min(size - offset, page_size - ((addr + offset) & (page_size - 1)));
+    memcpy(this->get(addr + offset), line.data() + (offset % pattern_size), chunk);
+    offset += chunk;
+  }
+}
+
+std::map<uint64_t, RAM::region_t>::iterator RAM::find_region(uint64_t page_index) {
+  auto it = regions_.upper_bound(page_index);
+  if (it == regions_.begin())
+    return regions_.end();
+  --it;
+  if (page_index >= it->first + it->second.num_pages)
+    return regions_.end();
+  return it;
+}
+
+uint8_t* RAM::map(uint64_t addr, uint64_t size) {
+  if (size == 0)
+    return nullptr;
+  if (capacity_ != 0 && (addr + size) > capacity_) {
+    throw OutOfRange();
+  }
+  uint64_t page_size = 1ull << page_bits_;
+  uint64_t first = addr >> page_bits_;
+  uint64_t last  = (addr + size - 1) >> page_bits_;
+
+  // already contiguous
+  auto it = this->find_region(first);
+  if (it != regions_.end() && last < it->first + it->second.num_pages) {
+    ++it->second.maps;
+    return it->second.data + (addr - (it->first << page_bits_));
+  }
+
+  // merge overlapping regions, which must not be mapped since they move
+  std::vector<std::map<uint64_t, region_t>::iterator> merged;
+  it = this->find_region(first);
+  if (it == regions_.end()) {
+    it = regions_.lower_bound(first);
+  }
+  for (; it != regions_.end() && it->first <= last; ++it) {
+    if (it->second.maps != 0)
+      return nullptr;
+    first = std::min(first, it->first);
+    last = std::max(last, it->first + it->second.num_pages - 1);
+    merged.push_back(it);
+  }
+
+  uint64_t num_pages = last - first + 1;
+  auto data = new uint8_t[num_pages * page_size];
+  for (uint64_t i = 0; i < num_pages; ++i) {
+    auto dst = data + i * page_size;
+    auto page = pages_.find(first + i);
+    if (page == pages_.end()) {
+      fill_uninitialized(dst, page_size);
+    } else {
+      memcpy(dst, page->second, page_size);
+      if (this->find_region(first + i) == regions_.end()) {
+        delete[] page->second;
+      }
+    }
+  }
+  for (auto& region : merged) {
+    delete[] region->second.data;
+    regions_.erase(region);
+  }
+  for (uint64_t i = 0; i < num_pages; ++i) {
+    pages_[first + i] = data + i * page_size;
+  }
+  regions_[first] = {data, num_pages, 1};
+  last_page_ = nullptr;
+
+  return data + (addr - (first << page_bits_));
+}
+
+void RAM::unmap(uint64_t addr) {
+  // the range remains contiguous
+  auto it = this->find_region(addr >> page_bits_);
+  if (it != regions_.end() && it->second.maps != 0) {
+    --it->second.maps;
   }
 }
 
@@ -620,7 +975,33 @@ uint8_t MemoryUnit::get_mode()
 void MemoryUnit::set_satp(uint64_t satp)
 {
   // uint16_t asid = 0; // set asid for different process
+  if (satp_ != NULL)
+    delete satp_;
   satp_ = new SATP_t (satp );
+  // entries are not ASID-tagged, drop the previous address space
+  this->tlbFlush();
+}
+
+MemoryUnit::PerfStats MemoryUnit::perf_stats() const
+{
+  PerfStats perf;
+  perf.tlb_hits    = TLB_HIT;
+  perf.tlb_misses  = TLB_MISS;
+  perf.tlb_evicts  = TLB_EVICT;
+  perf.tlb_l2_hits = TLB_L2_HIT;
+  perf.ptws        = PTW;
+  perf.ptws_unique = PERF_UNIQUE_PTW;
+  perf.pwc_hits    = PWC_HIT;
+  perf.pte_reads   = PTE_READS;
+  perf.tlb_cycles  = TLB_CYCLES;
+  return perf;
+}
+
+uint32_t MemoryUnit::take_latency()
+{
+  auto latency = pending_latency_;
+  pending_latency_ = 0;
+  return latency;
 }
 
 bool MemoryUnit::need_trans(uint64_t dev_pAddr)
@@ -656,27 +1037,54 @@ uint64_t MemoryUnit::vAddr_to_pAddr(uint64_t vAddr, ACCESS_TYPE type)
         return vAddr;
     }
 
-    //First lookup TLB.
-    std::pair<bool, uint64_t> tlb_access = tlbLookup(vAddr, type,  &size_bits);
-    if (tlb_access.first)
+    //First lookup the L1 TLB, then the L2 TLB.
+    auto entry = l1_tlb_.lookup(vAddr);
+    if (entry)
     {
-
-        pfn = tlb_access.second;
+        check_access(entry->flags, type);
+        pfn = entry->pfn;
+        size_bits = entry->size_bits;
         TLB_HIT++;
     }
-    else //Else walk the PT.
+    else
     {
-        std::pair<uint64_t, uint8_t> ptw_access = page_table_walk(vAddr, type, &size_bits);
-        tlbAdd(vAddr>>size_bits, ptw_access.first, ptw_access.second,size_bits);
-        pfn = ptw_access.first; TLB_MISS++; PTW++;
-        unique_translations.insert(vAddr>>size_bits);
-        PERF_UNIQUE_PTW = unique_translations.size();
-
+        uint32_t flags;
+        TLB_MISS++;
+        entry = l2_tlb_.lookup(vAddr);
+        if (entry)
+        {
+            check_access(entry->flags, type);
+            pfn = entry->pfn;
+            flags = entry->flags;
+            size_bits = entry->size_bits;
+            TLB_L2_HIT++;
+            pending_latency_ += tlb_config().l2_latency;
+            TLB_CYCLES += tlb_config().l2_latency;
+        }
+        else //Else walk the PT.
+        {
+            auto pte_reads = PTE_READS;
+            std::pair<uint64_t, uint8_t> ptw_access = page_table_walk(vAddr, type, &size_bits);
+            // the walk starts after the L2 lookup missed
+            uint32_t latency = (l2_tlb_.enabled() ? tlb_config().l2_latency : 0)
+                             + (PTE_READS - pte_reads) * tlb_config().pte_latency;
+            pending_latency_ += latency;
+            TLB_CYCLES += latency;
+            pfn = ptw_access.first;
+            flags = ptw_access.second;
+            PTW++;
+            unique_translations.insert(vAddr>>size_bits);
+            PERF_UNIQUE_PTW = unique_translations.size();
+            l2_tlb_.insert(vAddr, pfn, flags, size_bits);
+        }
+        if (l1_tlb_.insert(vAddr, pfn, flags, size_bits))
+            TLB_EVICT++;
     }
 
     //Construct final address using pfn and offset.
-    DBGPRINT("  [MMU: V2P] translated vAddr: 0x%lx to pAddr 0x%lx\n",vAddr,((pfn << size_bits) + (vAddr & ((1 << size_bits) - 1))));
-    return (pfn << size_bits) + (vAddr & ((1 << size_bits) - 1));
+    uint64_t pAddr = (pfn << size_bits) + (vAddr & ((uint64_t(1) << size_bits) - 1));
+    DBGPRINT("  [MMU: V2P] translated vAddr: 0x%lx to pAddr 0x%lx\n",vAddr,pAddr);
+    return pAddr;
 }
 
 uint64_t MemoryUnit::get_pte_address(uint64_t base_ppn, uint64_t vpn)
@@ -693,14 +1101,23 @@ std::pair<uint64_t, uint8_t> MemoryUnit::page_table_walk(uint64_t vAddr_bits, AC
   uint32_t flags =0;
   uint64_t pte_addr = 0, pte_bytes = 0;
   uint64_t cur_base_ppn = get_base_ppn();
-  // Need to fix for super page
-  *size_bits = 12;
+
+  // Resume from the deepest table held in the page-walk cache.
+  uint64_t pwc_base_ppn;
+  int pwc_level = pwc_.lookup(vAddr_bits, &pwc_base_ppn);
+  if (pwc_level >= 0)
+  {
+    i = pwc_level;
+    cur_base_ppn = pwc_base_ppn;
+    PWC_HIT++;
+  }
 
   while (true)
   {
     // Read PTE.
     pte_addr = get_pte_address(cur_base_ppn, vaddr.vpn[i]);
     decoder_.read(&pte_bytes, pte_addr, PTE_SIZE);
+    PTE_READS++;
     PTE_t pte(pte_bytes);
     DBGPRINT("  [MMU:PTW] Level[%u] pte_addr=0x%lx, pte_bytes =0x%lx, pte.ppn= 0x%lx, pte.flags = %u)\n", i, pte_addr, pte_bytes, pte.ppn, pte.flags);
 
@@ -726,6 +1143,7 @@ std::pair<uint64_t, uint8_t> MemoryUnit::page_table_walk(uint64_t vAddr_bits, AC
       {
         // Continue on to next level.
         cur_base_ppn= pte.ppn;
+        pwc_.insert(vAddr_bits, i, cur_base_ppn);
         DBGPRINT("  [MMU:PTW] next base_ppn: 0x%lx\n", cur_base_ppn);
         continue;
       }
@@ -749,7 +1167,15 @@ std::pair<uint64_t, uint8_t> MemoryUnit::page_table_walk(uint64_t vAddr_bits, AC
         assert(0);
         throw Page_Fault_Exception("  [MMU:PTW] Page Fault : TYPE STORE, Incorrect permissions.");
       }
-      cur_base_ppn = pte.ppn;
+      // Leaves above level 0 map superpages, which must be aligned to their size.
+      uint32_t ppn_bits = i * vAddr_t::VPN_BITS;
+      if (pte.ppn & ((uint64_t(1) << ppn_bits) - 1))
+      {
+        assert(0);
+        throw Page_Fault_Exception("  [MMU:PTW] Page Fault : Misaligned superpage.");
+      }
+      *size_bits = vAddr_t::page_bits(i);
+      cur_base_ppn = pte.ppn >> ppn_bits;
       flags = pte.flags;
       break;
     }
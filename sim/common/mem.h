@@ -119,6 +119,73 @@ public:
     uint64_t addr;
     ACCESS_TYPE type;
 };
+
+// Set-associative TLB with LRU replacement.
+// Entries of all page sizes share one array; each entry is placed in the set
+// selected by its own virtual page number, so a lookup probes one set per
+// page size currently cached.
+class TLB {
+public:
+  struct entry_t {
+    uint64_t vpn;       // virtual page number at the entry's page size
+    uint64_t pfn;       // physical frame number at the entry's page size
+    uint64_t lru;
+    uint32_t flags;
+    uint8_t  size_bits;
+    bool     valid;
+  };
+
+  TLB(uint32_t num_entries, uint32_t num_ways);
+
+  bool enabled() const {
+    return !entries_.empty();
+  }
+
+  // returns the entry mapping vAddr, or nullptr on a miss
+  entry_t* lookup(uint64_t vAddr);
+
+  // returns true if a valid entry was evicted
+  bool insert(uint64_t vAddr, uint64_t pfn, uint32_t flags, uint8_t size_bits);
+
+  void invalidate(uint64_t vAddr);
+
+  void flush();
+
+private:
+  std::vector<entry_t> entries_;
+  uint32_t num_sets_;
+  uint32_t num_ways_;
+  uint32_t size_mask_; // bit n set when pages of 2^n bytes may be cached
+  uint64_t lru_tick_;
+};
+
+// Page-walk cache: fully-associative LRU cache of non-leaf PTEs.
+// An entry maps the virtual address bits above a page-table level to the
+// base PPN of the table at that level, letting walks skip upper levels.
+class PageWalkCache {
+public:
+  PageWalkCache(uint32_t num_entries);
+
+  // returns the deepest cached table level for vAddr and its base PPN,
+  // or -1 if no upper level is cached
+  int lookup(uint64_t vAddr, uint64_t* base_ppn);
+
+  void insert(uint64_t vAddr, uint32_t level, uint64_t base_ppn);
+
+  void flush();
+
+private:
+  struct entry_t {
+    uint64_t tag;
+    uint64_t base_ppn;
+    uint64_t lru;
+    uint32_t level;
+    bool     valid;
+  };
+
+  std::vector<entry_t> entries_;
+  uint64_t lru_tick_;
+};
 #endif
 
 class BadAddress : public std::runtime_error {
@@ -194,11 +261,28 @@ public:
   };
 
 #ifdef VM_ENABLE
+  struct PerfStats {
+    uint64_t tlb_hits;    // L1 TLB hits
+    uint64_t tlb_misses;  // L1 TLB misses
+    uint64_t tlb_evicts;  // L1 TLB evictions
+    uint64_t tlb_l2_hits;
+    uint64_t ptws;        // page-table walks
+    uint64_t ptws_unique; // distinct pages walked
+    uint64_t pwc_hits;    // walks that skipped upper levels
+    uint64_t pte_reads;
+    uint64_t tlb_cycles;  // translation latency of the L1 misses
+  };
+
   MemoryUnit(uint64_t pageSize = MEM_PAGE_SIZE);
   ~MemoryUnit(){
     if ( this->satp_ != NULL)
       delete this->satp_;
   };
+
+  PerfStats perf_stats() const;
+
+  // translation latency accumulated since the last call
+  uint32_t take_latency();
 #else
   MemoryUnit(uint64_t pageSize = 0);
 #endif
@@ -218,20 +302,15 @@ public:
   bool amo_check(uint64_t addr);
 
 #ifdef VM_ENABLE
-  void tlbAdd(uint64_t virt, uint64_t phys, uint32_t flags, uint64_t size_bits);
   uint8_t is_satp_unset();
   uint64_t get_satp();
   uint8_t get_mode();
   uint64_t get_base_ppn();
   void set_satp(uint64_t satp);
-#else
-  void tlbAdd(uint64_t virt, uint64_t phys, uint32_t flags);
 #endif
 
   void tlbRm(uint64_t vaddr);
-  void tlbFlush() {
-    tlb_.clear();
-  }
+  void tlbFlush();
 
 private:
 
@@ -267,46 +346,20 @@ private:
     std::vector<entry_t> entries_;
   };
 
+#ifndef VM_ENABLE
   struct TLBEntry {
     TLBEntry() {}
-  #ifdef VM_ENABLE
-    TLBEntry(uint32_t pfn, uint32_t flags, uint64_t size_bits)
-      : pfn(pfn)
-      , flags(flags)
-      , mru_bit(true)
-      , size_bits (size_bits)
-    {
-      d = bit(7);
-      a = bit(6);
-      g = bit(5);
-      u = bit(4);
-      x = bit(3);
-      w = bit(2);
-      r = bit(1);
-      v = bit(0);
-    }
-    bool bit(uint8_t idx)
-    {
-        return (flags) & (1 << idx);
-    }
-
-    uint32_t pfn;
-    uint32_t flags;
-    bool mru_bit;
-    uint64_t size_bits;
-    bool d, a, g, u, x, w, r, v;
-  #else
     TLBEntry(uint32_t pfn, uint32_t flags)
       : pfn(pfn)
       , flags(flags)
     {}
     uint32_t pfn;
     uint32_t flags;
-  #endif
   };
+#endif
 
 #ifdef VM_ENABLE
-  std::pair<bool, uint64_t> tlbLookup(uint64_t vAddr, ACCESS_TYPE type, uint64_t* size_bits);
+  void check_access(uint32_t flags, ACCESS_TYPE type);
 
   bool need_trans(uint64_t dev_pAddr);
   uint64_t vAddr_to_pAddr(uint64_t vAddr, ACCESS_TYPE type);
@@ -320,7 +373,13 @@ private:
 
 
 
+#ifdef VM_ENABLE
+  TLB       l1_tlb_;
+  TLB       l2_tlb_;
+  PageWalkCache pwc_;
+#else
   std::unordered_map<uint64_t, TLBEntry> tlb_;
+#endif
   uint64_t  pageSize_;
   ADecoder  decoder_;
 #ifndef VM_ENABLE
@@ -330,7 +389,8 @@ private:
   amo_reservation_t amo_reservation_;
 #ifdef VM_ENABLE
   std::unordered_set<uint64_t> unique_translations;
-  uint64_t TLB_HIT, TLB_MISS, TLB_EVICT, PTW, PERF_UNIQUE_PTW;
+  uint64_t TLB_HIT, TLB_MISS, TLB_EVICT, TLB_L2_HIT, PTW, PERF_UNIQUE_PTW, PWC_HIT, PTE_READS, TLB_CYCLES;
+  uint32_t pending_latency_;
   SATP_t *satp_;
 #endif
 
@@ -341,18 +401,34 @@ private:
 class ACLManager {
 public:
 
+    ACLManager();
+
     void set(uint64_t addr, uint64_t size, int flags);
 
     bool check(uint64_t addr, uint64_t size, int flags) const;
 
 private:
 
+  // summary flags of a page whose permissions are not uniform
+  static constexpr int32_t MIXED_FLAGS = -1;
+
   struct acl_entry_t {
     uint64_t end;
     int32_t flags;
   };
 
+  bool check_range(uint64_t addr, uint64_t size, int flags) const;
+
+  int32_t page_flags(uint64_t page_index) const;
+
+  void update_page(uint64_t page_index);
+
   std::map<uint64_t, acl_entry_t> acl_map_;
+
+  // per-page permission summary, pages without an entry are not covered by any range
+  std::unordered_map<uint64_t, int32_t> page_flags_;
+  mutable uint64_t last_page_index_;
+  mutable int32_t last_page_flags_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -371,6 +447,12 @@ public:
   void read(void* data, uint64_t addr, uint64_t size) override;
   void write(const void* data, uint64_t addr, uint64_t size) override;
 
+  // copy within memory, ranges may overlap
+  void copy(uint64_t dst_addr, uint64_t src_addr, uint64_t size);
+
+  // fill a range with a repeating pattern
+  void fill(uint64_t addr, uint64_t size, const void* pattern, uint32_t pattern_size);
+
   void loadBinImage(const char* filename, uint64_t destination);
   void loadHexImage(const char* filename);
 
@@ -388,13 +470,29 @@ public:
     check_acl_ = enable;
   }
 
+  // back a range with contiguous host memory and return its address,
+  // returns nullptr if the range overlaps another mapped range it cannot extend
+  uint8_t* map(uint64_t addr, uint64_t size);
+
+  void unmap(uint64_t addr);
+
 private:
 
+  // contiguous run of pages
+  struct region_t {
+    uint8_t* data;
+    uint64_t num_pages;
+    uint32_t maps;
+  };
+
   uint8_t *get(uint64_t address) const;
 
+  std::map<uint64_t, region_t>::iterator find_region(uint64_t page_index);
+
   uint64_t capacity_;
   uint32_t page_bits_;
   mutable std::unordered_map<uint64_t, uint8_t*> pages_;
+  std::map<uint64_t, region_t> regions_; // key: first page index
   mutable uint8_t* last_page_;
   mutable uint64_t last_page_index_;
   ACLManager acl_mngr_;
@@ -448,11 +546,6 @@ class PTE_t
       PBMT = 0;
       level = 3;
       ppn = address >> MEM_PAGE_LOG2_SIZE;
-      // Reserve for Super page support
-      // ppn = new uint32_t [level];
-      // ppn[2]=bits(address,28,53);
-      // ppn[1]=bits(address,19,27);
-      // ppn[0]=bits(address,10,18);
       set_flags(flags);
       // pte_bytes = (N  << 63) | (PBMT  << 61) | (ppn <<10) | flags ;
       pte_bytes = (ppn <<10) | flags ;
@@ -460,10 +553,6 @@ class PTE_t
       assert((address>> 32) == 0 && "Upper 32 bits are not zero!");
       level = 2;
       ppn = address >> MEM_PAGE_LOG2_SIZE;
-      // Reserve for Super page support
-      // ppn = new uint32_t[level];
-      // ppn[1]=bits(address,20,31);
-      // ppn[0]=bits(address,10,19);
       set_flags(flags);
       pte_bytes = ppn <<10 | flags ;
 #endif
@@ -477,29 +566,15 @@ class PTE_t
       level = 3;
       ppn=bits(pte_bytes,10,53);
       address = ppn << MEM_PAGE_LOG2_SIZE;
-      // Reserve for Super page support
-      // ppn = new uint32_t [level];
-      // ppn[2]=bits(pte_bytes,28,53);
-      // ppn[1]=bits(pte_bytes,19,27);
-      // ppn[0]=bits(pte_bytes,10,18);
 #else //#if VM_ADDR_MODE == SV32
       assert((pte_bytes >> 32) == 0 && "Upper 32 bits are not zero!");
       level = 2;
       ppn=bits(pte_bytes,10, 31);
       address = ppn << MEM_PAGE_LOG2_SIZE;
-      // Reserve for Super page support
-      // ppn = new uint32_t[level];
-      // ppn[1]=bits(address, 20,31);
-      // ppn[0]=bits(address, 10,19);
 #endif
       rsw = bits(pte_bytes,8,9);
       set_flags((uint32_t)(bits(pte_bytes,0,7)));
     }
-    ~PTE_t()
-    {
-      // Reserve for Super page support
-      // delete ppn;
-    }
 };
 
 class vAddr_t
@@ -511,37 +586,33 @@ class vAddr_t
     {
         return (address>> s_idx) & (((uint64_t)1 << (e_idx - s_idx + 1)) - 1);
     }
-    bool bit( uint8_t idx)
-    {
-        return (address) & ((uint64_t)1 << idx);
-    }
 
   public:
-    uint64_t *vpn;
+#if VM_ADDR_MODE == SV39
+    static constexpr uint32_t VPN_BITS = 9;
+#else
+    static constexpr uint32_t VPN_BITS = 10;
+#endif
+    uint64_t vpn[PT_LEVEL];
     uint64_t pgoff;
     uint8_t level;
     vAddr_t(uint64_t address) : address(address)
     {
-#if VM_ADDR_MODE == SV39
-      level = 3;
-      vpn = new uint64_t [level];
-      vpn[2] = bits(30,38);
-      vpn[1] = bits(21,29);
-      vpn[0] = bits(12,20);
-      pgoff = bits(0,11);
-#else //#if VM_ADDR_MODE == SV32
+#if VM_ADDR_MODE != SV39
       assert((address>> 32) == 0 && "Upper 32 bits are not zero!");
-      level = 2;
-      vpn = new uint64_t [level];
-      vpn[1] = bits(22,31);
-      vpn[0] = bits(12,21);
-      pgoff = bits(0,11);
 #endif
+      level = PT_LEVEL;
+      for (uint32_t i = 0; i < PT_LEVEL; ++i) {
+        uint32_t lsb = MEM_PAGE_LOG2_SIZE + i * VPN_BITS;
+        vpn[i] = bits(lsb, lsb + VPN_BITS - 1);
+      }
+      pgoff = bits(0, MEM_PAGE_LOG2_SIZE - 1);
     }
 
-    ~vAddr_t()
+    // log2 size of a page mapped by a leaf PTE at the given level
+    static uint32_t page_bits(uint32_t level)
     {
-      delete vpn;
+      return MEM_PAGE_LOG2_SIZE + level * VPN_BITS;
     }
 };
 #endif
@@ -14,21 +14,26 @@
 #pragma once
 
 #include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
 #include <cassert>
 
 namespace vortex {
 
-// Memory pool for fixed-size objects with fallback to new/delete
-template<typename T, size_t PoolSize = 64>
+// Memory pool for fixed-size blocks with fallback to new/delete
+template<size_t PoolSize = 64>
 class MemoryPool {
 public:
-  MemoryPool() {
+  MemoryPool(size_t block_size, size_t alignment)
+    : block_size_((std::max(block_size, sizeof(void*)) + alignment - 1) / alignment * alignment)
+    , alignment_(alignment) {
     // Allocate raw memory without constructing objects
-    pool_ = static_cast<char*>(aligned_alloc(alignof(T), sizeof(T) * PoolSize));
+    pool_ = static_cast<char*>(aligned_alloc(alignment_, block_size_ * PoolSize));
     // Initialize free list using pointer arithmetic
     for (size_t i = 0; i < PoolSize; ++i) {
-      *reinterpret_cast<void**>(pool_ + i * sizeof(T)) =
-        (i < PoolSize - 1) ? pool_ + (i + 1) * sizeof(T) : nullptr;
+      *reinterpret_cast<void**>(pool_ + i * block_size_) =
+        (i < PoolSize - 1) ? pool_ + (i + 1) * block_size_ : nullptr;
     }
     free_list_ = pool_;
   }
@@ -37,16 +42,17 @@ public:
     free(pool_);
   }
 
-  T* allocate() {
-    if (free_list_) {
+  // blocks of another size come from new/delete
+  void* allocate(size_t size, size_t alignment) {
+    if (free_list_ && size <= block_size_ && alignment <= alignment_) {
       void* block = free_list_;
       free_list_ = *reinterpret_cast<void**>(block);
-      return static_cast<T*>(block);
+      return block;
     }
-    return static_cast<T*>(::operator new(sizeof(T)));
+    return ::operator new(size);
   }
 
-  void deallocate(T* ptr) noexcept {
+  void deallocate(void* ptr) noexcept {
     if (belongs_to_pool(ptr)) {
       *reinterpret_cast<void**>(ptr) = free_list_;
       free_list_ = ptr;
@@ -58,31 +64,63 @@ public:
 private:
   char* pool_ = nullptr;
   void* free_list_ = nullptr;
+  size_t block_size_;
+  size_t alignment_;
 
-  bool belongs_to_pool(T* ptr) const noexcept {
-    return ptr >= reinterpret_cast<T*>(pool_) &&
-           ptr < reinterpret_cast<T*>(pool_ + sizeof(T) * PoolSize);
+  bool belongs_to_pool(void* ptr) const noexcept {
+    return ptr >= pool_ && ptr < pool_ + block_size_ * PoolSize;
   }
 };
 
-// Custom allocator using the memory pool with fallback
+// Pool shared by an allocator, its copies and rebinds
+template<size_t PoolSize>
+struct PoolAllocatorState {
+  MemoryPool<PoolSize>* pool = nullptr;
+  uint32_t refs = 1;
+};
+
+// Custom allocator using the memory pool with fallback.
+// Each allocator owns its pool, shared with its copies and rebinds, so that
+// independent devices never share a pool. The pool is not thread-safe: an
+// allocator and its copies must be used from the thread of their owner.
 template <typename T, size_t PoolSize = 64>
 class PoolAllocator {
 public:
   using value_type = T;
 
-  PoolAllocator() = default;
+  PoolAllocator() : state_(new PoolAllocatorState<PoolSize>()) {}
+
+  PoolAllocator(const PoolAllocator& other) noexcept : state_(other.state_) {
+    ++state_->refs;
+  }
 
   template <typename U>
-  PoolAllocator(const PoolAllocator<U, PoolSize>&) noexcept {}
+  PoolAllocator(const PoolAllocator<U, PoolSize>& other) noexcept : state_(other.state_) {
+    ++state_->refs;
+  }
+
+  PoolAllocator& operator=(const PoolAllocator& other) noexcept {
+    ++other.state_->refs;
+    this->release();
+    state_ = other.state_;
+    return *this;
+  }
+
+  ~PoolAllocator() {
+    this->release();
+  }
 
   T* allocate(std::size_t n) {
     if (n != 1) throw std::bad_alloc();
-    return get_pool().allocate();
+    // the pool is sized for the first type allocated from it
+    if (state_->pool == nullptr) {
+      state_->pool = new MemoryPool<PoolSize>(sizeof(T), alignof(T));
+    }
+    return static_cast<T*>(state_->pool->allocate(sizeof(T), alignof(T)));
   }
 
   void deallocate(T* p, std::size_t n) noexcept {
-    if (n == 1) get_pool().deallocate(p);
+    if (n == 1) state_->pool->deallocate(p);
   }
 
   template<typename U>
@@ -90,27 +128,36 @@ public:
     using other = PoolAllocator<U, PoolSize>;
   };
 
+  using propagate_on_container_copy_assignment = std::true_type;
   using propagate_on_container_move_assignment = std::true_type;
-  using is_always_equal = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  using is_always_equal = std::false_type;
 
 private:
   template<typename, size_t> friend class PoolAllocator;
 
-  static MemoryPool<T, PoolSize>& get_pool() {
-    static MemoryPool<T, PoolSize> pool;
-    return pool;
+  template<typename T1, typename T2, size_t N>
+  friend bool operator==(const PoolAllocator<T1, N>&, const PoolAllocator<T2, N>&) noexcept;
+
+  void release() noexcept {
+    if (--state_->refs == 0) {
+      delete state_->pool;
+      delete state_;
+    }
   }
+
+  PoolAllocatorState<PoolSize>* state_;
 };
 
 // Comparisons required by STL containers
 template<typename T1, typename T2, size_t N>
-bool operator==(const PoolAllocator<T1, N>&, const PoolAllocator<T2, N>&) noexcept {
-  return true;
+bool operator==(const PoolAllocator<T1, N>& lhs, const PoolAllocator<T2, N>& rhs) noexcept {
+  return lhs.state_ == rhs.state_;
 }
 
 template<typename T1, typename T2, size_t N>
-bool operator!=(const PoolAllocator<T1, N>&, const PoolAllocator<T2, N>&) noexcept {
-  return false;
+bool operator!=(const PoolAllocator<T1, N>& lhs, const PoolAllocator<T2, N>& rhs) noexcept {
+  return !(lhs == rhs);
 }
 
 }
\ No newline at end of file
@@ -18,8 +18,10 @@
 #include <memory>
 #include <vector>
 #include <list>
+#include <algorithm>
 #include <queue>
 #include <assert.h>
+#include <stdlib.h>
 #include "mempool.h"
 #include "util.h"
 #include "linked_list.h"
@@ -27,6 +29,7 @@
 namespace vortex {
 
 class SimObjectBase;
+class SimPlatform;
 
 class SimPortBase {
 public:
@@ -52,22 +55,34 @@ public:
 
   virtual uint32_t capacity() const = 0;
 
+  // also wake <listener> when the port receives data,
+  // for objects that consume ports owned by another object
+  void set_listener(SimObjectBase* listener) {
+    listener_ = listener;
+  }
+
 protected:
   SimPortBase(SimObjectBase* module, uint32_t capacity)
     : module_(module)
     , capacity_(capacity)
     , sink_(nullptr)
     , source_(nullptr)
+    , listener_(nullptr)
   {}
 
   virtual void do_pop() = 0;
 
+  void wake_listeners(bool enqueued);
+
+  SimPlatform& platform() const;
+
   SimPortBase& operator=(const SimPortBase&) = delete;
 
   SimObjectBase* module_;
   uint32_t       capacity_;
   SimPortBase*   sink_;
   SimPortBase*   source_;
+  SimObjectBase* listener_;
 
   LinkedListNode<SimPortBase> pop_list_;
   LinkedListNode<SimPortBase> push_list_;
@@ -187,6 +202,7 @@ protected:
     if (tx_cb_) {
       tx_cb_(pkt, cycles);
     }
+    this->wake_listeners(sink_ == nullptr);
     if (sink_) {
       if (sink_transfer_) {
         sink_transfer_(pkt, cycles);
@@ -223,9 +239,10 @@ public:
   }
 
 protected:
-  SimEventBase(uint64_t cycles) : cycles_(cycles) {}
+  SimEventBase(uint64_t cycles) : cycles_(cycles), alloc_bin_(0) {}
 
   uint64_t cycles_;
+  uint32_t alloc_bin_; // platform free list the event returns to
 
   LinkedListNode<SimEventBase> list_;
 
@@ -249,22 +266,9 @@ public:
     , pkt_(pkt)
   {}
 
-  static void* operator new(std::size_t sz) {
-    __unused (sz);
-    assert(sizeof(SimCallEvent<Pkt>) == sz);
-    return allocator_.allocate(1);
-  }
-
-  static void operator delete(void* ptr, std::size_t sz) noexcept {
-    __unused (sz);
-    assert(sizeof(SimCallEvent<Pkt>) == sz);
-    allocator_.deallocate(static_cast<SimCallEvent<Pkt>*>(ptr), 1);
-  }
-
 protected:
   Func func_;
   Pkt  pkt_;
-  static inline PoolAllocator<SimCallEvent<Pkt>, 64> allocator_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -282,31 +286,34 @@ public:
     , pkt_(pkt)
   {}
 
-  static void* operator new(std::size_t sz) {
-    __unused (sz);
-    assert(sizeof(SimPortEvent<Pkt>) == sz);
-    return allocator_.allocate(1);
-  }
-
-  static void operator delete(void* ptr, std::size_t sz) noexcept {
-    __unused (sz);
-    assert(sizeof(SimPortEvent<Pkt>) == sz);
-    allocator_.deallocate(static_cast<SimPortEvent<Pkt>*>(ptr), 1);
-  }
-
 protected:
   const SimPort<Pkt>* port_;
   Pkt pkt_;
-  static inline PoolAllocator<SimPortEvent<Pkt>, 64> allocator_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Activity state reported by a simulation object at the end of a cycle.
+// Idle objects are put to sleep until one of their ports (or a port they
+// listen to) receives data, or until SimPlatform::wake() is called on them,
+// e.g. from a self-scheduled callback. The platform fast-forwards the clock
+// through cycles where no object is busy.
+enum class SimActivity {
+  Busy,       // has work to do next cycle
+  Idle,       // no work until an event delivers new input
+  Background  // advances internal state every cycle, visible to others only through events
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
 class SimContext {
 private:
-  SimContext() {}
+  SimContext(SimPlatform* platform) : platform_(platform) {}
+
+  SimPlatform* platform_;
 
   friend class SimPlatform;
+  friend class SimObjectBase;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -321,18 +328,34 @@ public:
     return name_;
   }
 
+  SimPlatform* platform() const {
+    return platform_;
+  }
+
 protected:
 
-  SimObjectBase(const SimContext&, const std::string& name) : name_(name) {}
+  SimObjectBase(const SimContext& ctx, const std::string& name)
+    : name_(name)
+    , platform_(ctx.platform_)
+    , sim_id_(0)
+    , sleep_cycles_(0)
+  {}
 
 private:
 
   std::string name_;
+  SimPlatform* platform_;
+  uint32_t    sim_id_;       // tick order
+  uint64_t    sleep_cycles_; // first cycle not ticked while sleeping
 
   virtual void do_reset() = 0;
 
   virtual void do_tick() = 0;
 
+  virtual SimActivity do_activity() const = 0;
+
+  virtual void do_skip(uint64_t cycles) = 0;
+
   friend class SimPortBase;
   friend class SimPlatform;
 };
@@ -353,6 +376,14 @@ protected:
     : SimObjectBase(ctx, name)
   {}
 
+  // default activity hooks, objects opt into idle-cycle skipping by shadowing them
+  SimActivity activity() const {
+    return SimActivity::Busy;
+  }
+
+  // credit cycles skipped while asleep
+  void skip(uint64_t /*cycles*/) {}
+
 private:
 
   const Impl* impl() const {
@@ -370,30 +401,79 @@ private:
   void do_tick() override {
     this->impl()->tick();
   }
+
+  SimActivity do_activity() const override {
+    return this->impl()->activity();
+  }
+
+  void do_skip(uint64_t cycles) override {
+    this->impl()->skip(cycles);
+  }
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Simulation platform of one device: owns its objects, event queues and clock.
+// Separate platforms share no state and can be ticked from different threads.
+// SimObject::Create() and the tracing macros use the platform bound to the
+// calling thread with SimPlatform::Scope.
 class SimPlatform {
 public:
-  static SimPlatform& instance() {
-    static SimPlatform s_inst;
-    return s_inst;
+  // binds a platform to the calling thread while in scope
+  class Scope {
+  public:
+    Scope(SimPlatform* platform) : prev_(s_current) {
+      s_current = platform;
+    }
+
+    ~Scope() {
+      s_current = prev_;
+    }
+
+  private:
+    SimPlatform* prev_;
+  };
+
+  static SimPlatform& current() {
+    __assert(s_current != nullptr, "no simulation platform bound to this thread!");
+    return *s_current;
+  }
+
+  SimPlatform(uint32_t id = 0)
+    : id_(id)
+    , cycles_(0)
+    , delta_(0)
+    , tick_idx_(0)
+    , skipped_cycles_(0) {
+    // idle-cycle skipping can be disabled with VORTEX_IDLE_SKIP=0
+    auto env = getenv("VORTEX_IDLE_SKIP");
+    idle_skip_ = (env == nullptr || env[0] != '0');
   }
 
-  bool initialize() {
-    //--
-    return true;
+  ~SimPlatform() {
+    this->cleanup();
+    for (auto& bin : event_bins_) {
+      for (auto mem : bin) {
+        ::operator delete(mem);
+      }
+    }
   }
 
+  SimPlatform(const SimPlatform&) = delete;
+  SimPlatform& operator=(const SimPlatform&) = delete;
+
+  // release all objects
   void finalize() {
-    instance().cleanup();
+    this->cleanup();
   }
 
   template <typename Impl, typename... Args>
   typename SimObject<Impl>::Ptr create_object(Args&&... args) {
-    auto obj = std::make_shared<Impl>(SimContext{}, std::forward<Args>(args)...);
+    auto obj = std::make_shared<Impl>(SimContext{this}, std::forward<Args>(args)...);
+    obj->sim_id_ = objects_.size();
     objects_.push_back(obj);
+    active_mask_.resize((objects_.size() + 63) / 64, 0);
+    this->set_active(obj->sim_id_);
     return obj;
   }
 
@@ -402,11 +482,11 @@ public:
                 const Pkt& pkt,
                 uint64_t delay) {
     if (delay == 0) {
-      auto evt = new SimCallEvent<Pkt>(callback, pkt, delta_);
+      auto evt = this->new_event<SimCallEvent<Pkt>>(callback, pkt, delta_);
       imm_events_.push_back(evt);
       ++delta_;
     } else {
-      auto evt = new SimCallEvent<Pkt>(callback, pkt, cycles_ + delay);
+      auto evt = this->new_event<SimCallEvent<Pkt>>(callback, pkt, cycles_ + delay);
       reg_events_.push_back(evt);
     }
   }
@@ -418,40 +498,98 @@ public:
     reg_events_.clear();
     for (auto& object : objects_) {
       object->do_reset();
+      object->sleep_cycles_ = 0;
+      this->set_active(object->sim_id_);
     }
     cycles_ = 0;
     delta_ = 0;
+    tick_idx_ = 0;
+    skipped_cycles_ = 0;
   }
 
   void tick() {
-    // execute objects
-    this->fire_immediate_events();
+    this->step();
+    if (idle_skip_) {
+      // put idle objects to sleep
+      bool busy = this->update_activity();
+      // fast-forward idle cycles
+      if (!busy) {
+        this->skip_idle_cycles();
+      }
+    }
+  }
+
+  // resume ticking a sleeping object, crediting the cycles it slept
+  void wake(SimObjectBase* object) {
+    auto id = object->sim_id_;
+    if (this->is_active(id))
+      return;
+    this->set_active(id);
+    this->credit_sleep(object);
+  }
+
+  // credit sleeping objects up to the current cycle,
+  // call before reading their statistics
+  void sync() {
     for (auto& object : objects_) {
-      object->do_tick();
-      this->fire_immediate_events();
+      if (!this->is_active(object->sim_id_)) {
+        this->credit_sleep(object.get());
+      }
     }
+  }
 
-    // realize objects
-    for (auto it = pop_list_.begin(); it != pop_list_.end();) {
-      it->do_pop();
-      it = pop_list_.erase(it);
+  // visit every object of a given type
+  template <typename Impl, typename Func>
+  void for_each(const Func& func) {
+    for (auto& object : objects_) {
+      auto obj = dynamic_cast<Impl*>(object.get());
+      if (obj) {
+        func(obj);
+      }
     }
-    push_list_.clear();
+  }
 
-    // fire registered events
-    this->fire_registered_events();
+  // index of the simulated device in the host process
+  uint32_t id() const {
+    return id_;
   }
 
   uint64_t cycles() const {
     return cycles_;
   }
 
+  // cycles fast-forwarded without ticking idle objects
+  uint64_t skipped_cycles() const {
+    return skipped_cycles_;
+  }
+
 private:
 
-  SimPlatform() : cycles_(0), delta_(0) {}
+  static constexpr uint32_t EVENT_ALIGN = 16;
 
-  virtual ~SimPlatform() {
-    this->cleanup();
+  // events are recycled through free lists binned by size
+  template <typename Evt, typename... Args>
+  Evt* new_event(Args&&... args) {
+    uint32_t bin = (sizeof(Evt) + EVENT_ALIGN - 1) / EVENT_ALIGN;
+    void* mem;
+    if (bin < event_bins_.size() && !event_bins_[bin].empty()) {
+      mem = event_bins_[bin].back();
+      event_bins_[bin].pop_back();
+    } else {
+      mem = ::operator new(bin * EVENT_ALIGN);
+    }
+    auto evt = new (mem) Evt(std::forward<Args>(args)...);
+    evt->alloc_bin_ = bin;
+    return evt;
+  }
+
+  void delete_event(SimEventBase* evt) {
+    uint32_t bin = evt->alloc_bin_;
+    evt->~SimEventBase();
+    if (bin >= event_bins_.size()) {
+      event_bins_.resize(bin + 1);
+    }
+    event_bins_[bin].push_back(evt);
   }
 
   void cleanup() {
@@ -470,11 +608,11 @@ private:
     }
     // schedule update event
     if (delay == 0) {
-      auto evt = new SimPortEvent<Pkt>(port, pkt, delta_);
+      auto evt = this->new_event<SimPortEvent<Pkt>>(port, pkt, delta_);
       imm_events_.push_back(evt);
       ++delta_;
     } else {
-      auto evt = new SimPortEvent<Pkt>(port, pkt, cycles_ + delay);
+      auto evt = this->new_event<SimPortEvent<Pkt>>(port, pkt, cycles_ + delay);
       reg_events_.push_back(evt);
     }
   }
@@ -493,7 +631,7 @@ private:
         if (event->cycles() == delta) {
           event->fire();
           evt_it = imm_events_.erase(evt_it);
-          delete event;
+          this->delete_event(event);
         } else {
           ++evt_it;
         }
@@ -502,48 +640,184 @@ private:
     delta_ = 0;
   }
 
-  void fire_registered_events() {
+  bool fire_registered_events() {
     // advance the clock
     ++cycles_;
 
+    bool fired = false;
+
     // fire all events that are scheduled for the current cycle
     for (auto evt_it = reg_events_.begin(), evt_it_end = reg_events_.end(); evt_it != evt_it_end;) {
       auto event = &*evt_it;
       if (event->cycles() == cycles_) {
         event->fire();
         evt_it = reg_events_.erase(evt_it);
-        delete event;
+        this->delete_event(event);
+        fired = true;
       } else {
         ++evt_it;
       }
     }
+    return fired;
+  }
+
+  uint64_t next_event_cycles() const {
+    uint64_t next = UINT64_MAX;
+    for (auto& event : reg_events_) {
+      next = std::min(next, event.cycles());
+    }
+    return next;
+  }
+
+  bool is_active(uint32_t id) const {
+    return (active_mask_[id / 64] >> (id % 64)) & 0x1;
+  }
+
+  void set_active(uint32_t id) {
+    active_mask_[id / 64] |= (1ull << (id % 64));
+  }
+
+  void clear_active(uint32_t id) {
+    active_mask_[id / 64] &= ~(1ull << (id % 64));
+  }
+
+  // first active object at or after <id>
+  uint32_t next_active(uint32_t id) const {
+    uint32_t n = active_mask_.size();
+    for (uint32_t w = id / 64; w < n; ++w) {
+      uint64_t bits = active_mask_[w];
+      if (w == id / 64) {
+        bits &= ~0ull << (id % 64);
+      }
+      if (bits) {
+        return w * 64 + __builtin_ctzll(bits);
+      }
+    }
+    return objects_.size();
+  }
+
+  void credit_sleep(SimObjectBase* object) {
+    // objects before the one ticking have already passed the current cycle
+    uint64_t cycles = cycles_ + (object->sim_id_ < tick_idx_);
+    if (cycles > object->sleep_cycles_) {
+      object->do_skip(cycles - object->sleep_cycles_);
+      object->sleep_cycles_ = cycles;
+    }
+  }
+
+  // put idle objects to sleep, returns true if any active object is busy
+  bool update_activity() {
+    bool busy = false;
+    for (uint32_t i = this->next_active(0), n = objects_.size(); i < n; i = this->next_active(i + 1)) {
+      auto& object = objects_[i];
+      switch (object->do_activity()) {
+      case SimActivity::Busy:
+        busy = true;
+        break;
+      case SimActivity::Idle:
+        object->sleep_cycles_ = cycles_;
+        this->clear_active(i);
+        break;
+      default:
+        break;
+      }
+    }
+    return busy;
+  }
+
+  // returns true if registered events were fired
+  bool step() {
+    // execute active objects in creation order,
+    // objects woken by an immediate event still tick this cycle
+    this->fire_immediate_events();
+    for (tick_idx_ = this->next_active(0); tick_idx_ < objects_.size(); tick_idx_ = this->next_active(tick_idx_ + 1)) {
+      objects_[tick_idx_]->do_tick();
+      this->fire_immediate_events();
+    }
+
+    // realize objects
+    for (auto it = pop_list_.begin(); it != pop_list_.end();) {
+      it->do_pop();
+      it = pop_list_.erase(it);
+    }
+    push_list_.clear();
+
+    // fire registered events
+    tick_idx_ = 0;
+    return this->fire_registered_events();
+  }
+
+  void skip_idle_cycles() {
+    if (!imm_events_.empty())
+      return;
+
+    // nothing changes until the next registered event,
+    // only background objects need to be ticked in between
+    uint64_t start = cycles_;
+    for (;;) {
+      uint64_t next = this->next_event_cycles();
+      if (next <= cycles_ + 1)
+        break;
+      if (this->next_active(0) == objects_.size()) {
+        // every object is asleep, jump to the cycle before the event
+        if (next == UINT64_MAX)
+          break; // nothing pending
+        cycles_ = next - 1;
+        break;
+      }
+      // stop once their outputs are delivered
+      if (this->step())
+        break;
+    }
+    skipped_cycles_ += cycles_ - start;
   }
 
   std::vector<SimObjectBase::Ptr> objects_;
+  std::vector<uint64_t> active_mask_;
   LinkedList<SimEventBase, &SimEventBase::list_> reg_events_;
   LinkedList<SimEventBase, &SimEventBase::list_> imm_events_;
   LinkedList<SimPortBase, &SimPortBase::push_list_> push_list_;
   LinkedList<SimPortBase, &SimPortBase::pop_list_> pop_list_;
+  uint32_t id_;
   uint64_t cycles_;
   uint32_t delta_;
+  uint32_t tick_idx_;
+  uint64_t skipped_cycles_;
+  bool idle_skip_;
+  std::vector<std::vector<void*>> event_bins_;
+
+  static inline thread_local SimPlatform* s_current = nullptr;
 
   template <typename U> friend class SimPort;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
+inline SimPlatform& SimPortBase::platform() const {
+  return module_ ? *module_->platform() : SimPlatform::current();
+}
+
+inline void SimPortBase::wake_listeners(bool enqueued) {
+  if (listener_) {
+    listener_->platform()->wake(listener_);
+  }
+  if (enqueued && module_) {
+    module_->platform()->wake(module_);
+  }
+}
+
 template <typename Pkt>
 void SimPort<Pkt>::push(const Pkt& pkt, uint64_t delay) {
   __assert(source_ == nullptr, "cannot be called on a sink port!")
   __assert(!this->full(), "port is full!");
-  SimPlatform::instance().schedule_push(this, pkt, delay);
+  this->platform().schedule_push(this, pkt, delay);
 }
 
 template <typename Pkt>
 uint64_t SimPort<Pkt>::pop() {
   __assert(sink_ == nullptr, "cannot be called on a stub port!")
   __assert(!this->empty(), "port is empty!");
-  SimPlatform::instance().schedule_pop(this);
+  this->platform().schedule_pop(this);
   return queue_.front().cycles;
 }
 
@@ -552,7 +826,7 @@ uint64_t SimPort<Pkt>::pop() {
 template <typename Impl>
 template <typename... Args>
 typename SimObject<Impl>::Ptr SimObject<Impl>::Create(Args&&... args) {
-  return SimPlatform::instance().create_object<Impl>(std::forward<Args>(args)...);
+  return SimPlatform::current().create_object<Impl>(std::forward<Args>(args)...);
 }
 
 }
\ No newline at end of file
@@ -59,6 +59,19 @@ std::string vortex::resolve_file_path(const std::string& filename, const std::st
   return filename;
 }
 
+std::string vortex::device_file_path(const std::string& filename, uint32_t device) {
+  if (device == 0)
+    return filename;
+  auto slash = filename.find_last_of('/');
+  auto dot = filename.find_last_of('.');
+  if (dot == std::string::npos
+   || dot == 0
+   || (slash != std::string::npos && dot <= slash + 1)) {
+    dot = filename.size();
+  }
+  return filename.substr(0, dot) + "." + std::to_string(device) + filename.substr(dot);
+}
+
 std::string vortex::to_hex_str(uint32_t v) {
   std::ostringstream oss;
   oss << "0x" << std::hex << v;
@@ -154,4 +154,7 @@ std::string to_hex_str(uint32_t v);
 
 std::string resolve_file_path(const std::string &filename, const std::string &searchPaths);
 
+// per-device output file: device 0 keeps the name, device N writes <name>.N<ext>
+std::string device_file_path(const std::string &filename, uint32_t device);
+
 } // namespace vortex
\ No newline at end of file
@@ -16,11 +16,21 @@
 #include "Vrtlsim_shim.h"
 
 #ifdef VCD_OUTPUT
+#ifdef FST_OUTPUT
+#include <verilated_fst_c.h>
+typedef VerilatedFstC VerilatedTraceFile;
+#define TRACE_FILE_NAME "trace.fst"
+#else
 #include <verilated_vcd_c.h>
+typedef VerilatedVcdC VerilatedTraceFile;
+#define TRACE_FILE_NAME "trace.vcd"
+#endif
 #endif
 
 #include <iostream>
 #include <fstream>
+#include <stdlib.h>
+#include <string>
 #include <iomanip>
 #include <mem.h>
 
@@ -77,18 +87,46 @@ double sc_time_stamp() {
 static bool trace_enabled = false;
 static uint64_t trace_start_time = TRACE_START_TIME;
 static uint64_t trace_stop_time  = TRACE_STOP_TIME;
+static bool trace_armed = false; // window waits on a trigger
 
 bool sim_trace_enabled() {
-  if (timestamp >= trace_start_time
+  if (!trace_armed
+   && timestamp >= trace_start_time
    && timestamp < trace_stop_time)
     return true;
   return trace_enabled;
 }
 
 void sim_trace_enable(bool enable) {
+  if (enable && trace_armed) {
+    // the window is relative to the trigger
+    trace_start_time = timestamp + trace_start_time;
+    trace_stop_time  = (trace_stop_time != -1ull) ? (timestamp + trace_stop_time) : -1ull;
+    trace_armed = false;
+    return;
+  }
   trace_enabled = enable;
 }
 
+// runtime trace window, in clock cycles:
+// VORTEX_TRACE_WINDOW=<start>[:<stop>] and VORTEX_TRACE_PC=<address> or
+// VORTEX_TRACE_DCR=<address> to count from a trigger instead of reset
+static void sim_trace_configure() {
+  auto env = getenv("VORTEX_TRACE_WINDOW");
+  if (env && env[0] != '\0') {
+    // timestamps advance twice per clock cycle
+    std::string value(env);
+    auto sep = value.find(':');
+    trace_start_time = 2 * std::strtoull(value.substr(0, sep).c_str(), nullptr, 0);
+    trace_stop_time  = (sep != std::string::npos) ? 2 * std::strtoull(value.c_str() + sep + 1, nullptr, 0) : -1ull;
+  }
+  auto pc = getenv("VORTEX_TRACE_PC");
+  auto dcr = getenv("VORTEX_TRACE_DCR");
+  if ((pc && pc[0] != '\0') || (dcr && dcr[0] != '\0')) {
+    trace_armed = true;
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class Processor::Impl {
@@ -104,13 +142,19 @@ public:
     // create RTL module instance
     device_ = new Vrtlsim_shim();
 
+    sim_trace_configure();
+
   #ifdef VCD_OUTPUT
     Verilated::traceEverOn(true);
-    tfp_ = new VerilatedVcdC();
-    device_->trace(tfp_, 99);
-    tfp_->open("trace.vcd");
+    tfp_ = new VerilatedTraceFile();
+    this->trace_scopes();
+    tfp_->open(TRACE_FILE_NAME);
   #endif
 
+    // DCR write that triggers tracing
+    auto trigger_dcr = getenv("VORTEX_TRACE_DCR");
+    trigger_dcr_ = (trigger_dcr && trigger_dcr[0] != '\0') ? std::strtoul(trigger_dcr, nullptr, 0) : -1;
+
     ram_ = nullptr;
 
     // reset the device
@@ -175,6 +219,10 @@ public:
   }
 
   void dcr_write(uint32_t addr, uint32_t value) {
+    if (addr == trigger_dcr_) {
+      sim_trace_enable(true);
+      trigger_dcr_ = -1;
+    }
     device_->dcr_wr_valid = 1;
     device_->dcr_wr_addr  = addr;
     device_->dcr_wr_data  = value;
@@ -185,6 +233,25 @@ public:
 
 private:
 
+#ifdef VCD_OUTPUT
+  void trace_scopes() {
+    // VORTEX_TRACE_DEPTH=<levels> limits the hierarchy depth (default: all),
+    // VORTEX_TRACE_SCOPE=<scope>[,<scope>...] restricts tracing to the given
+    // module instances, e.g. rtlsim_shim.vortex
+    auto depth_env = getenv("VORTEX_TRACE_DEPTH");
+    int depth = (depth_env && depth_env[0] != '\0') ? std::atoi(depth_env) : 99;
+    device_->trace(tfp_, depth);
+    auto scope_env = getenv("VORTEX_TRACE_SCOPE");
+    if (scope_env && scope_env[0] != '\0') {
+      std::stringstream ss(scope_env);
+      std::string scope;
+      while (std::getline(ss, scope, ',')) {
+        tfp_->dumpvars(depth, scope);
+      }
+    }
+  }
+#endif
+
   void reset() {
     this->mem_bus_reset();
     this->dcr_bus_reset();
@@ -405,8 +472,10 @@ private:
 
   RAM* ram_;
 
+  uint32_t trigger_dcr_;
+
 #ifdef VCD_OUTPUT
-  VerilatedVcdC *tfp_;
+  VerilatedTraceFile *tfp_;
 #endif
 };
 
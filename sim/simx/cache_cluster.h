@@ -87,6 +87,10 @@ public:
 
 	void tick() {}
 
+	SimActivity activity() const {
+		return SimActivity::Idle;
+	}
+
 	CacheSim::PerfStats perf_stats() const {
 		CacheSim::PerfStats perf;
 		for (auto cache : caches_) {
@@ -323,6 +323,7 @@ public:
 		, mshr_(config.mshr_size)
 		, pipe_req_(TFifo<bank_req_t>::Create("", config.latency-1))
 	{
+		pipe_req_->set_listener(this);
 		this->reset();
 	}
 
@@ -334,6 +335,13 @@ public:
 		pending_fill_reqs_ = 0;
   }
 
+	// drop all lines, contents otherwise persist across runs
+	void invalidate() {
+		for (auto& set : sets_) {
+			set.reset();
+		}
+	}
+
   void tick() {
 		// process input requests
 		this->processInputs();
@@ -345,6 +353,19 @@ public:
 		perf_stats_.mem_latency += pending_fill_reqs_;
 	}
 
+	SimActivity activity() const {
+		if (mshr_.has_ready_reqs()
+		 || !mem_rsp_port.empty()
+		 || !core_req_port.empty()
+		 || !pipe_req_->empty())
+			return SimActivity::Busy;
+		return SimActivity::Idle;
+	}
+
+	void skip(uint64_t cycles) {
+		perf_stats_.mem_latency += pending_fill_reqs_ * cycles;
+	}
+
 	const CacheSim::PerfStats& perf_stats() const {
 		return perf_stats_;
 	}
@@ -554,6 +575,7 @@ public:
 		, params_(config)
 		, banks_(1 << config.B)
 		, nc_mem_arbs_(config.mem_ports)
+		, init_cycles_(0)
 	{
 		char sname[100];
 
@@ -615,9 +637,21 @@ public:
 			banks_.at(i)->mem_req_port.bind(&bank_mem_arb->ReqIn.at(i));
 			bank_mem_arb->RspIn.at(i).bind(&banks_.at(i)->mem_rsp_port);
 		}
+
+		// wake up on responses consumed by the cache
+		for (uint32_t i = 0; i < config_.mem_ports; ++i) {
+			nc_mem_arbs_.at(i)->RspIn.at(1).set_listener(simobject);
+		}
+		for (uint32_t i = 0; i < config_.num_inputs; ++i) {
+			bank_core_xbar_->RspIn.at(i).set_listener(simobject);
+		}
 	}
 
   void reset() {
+		//--
+	}
+
+	void init() {
 		if (config_.bypass)
 			return;
 
@@ -625,6 +659,15 @@ public:
 		init_cycles_ = params_.sets_per_bank;
 	}
 
+	void invalidate() {
+		if (config_.bypass)
+			return;
+
+		for (auto& bank : banks_) {
+			bank->invalidate();
+		}
+	}
+
   void tick() {
 		if (config_.bypass)
 			return;
@@ -673,6 +716,23 @@ public:
 		}
 	}
 
+	SimActivity activity() const {
+		if (config_.bypass)
+			return SimActivity::Idle;
+		if (init_cycles_ != 0)
+			return SimActivity::Busy;
+		for (uint32_t i = 0, n = config_.mem_ports; i < n; ++i) {
+			if (!nc_mem_arbs_.at(i)->RspIn.at(1).empty())
+				return SimActivity::Busy;
+		}
+		for (uint32_t req_id = 0, n = config_.num_inputs; req_id < n; ++req_id) {
+			if (!bank_core_xbar_->RspIn.at(req_id).empty()
+			 || !simobject_->CoreReqPorts.at(req_id).empty())
+				return SimActivity::Busy;
+		}
+		return SimActivity::Idle;
+	}
+
 	PerfStats perf_stats() const {
 		PerfStats perf_stats;
 		if (!config_.bypass) {
@@ -740,10 +800,22 @@ void CacheSim::reset() {
   impl_->reset();
 }
 
+void CacheSim::init() {
+  impl_->init();
+}
+
+void CacheSim::invalidate() {
+  impl_->invalidate();
+}
+
 void CacheSim::tick() {
   impl_->tick();
 }
 
+SimActivity CacheSim::activity() const {
+  return impl_->activity();
+}
+
 CacheSim::PerfStats CacheSim::perf_stats() const {
   return impl_->perf_stats();
 }
\ No newline at end of file
@@ -80,8 +80,16 @@ public:
 
 	void reset();
 
+	// pay the initialization pass at the start of the run, lines are kept
+	void init();
+
+	// drop the cache contents
+	void invalidate();
+
 	void tick();
 
+	SimActivity activity() const;
+
 	PerfStats perf_stats() const;
 
 private:
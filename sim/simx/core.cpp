@@ -20,8 +20,12 @@
 #include "arch.h"
 #include "mem.h"
 #include "core.h"
+#include "socket.h"
+#include "cluster.h"
+#include "processor_impl.h"
 #include "debug.h"
 #include "constants.h"
+#include "pipe_trace.h"
 
 using namespace vortex;
 
@@ -39,6 +43,7 @@ Core::Core(const SimContext& ctx,
   , core_id_(core_id)
   , socket_(socket)
   , arch_(arch)
+  , pipe_trace_(&socket->cluster()->processor()->pipe_trace())
 #ifdef EXT_TCU_ENABLE
   , tensor_unit_(TensorUnit::Create("tcu", arch, this))
 #endif
@@ -135,27 +140,27 @@ Core::Core(const SimContext& ctx,
   }
 
   // initialize dispatchers
-  dispatchers_.at((int)FUType::ALU) = SimPlatform::instance().create_object<Dispatcher>(this, 2, NUM_ALU_BLOCKS, NUM_ALU_LANES);
-  dispatchers_.at((int)FUType::FPU) = SimPlatform::instance().create_object<Dispatcher>(this, 2, NUM_FPU_BLOCKS, NUM_FPU_LANES);
-  dispatchers_.at((int)FUType::LSU) = SimPlatform::instance().create_object<Dispatcher>(this, 2, NUM_LSU_BLOCKS, NUM_LSU_LANES);
-  dispatchers_.at((int)FUType::SFU) = SimPlatform::instance().create_object<Dispatcher>(this, 2, NUM_SFU_BLOCKS, NUM_SFU_LANES);
+  dispatchers_.at((int)FUType::ALU) = this->platform()->create_object<Dispatcher>(this, 2, NUM_ALU_BLOCKS, NUM_ALU_LANES);
+  dispatchers_.at((int)FUType::FPU) = this->platform()->create_object<Dispatcher>(this, 2, NUM_FPU_BLOCKS, NUM_FPU_LANES);
+  dispatchers_.at((int)FUType::LSU) = this->platform()->create_object<Dispatcher>(this, 2, NUM_LSU_BLOCKS, NUM_LSU_LANES);
+  dispatchers_.at((int)FUType::SFU) = this->platform()->create_object<Dispatcher>(this, 2, NUM_SFU_BLOCKS, NUM_SFU_LANES);
 #ifdef EXT_V_ENABLE
-  dispatchers_.at((int)FUType::VPU) = SimPlatform::instance().create_object<Dispatcher>(this, 2, NUM_VPU_BLOCKS, NUM_VPU_LANES);
+  dispatchers_.at((int)FUType::VPU) = this->platform()->create_object<Dispatcher>(this, 2, NUM_VPU_BLOCKS, NUM_VPU_LANES);
 #endif
 #ifdef EXT_TCU_ENABLE
-  dispatchers_.at((int)FUType::TCU) = SimPlatform::instance().create_object<Dispatcher>(this, 2, NUM_TCU_BLOCKS, NUM_TCU_LANES);
+  dispatchers_.at((int)FUType::TCU) = this->platform()->create_object<Dispatcher>(this, 2, NUM_TCU_BLOCKS, NUM_TCU_LANES);
 #endif
 
   // initialize execute units
-  func_units_.at((int)FUType::ALU) = SimPlatform::instance().create_object<AluUnit>(this);
-  func_units_.at((int)FUType::FPU) = SimPlatform::instance().create_object<FpuUnit>(this);
-  func_units_.at((int)FUType::LSU) = SimPlatform::instance().create_object<LsuUnit>(this);
-  func_units_.at((int)FUType::SFU) = SimPlatform::instance().create_object<SfuUnit>(this);
+  func_units_.at((int)FUType::ALU) = this->platform()->create_object<AluUnit>(this);
+  func_units_.at((int)FUType::FPU) = this->platform()->create_object<FpuUnit>(this);
+  func_units_.at((int)FUType::LSU) = this->platform()->create_object<LsuUnit>(this);
+  func_units_.at((int)FUType::SFU) = this->platform()->create_object<SfuUnit>(this);
 #ifdef EXT_V_ENABLE
-  func_units_.at((int)FUType::VPU) = SimPlatform::instance().create_object<VpuUnit>(this);
+  func_units_.at((int)FUType::VPU) = this->platform()->create_object<VpuUnit>(this);
 #endif
 #ifdef EXT_TCU_ENABLE
-  func_units_.at((int)FUType::TCU) = SimPlatform::instance().create_object<TcuUnit>(this);
+  func_units_.at((int)FUType::TCU) = this->platform()->create_object<TcuUnit>(this);
 #endif
 
   // bind commit arbiters
@@ -168,6 +173,15 @@ Core::Core(const SimContext& ctx,
     commit_arbs_.at(iw) = arbiter;
   }
 
+  // wake up on pipeline outputs consumed by the core
+  for (uint32_t iw = 0; iw < ISSUE_WIDTH; ++iw) {
+    operands_.at(iw)->Output.set_listener(this);
+    commit_arbs_.at(iw)->Outputs.at(0).set_listener(this);
+    for (auto& dispatch : dispatchers_) {
+      dispatch->Outputs.at(iw).set_listener(this);
+    }
+  }
+
   this->reset();
 }
 
@@ -226,6 +240,8 @@ void Core::schedule() {
 
   DT(3, "pipeline-schedule: " << *trace);
 
+  PT(*pipe_trace_, PipeStage::Schedule, trace);
+
   // advance to fetch stage
   fetch_latch_.push(trace);
   pending_instrs_.push_back(trace);
@@ -250,6 +266,11 @@ void Core::fetch() {
   if (fetch_latch_.empty())
     return;
   auto trace = fetch_latch_.front();
+  if (trace->itlb_latency != 0) {
+    // wait for the address translation
+    --trace->itlb_latency;
+    return;
+  }
   MemReq mem_req;
   mem_req.addr  = trace->PC;
   mem_req.write = false;
@@ -288,6 +309,8 @@ void Core::decode() {
 
   DT(3, "pipeline-decode: " << *trace);
 
+  PT(*pipe_trace_, PipeStage::Decode, trace);
+
   // insert to ibuffer
   ibuffer.push(trace);
 
@@ -318,19 +341,20 @@ void Core::issue() {
       has_instrs = true;
       auto trace = ibuffer.top();
       if (scoreboard_.in_use(trace)) {
-        auto uses = scoreboard_.get_uses(trace);
+        Scoreboard::reg_use_t uses[Scoreboard::MAX_USES];
+        uint32_t num_uses = scoreboard_.get_uses(trace, uses);
         if (!trace->log_once(true)) {
           DTH(4, "*** scoreboard-stall: dependents={");
-          for (uint32_t j = 0, n = uses.size(); j < n; ++j) {
-            auto& use = uses.at(j);
+          for (uint32_t j = 0; j < num_uses; ++j) {
+            auto& use = uses[j];
             __unused (use);
             if (j) DTN(4, ", ");
             DTN(4, use.reg_type << use.reg_id << " (#" << use.uuid << ")");
           }
           DTN(4, "}, " << *trace << std::endl);
         }
-        for (uint32_t j = 0, n = uses.size(); j < n; ++j) {
-          auto& use = uses.at(j);
+        for (uint32_t j = 0; j < num_uses; ++j) {
+          auto& use = uses[j];
           switch (use.fu_type) {
           case FUType::ALU: ++perf_stats_.scrb_alu; break;
           case FUType::FPU: ++perf_stats_.scrb_fpu; break;
@@ -366,6 +390,7 @@ void Core::issue() {
       auto trace = ibuffer.top();
       // update scoreboard
       DT(3, "pipeline-ibuffer: " << *trace);
+      PT(*pipe_trace_, PipeStage::IBuffer, trace);
       if (trace->wb) {
         scoreboard_.reserve(trace);
       }
@@ -405,6 +430,7 @@ void Core::commit() {
 
     // advance to commit stage
     DT(3, "pipeline-commit: " << *trace);
+    PT(*pipe_trace_, PipeStage::Commit, trace);
     assert(trace->cid == core_id_);
 
     // update scoreboard
@@ -434,6 +460,38 @@ void Core::commit() {
   }
 }
 
+SimActivity Core::activity() const {
+  if (!emulator_.idle()
+   || !fetch_latch_.empty()
+   || !decode_latch_.empty()
+   || !icache_rsp_ports.at(0).empty())
+    return SimActivity::Busy;
+  for (auto& ibuffer : ibuffers_) {
+    if (!ibuffer.empty())
+      return SimActivity::Busy;
+  }
+  for (uint32_t iw = 0; iw < ISSUE_WIDTH; ++iw) {
+    if (!operands_.at(iw)->Output.empty()
+     || !commit_arbs_.at(iw)->Outputs.at(0).empty())
+      return SimActivity::Busy;
+  }
+  for (auto& dispatch : dispatchers_) {
+    for (auto& output : dispatch->Outputs) {
+      if (!output.empty())
+        return SimActivity::Busy;
+    }
+  }
+  return SimActivity::Idle;
+}
+
+void Core::skip(uint64_t cycles) {
+  // every skipped cycle is a scheduler idle cycle
+  emulator_.skip(cycles);
+  perf_stats_.cycles += cycles;
+  perf_stats_.sched_idle += cycles;
+  perf_stats_.ifetch_latency += pending_ifetches_ * cycles;
+}
+
 int Core::get_exitcode() const {
   return emulator_.get_exitcode();
 }
@@ -451,14 +509,17 @@ bool Core::running() const {
 }
 
 void Core::resume(uint32_t wid) {
+  this->platform()->wake(this);
   emulator_.resume(wid);
 }
 
 bool Core::barrier(uint32_t bar_id, uint32_t count, uint32_t wid) {
+  this->platform()->wake(this);
   return emulator_.barrier(bar_id, count, wid);
 }
 
 bool Core::wspawn(uint32_t num_warps, Word nextPC) {
+  this->platform()->wake(this);
   return emulator_.wspawn(num_warps, nextPC);
 }
 
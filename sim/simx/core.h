@@ -40,6 +40,7 @@ namespace vortex {
 class Socket;
 class Arch;
 class DCRS;
+class PipeTrace;
 
 class Core : public SimObject<Core> {
 public:
@@ -118,6 +119,10 @@ public:
 
   void tick();
 
+  SimActivity activity() const;
+
+  void skip(uint64_t cycles);
+
   void attach_ram(RAM* ram);
 #ifdef VM_ENABLE
   void set_satp(uint64_t satp);
@@ -175,6 +180,10 @@ public:
     return trace_pool_;
   }
 
+  PipeTrace& pipe_trace() const {
+    return *pipe_trace_;
+  }
+
   const PerfStats& perf_stats() const;
 
   int get_exitcode() const;
@@ -191,6 +200,7 @@ private:
   uint32_t core_id_;
   Socket* socket_;
   const Arch& arch_;
+  PipeTrace* pipe_trace_;
 
 #ifdef EXT_TCU_ENABLE
   TensorUnit::Ptr tensor_unit_;
@@ -25,4 +25,11 @@ void DCRS::write(uint32_t addr, uint32_t value) {
 
   std::cerr << "Error: invalid global DCR addr=0x" << std::hex << addr << std::dec << std::endl;
   std::abort();
-}
\ No newline at end of file
+}
+
+void DCRS::set_startup(uint64_t addr, uint64_t arg) {
+  base_dcrs.write(VX_DCR_BASE_STARTUP_ADDR0, addr & 0xffffffff);
+  base_dcrs.write(VX_DCR_BASE_STARTUP_ADDR1, addr >> 32);
+  base_dcrs.write(VX_DCR_BASE_STARTUP_ARG0, arg & 0xffffffff);
+  base_dcrs.write(VX_DCR_BASE_STARTUP_ARG1, arg >> 32);
+}
@@ -39,6 +39,9 @@ class DCRS {
 public:
   void write(uint32_t addr, uint32_t value);
 
+  // set the kernel entry point and argument of the next launch
+  void set_startup(uint64_t addr, uint64_t arg);
+
   BaseDCRS base_dcrs;
 };
 
@@ -13,6 +13,7 @@
 
 #include "dispatcher.h"
 #include "core.h"
+#include "pipe_trace.h"
 
 using namespace vortex;
 
@@ -63,13 +64,11 @@ void Dispatcher::tick() {
         continue;
       }
       // calculate current packet start and end
-      int start(-1), end(-1);
-      for (uint32_t j = block_pid * num_lanes_, n = arch_.num_threads(); j < n; ++j) {
-        if (!trace->tmask.test(j))
-          continue;
-        if (start == -1)
-          start = j;
-        end = j;
+      uint32_t first_tid = block_pid * num_lanes_;
+      int start = first_tid ? trace->tmask.find_next(first_tid - 1) : trace->tmask.find_first();
+      int end = trace->tmask.find_last();
+      if (start >= (int)arch_.num_threads()) {
+        start = end = 0; // empty mask
       }
       start /= num_lanes_;
       end /= num_lanes_;
@@ -98,6 +97,7 @@ void Dispatcher::tick() {
       ++block_sent;
     }
     DT(3, "pipeline-dispatch: " << *new_trace);
+    PT(core_->pipe_trace(), PipeStage::Dispatch, new_trace);
     output.push(new_trace, 1);
   }
 
@@ -110,3 +110,19 @@ void Dispatcher::tick() {
     }
   }
 };
+
+SimActivity Dispatcher::activity() const {
+  for (auto& input : Inputs) {
+    if (!input.empty())
+      return SimActivity::Busy;
+  }
+  return SimActivity::Idle;
+}
+
+void Dispatcher::skip(uint64_t cycles) {
+  // empty batches rotate every cycle
+  batch_idx_ = (batch_idx_ + cycles) % num_blocks_;
+  for (auto& bp : block_pids_) {
+    bp = 0;
+  }
+}
@@ -34,6 +34,10 @@ public:
 
 	virtual void tick();
 
+	SimActivity activity() const;
+
+	void skip(uint64_t cycles);
+
 private:
 	const Arch& arch_;
 	Core*    core_;
@@ -68,6 +68,15 @@ void warp_t::reset(uint64_t startup_addr) {
     #endif
     }
   }
+
+#ifndef NDEBUG
+  this->ireg_uniform.set();
+  this->freg_uniform.set();
+#else
+  this->ireg_uniform.reset();
+  this->ireg_uniform.set(0);
+  this->freg_uniform.reset();
+#endif
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -78,6 +87,7 @@ Emulator::Emulator(const Arch &arch, const DCRS &dcrs, Core* core)
     , core_(core)
     , warps_(arch.num_warps(), arch.num_threads())
     , barriers_(arch.num_barriers(), 0)
+    , warp_sched_(arch.num_warps())
     , ipdom_size_(arch.num_threads()-1)
   #ifdef EXT_TCU_ENABLE
     , tensor_unit_(core->tensor_unit())
@@ -92,6 +102,21 @@ Emulator::Emulator(const Arch &arch, const DCRS &dcrs, Core* core)
 
 Emulator::~Emulator() {
   this->cout_flush();
+#ifdef VM_ENABLE
+  auto tlb_stats = getenv("VORTEX_TLB_STATS");
+  if (tlb_stats != nullptr && tlb_stats[0] != '\0' && tlb_stats[0] != '0') {
+    auto perf = mmu_.perf_stats();
+    std::cout << "PERF: core" << core_->id() << ": tlb hits=" << perf.tlb_hits
+              << ", misses=" << perf.tlb_misses
+              << ", evictions=" << perf.tlb_evicts
+              << ", l2 hits=" << perf.tlb_l2_hits
+              << ", walks=" << perf.ptws
+              << " (unique=" << perf.ptws_unique
+              << ", pwc hits=" << perf.pwc_hits
+              << ", pte reads=" << perf.pte_reads << ")"
+              << ", translation cycles=" << perf.tlb_cycles << std::endl;
+  }
+#endif
 }
 
 void Emulator::reset() {
@@ -121,6 +146,7 @@ void Emulator::reset() {
 
   stalled_warps_.reset();
   active_warps_.reset();
+  warp_sched_.reset();
 
   // activate first warp and thread
   active_warps_.set(0);
@@ -150,8 +176,6 @@ uint32_t Emulator::fetch(uint32_t wid, uint64_t uuid) {
 }
 
 instr_trace_t* Emulator::step() {
-  int scheduled_warp = -1;
-
   // process pending wspawn
   if (wspawn_.valid && active_warps_.count() == 1) {
     DP(3, "*** Activate " << (wspawn_.num_warps-1) << " warps at PC: " << std::hex << wspawn_.nextPC << std::dec);
@@ -166,14 +190,7 @@ instr_trace_t* Emulator::step() {
   }
 
   // find next ready warp
-  for (size_t wid = 0, nw = arch_.num_warps(); wid < nw; ++wid) {
-    bool warp_active = active_warps_.test(wid);
-    bool warp_stalled = stalled_warps_.test(wid);
-    if (warp_active && !warp_stalled) {
-      scheduled_warp = wid;
-      break;
-    }
-  }
+  int scheduled_warp = warp_sched_.select(active_warps_, stalled_warps_);
 
   if (scheduled_warp == -1)
     return nullptr;
@@ -183,19 +200,19 @@ instr_trace_t* Emulator::step() {
   assert(warp.tmask.any());
 
   // fetch next instruction if ibuffer is empty
+  uint32_t itlb_latency = 0;
   if (warp.ibuffer.empty()) {
-    uint64_t uuid = 0;
-  #ifndef NDEBUG
-    {
-      // generate unique universal instruction ID
-      uint32_t instr_uuid = warp.uuid++;
-      uint32_t g_wid = core_->id() * arch_.num_warps() + scheduled_warp;
-      uuid = (uint64_t(g_wid) << 32) | instr_uuid;
-    }
-  #endif
+    // generate unique universal instruction ID
+    // (also needed in release builds by the binary pipeline trace)
+    uint32_t instr_uuid = warp.uuid++;
+    uint32_t g_wid = core_->id() * arch_.num_warps() + scheduled_warp;
+    uint64_t uuid = (uint64_t(g_wid) << 32) | instr_uuid;
 
     // Fetch
     auto instr_code = this->fetch(scheduled_warp, uuid);
+  #ifdef VM_ENABLE
+    itlb_latency = mmu_.take_latency();
+  #endif
 
     // decode
     this->decode(instr_code, scheduled_warp, uuid);
@@ -212,9 +229,25 @@ instr_trace_t* Emulator::step() {
   // Execute
   auto trace = this->execute(*instr, scheduled_warp);
 
+  // the timing model stalls on TLB misses
+  trace->itlb_latency = itlb_latency;
+#ifdef VM_ENABLE
+  trace->dtlb_latency = mmu_.take_latency();
+#endif
+
   return trace;
 }
 
+bool Emulator::idle() const {
+  if (wspawn_.valid && active_warps_.count() == 1)
+    return false;
+  return (active_warps_ & ~stalled_warps_).none();
+}
+
+void Emulator::skip(uint64_t cycles) {
+  warp_sched_.skip(cycles);
+}
+
 bool Emulator::running() const {
   return active_warps_.any();
 }
@@ -474,6 +507,9 @@ Word Emulator::get_csr(uint32_t addr, uint32_t wid, uint32_t tid) {
     if ((addr >= VX_CSR_MPM_BASE && addr < (VX_CSR_MPM_BASE + 32))
      || (addr >= VX_CSR_MPM_BASE_H && addr < (VX_CSR_MPM_BASE_H + 32))) {
       // user-defined MPM CSRs
+      // bring sleeping objects' counters up to date
+      core_->platform()->sync();
+      core_perf = core_->perf_stats();
       auto perf_class = dcrs_.base_dcrs.read(VX_DCR_BASE_MPM_CLASS);
       switch (perf_class) {
       case VX_DCR_MPM_CLASS_NONE:
@@ -502,6 +538,13 @@ Word Emulator::get_csr(uint32_t addr, uint32_t wid, uint32_t tid) {
         CSR_READ_64(VX_CSR_MPM_STORES, core_perf.stores);
         CSR_READ_64(VX_CSR_MPM_IFETCH_LT, core_perf.ifetch_latency);
         CSR_READ_64(VX_CSR_MPM_LOAD_LT, core_perf.load_latency);
+        CSR_READ_64(VX_CSR_MPM_SCHED_WAIT, warp_sched_.perf_stats().sched_wait);
+        CSR_READ_64(VX_CSR_MPM_SCHED_STARV, warp_sched_.perf_stats().sched_starv);
+      #ifdef VM_ENABLE
+        CSR_READ_64(VX_CSR_MPM_TLB_MISS, mmu_.perf_stats().tlb_misses);
+        CSR_READ_64(VX_CSR_MPM_TLB_WALKS, mmu_.perf_stats().ptws);
+        CSR_READ_64(VX_CSR_MPM_TLB_LT, mmu_.perf_stats().tlb_cycles);
+      #endif
         }
       } break;
       case VX_DCR_MPM_CLASS_MEM: {
@@ -553,6 +596,40 @@ Word Emulator::get_csr(uint32_t addr, uint32_t wid, uint32_t tid) {
         CSR_READ_64(VX_CSR_MPM_LMEM_BANK_ST, lmem_perf.bank_stalls);
         }
       } break;
+      case VX_DCR_MPM_CLASS_DRAM: {
+        auto dram_perf = core_->socket()->cluster()->processor()->perf_stats().memsim.dram;
+        switch (addr) {
+        CSR_READ_64(VX_CSR_MPM_DRAM_READS, dram_perf.reads);
+        CSR_READ_64(VX_CSR_MPM_DRAM_WRITES, dram_perf.writes);
+        CSR_READ_64(VX_CSR_MPM_DRAM_ROW_HIT, dram_perf.row_hits);
+        CSR_READ_64(VX_CSR_MPM_DRAM_ROW_MISS, dram_perf.row_misses);
+        CSR_READ_64(VX_CSR_MPM_DRAM_ROW_CONF, dram_perf.row_conflicts);
+        CSR_READ_64(VX_CSR_MPM_DRAM_RW_TURN, dram_perf.rw_turnarounds);
+        CSR_READ_64(VX_CSR_MPM_DRAM_QUEUE, dram_perf.queue_occupancy);
+        CSR_READ_64(VX_CSR_MPM_DRAM_READ_LT, dram_perf.read_latency);
+        CSR_READ_64(VX_CSR_MPM_DRAM_CYCLES, dram_perf.cycles);
+        CSR_READ_64(VX_CSR_MPM_DRAM_BYTES, dram_perf.bytes);
+        default: {
+          // per-channel bandwidth counters
+          static_assert(VX_CSR_MPM_DRAM_CHANNELS == DramSim::MAX_CHANNELS, "invalid DRAM channel counters");
+          uint32_t csr = addr;
+          uint32_t shift = 0;
+#ifndef XLEN_64
+          if (csr >= VX_CSR_MPM_BASE_H) {
+            csr -= (VX_CSR_MPM_BASE_H - VX_CSR_MPM_BASE);
+            shift = 32;
+          }
+#endif
+          uint64_t value = 0;
+          if (csr >= VX_CSR_MPM_DRAM_CH_RD && csr < (VX_CSR_MPM_DRAM_CH_RD + VX_CSR_MPM_DRAM_CHANNELS)) {
+            value = dram_perf.channel_read_bytes[csr - VX_CSR_MPM_DRAM_CH_RD];
+          } else if (csr >= VX_CSR_MPM_DRAM_CH_WR && csr < (VX_CSR_MPM_DRAM_CH_WR + VX_CSR_MPM_DRAM_CHANNELS)) {
+            value = dram_perf.channel_write_bytes[csr - VX_CSR_MPM_DRAM_CH_WR];
+          }
+          return Word(value >> shift);
+        }
+        }
+      } break;
       default:
         std::cerr << "Error: invalid MPM CLASS: value=" << perf_class << std::endl;
         std::abort();
@@ -20,6 +20,7 @@
 #include <mem.h>
 #include "types.h"
 #include "instr.h"
+#include "warp_sched.h"
 #ifdef EXT_TCU_ENABLE
 #include "tensor_unit.h"
 #endif
@@ -54,6 +55,8 @@ struct ipdom_entry_t {
 struct warp_t {
   std::vector<std::vector<Word>>    ireg_file;
   std::vector<std::vector<uint64_t>>freg_file;
+  RegMask                           ireg_uniform; // all threads hold the value of the first thread
+  RegMask                           freg_uniform;
   std::deque<Instr::Ptr>            ibuffer;
   std::stack<ipdom_entry_t>         ipdom_stack;
   ThreadMask                        tmask;
@@ -92,6 +95,12 @@ public:
 
   instr_trace_t* step();
 
+  // no warp can be scheduled until one is resumed
+  bool idle() const;
+
+  // account for cycles skipped while idle
+  void skip(uint64_t cycles);
+
   bool running() const;
 
   void suspend(uint32_t wid);
@@ -116,7 +125,9 @@ private:
 
   instr_trace_t* execute(const Instr &instr, uint32_t wid);
 
-  void fetch_registers(std::vector<reg_data_t>& out, uint32_t wid, uint32_t src_index, const RegOpd& reg);
+  void fetch_registers(std::vector<reg_data_t>& out, uint32_t wid, uint32_t src_index, const RegOpd& reg, uint32_t thread_end);
+
+  bool is_uniform(const warp_t& warp, const RegOpd& reg) const;
 
   void icache_read(void* data, uint64_t addr, uint32_t size);
 
@@ -149,6 +160,7 @@ private:
   WarpMask    active_warps_;
   WarpMask    stalled_warps_;
   std::vector<WarpMask> barriers_;
+  WarpScheduler warp_sched_;
   std::unordered_map<int, std::stringstream> print_bufs_;
   MemoryUnit  mmu_;
   uint32_t    ipdom_size_;
@@ -17,6 +17,7 @@
 #include <math.h>
 #include <bitset>
 #include <climits>
+#include <algorithm>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <assert.h>
@@ -47,11 +48,13 @@ inline int64_t check_boxing(int64_t a) {
   return nan_box(0x7fc00000); // NaN
 }
 
-void Emulator::fetch_registers(std::vector<reg_data_t>& out, uint32_t wid, uint32_t src_index, const RegOpd& reg) {
+void Emulator::fetch_registers(std::vector<reg_data_t>& out, uint32_t wid, uint32_t src_index, const RegOpd& reg, uint32_t thread_end) {
   __unused(src_index);
   auto& warp = warps_.at(wid);
   uint32_t num_threads = warp.tmask.size();
   out.resize(num_threads);
+  // a uniform register only holds its value in the first thread
+  bool uniform = this->is_uniform(warp, reg);
   switch (reg.type) {
   case RegType::None:
 #ifdef EXT_V_ENABLE
@@ -71,14 +74,14 @@ void Emulator::fetch_registers(std::vector<reg_data_t>& out, uint32_t wid, uint3
   case RegType::Integer: {
     DPH(2, "Src" << src_index << " Reg: " << reg << "={");
     auto& reg_data = warp.ireg_file.at(reg.idx);
-    for (uint32_t t = 0; t < num_threads; ++t) {
+    for (uint32_t t = 0; t < thread_end; ++t) {
       if (t) DPN(2, ", ");
       if (!warp.tmask.test(t)) {
         DPN(2, "-");
         continue;
       }
       auto& value = out[t];
-      value.u = reg_data.at(t);
+      value.u = reg_data.at(uniform ? 0 : t);
       DPN(2, "0x" << std::hex << value.u << std::dec);
     }
     DPN(2, "}" << std::endl);
@@ -86,14 +89,14 @@ void Emulator::fetch_registers(std::vector<reg_data_t>& out, uint32_t wid, uint3
   case RegType::Float: {
     DPH(2, "Src" << src_index << " Reg: " << reg << "={");
     auto& reg_data = warp.freg_file.at(reg.idx);
-    for (uint32_t t = 0; t < num_threads; ++t) {
+    for (uint32_t t = 0; t < thread_end; ++t) {
       if (t) DPN(2, ", ");
       if (!warp.tmask.test(t)) {
         DPN(2, "-");
         continue;
       }
       auto& value = out[t];
-      value.u64 = reg_data.at(t);
+      value.u64 = reg_data.at(uniform ? 0 : t);
       if ((value.u64 >> 32) == 0xffffffff) {
         DPN(2, "0x" << std::hex << value.u32 << std::dec);
       } else {
@@ -108,6 +111,19 @@ void Emulator::fetch_registers(std::vector<reg_data_t>& out, uint32_t wid, uint3
   }
 }
 
+bool Emulator::is_uniform(const warp_t& warp, const RegOpd& reg) const {
+  switch (reg.type) {
+  case RegType::None:
+    return true;
+  case RegType::Integer:
+    return warp.ireg_uniform.test(reg.idx);
+  case RegType::Float:
+    return warp.freg_uniform.test(reg.idx);
+  default:
+    return false;
+  }
+}
+
 instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
   auto& warp = warps_.at(wid);
   assert(warp.tmask.any());
@@ -145,11 +161,6 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
   DP(1, "Instr: " << instr << ", cid=" << core_->id() << ", wid=" << wid << ", tmask=" << warp.tmask
          << ", PC=0x" << std::hex << warp.PC << std::dec << " (#" << instr.getUUID() << ")");
 
-  // fetch register values
-  if (rsrc0.type != RegType::None) fetch_registers(rs1_data, wid, 0, rsrc0);
-  if (rsrc1.type != RegType::None) fetch_registers(rs2_data, wid, 1, rsrc1);
-  if (rsrc2.type != RegType::None) fetch_registers(rs3_data, wid, 2, rsrc2);
-
   uint32_t thread_start = 0;
   for (; thread_start < num_threads; ++thread_start) {
     if (warp.tmask.test(thread_start))
@@ -162,6 +173,22 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
       break;
   }
 
+  // ALU, MDV and FPU operations on warp-uniform sources are evaluated on the
+  // first active thread only, then broadcast to the other active threads.
+  bool srcs_uniform = this->is_uniform(warp, rsrc0)
+                   && this->is_uniform(warp, rsrc1)
+                   && this->is_uniform(warp, rsrc2);
+  bool scalar_op = srcs_uniform
+                && (std::holds_alternative<AluType>(op_type)
+                 || std::holds_alternative<MdvType>(op_type)
+                 || std::holds_alternative<FpuType>(op_type));
+
+  // fetch register values, only the first active thread is read for scalar operations
+  uint32_t fetch_end = scalar_op ? (thread_start + 1) : num_threads;
+  if (rsrc0.type != RegType::None) fetch_registers(rs1_data, wid, 0, rsrc0, fetch_end);
+  if (rsrc1.type != RegType::None) fetch_registers(rs2_data, wid, 1, rsrc1, fetch_end);
+  if (rsrc2.type != RegType::None) fetch_registers(rs3_data, wid, 2, rsrc2, fetch_end);
+
   bool is_w_enabled = false;
 #ifdef XLEN_64
   is_w_enabled = true;
@@ -169,27 +196,35 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
 
   bool rd_write = false;
 
+  uint32_t thread_end = num_threads;
+  bool rd_scalar = false;
+  bool rd_uniform = false;
+
   visit_var(op_type,
     [&](AluType alu_type) {
+      if (scalar_op) {
+        thread_end = thread_start + 1;
+        rd_scalar = true;
+      }
       auto aluArgs = std::get<IntrAluArgs>(instrArgs);
       Word imm = sext<Word>(aluArgs.imm, 32);
       switch (alu_type) {
       case AluType::LUI: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           rd_data[t].i = imm;
         }
       } break;
       case AluType::AUIPC: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           rd_data[t].i = imm + warp.PC;
         }
       } break;
       case AluType::ADD: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           if (is_w_enabled && aluArgs.is_w) {
@@ -201,7 +236,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case AluType::SUB: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           if (is_w_enabled && aluArgs.is_w) {
@@ -213,14 +248,14 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case AluType::SLT: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           rd_data[t].i = rs1_data[t].i < (aluArgs.is_imm ? WordI(imm) : rs2_data[t].i);
         }
       } break;
       case AluType::SLTU: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           rd_data[t].i = rs1_data[t].u < (aluArgs.is_imm ? imm : rs2_data[t].u);
@@ -228,7 +263,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
       } break;
       case AluType::SLL: {
         Word shamt_mask = (Word(1) << log2up(XLEN)) - 1;
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           if (is_w_enabled && aluArgs.is_w) {
@@ -243,7 +278,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
       } break;
       case AluType::SRA: {
         Word shamt_mask = (Word(1) << log2up(XLEN)) - 1;
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           if (is_w_enabled && aluArgs.is_w) {
@@ -258,7 +293,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
       } break;
       case AluType::SRL: {
         Word shamt_mask = (Word(1) << log2up(XLEN)) - 1;
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           if (is_w_enabled && aluArgs.is_w) {
@@ -272,28 +307,28 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case AluType::AND: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           rd_data[t].i = rs1_data[t].i & (aluArgs.is_imm ? imm : rs2_data[t].i);
         }
       } break;
       case AluType::OR: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           rd_data[t].i = rs1_data[t].i | (aluArgs.is_imm ? imm : rs2_data[t].i);
         }
       } break;
       case AluType::XOR: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           rd_data[t].i = rs1_data[t].i ^ (aluArgs.is_imm ? imm : rs2_data[t].i);
         }
       } break;
       case AluType::CZERO: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           bool cond = (rs2_data[t].i == 0) ^ aluArgs.imm;
@@ -340,6 +375,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       }
       rd_write = true;
+      rd_uniform = true;
     },
     [&](ShflType shfl_type) {
       for (uint32_t t = thread_start; t < num_threads; ++t) {
@@ -491,10 +527,14 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
       }
     },
     [&](MdvType mdv_type) {
+      if (scalar_op) {
+        thread_end = thread_start + 1;
+        rd_scalar = true;
+      }
       auto mdvArgs = std::get<IntrMdvArgs>(instrArgs);
       switch (mdv_type) {
       case MdvType::MUL: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           if (is_w_enabled && mdvArgs.is_w) {
@@ -506,7 +546,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case MdvType::MULH: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           auto first = static_cast<DWordI>(rs1_data[t].i);
@@ -515,7 +555,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case MdvType::MULHSU: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           auto first = static_cast<DWordI>(rs1_data[t].i);
@@ -524,7 +564,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case MdvType::MULHU: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           auto first = static_cast<DWord>(rs1_data[t].u);
@@ -533,7 +573,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case MdvType::DIV: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           if (is_w_enabled && mdvArgs.is_w) {
@@ -566,7 +606,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case MdvType::DIVU: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           if (is_w_enabled && mdvArgs.is_w) {
@@ -593,7 +633,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case MdvType::REM: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           if (is_w_enabled && mdvArgs.is_w) {
@@ -626,7 +666,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case MdvType::REMU: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           if (is_w_enabled && mdvArgs.is_w) {
@@ -909,10 +949,14 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
       rd_write = true;
     },
     [&](FpuType fpu_type) {
+      if (scalar_op) {
+        thread_end = thread_start + 1;
+        rd_scalar = true;
+      }
       auto fpuArgs = std::get<IntrFpuArgs>(instrArgs);
       switch (fpu_type) {
       case FpuType::FADD: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           uint32_t frm = this->get_fpu_rm(fpuArgs.frm, wid, t);
@@ -926,7 +970,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case FpuType::FSUB: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           uint32_t frm = this->get_fpu_rm(fpuArgs.frm, wid, t);
@@ -940,7 +984,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case FpuType::FMUL: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           uint32_t frm = this->get_fpu_rm(fpuArgs.frm, wid, t);
@@ -954,7 +998,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case FpuType::FDIV: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           uint32_t frm = this->get_fpu_rm(fpuArgs.frm, wid, t);
@@ -968,7 +1012,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case FpuType::FSQRT: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           uint32_t frm = this->get_fpu_rm(fpuArgs.frm, wid, t);
@@ -982,7 +1026,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case FpuType::FSGNJ: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           uint32_t fflags = 0;
@@ -1015,7 +1059,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case FpuType::FMINMAX: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           uint32_t fflags = 0;
@@ -1036,7 +1080,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case FpuType::FCMP: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           uint32_t fflags = 0;
@@ -1069,7 +1113,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case FpuType::F2I: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           uint32_t frm = this->get_fpu_rm(fpuArgs.frm, wid, t);
@@ -1113,7 +1157,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case FpuType::I2F: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           uint32_t frm = this->get_fpu_rm(fpuArgs.frm, wid, t);
@@ -1153,7 +1197,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case FpuType::F2F: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           uint32_t fflags = 0;
@@ -1166,7 +1210,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case FpuType::FCLASS: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           uint32_t fflags = 0;
@@ -1179,7 +1223,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case FpuType::FMVXW: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           uint32_t fflags = 0;
@@ -1193,7 +1237,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case FpuType::FMVWX: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           uint32_t fflags = 0;
@@ -1206,7 +1250,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case FpuType::FMADD:
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           uint32_t frm = this->get_fpu_rm(fpuArgs.frm, wid, t);
@@ -1220,7 +1264,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
         break;
       case FpuType::FMSUB: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           uint32_t frm = this->get_fpu_rm(fpuArgs.frm, wid, t);
@@ -1234,7 +1278,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case FpuType::FNMADD: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           uint32_t frm = this->get_fpu_rm(fpuArgs.frm, wid, t);
@@ -1248,7 +1292,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       } break;
       case FpuType::FNMSUB: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
+        for (uint32_t t = thread_start; t < thread_end; ++t) {
           if (!warp.tmask.test(t))
             continue;
           uint32_t frm = this->get_fpu_rm(fpuArgs.frm, wid, t);
@@ -1468,6 +1512,18 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
   #endif // EXT_TCU_ENABLE
   );
 
+  // a register stays uniform only if every thread received the same value
+  rd_uniform = (rd_uniform || rd_scalar) && warp.tmask.all();
+
+  // uniform results are written back once, others need a value per thread
+  if (rd_scalar && !rd_uniform) {
+    for (uint32_t t = thread_start + 1; t < num_threads; ++t) {
+      if (warp.tmask.test(t)) {
+        rd_data[t] = rd_data[thread_start];
+      }
+    }
+  }
+
   if (rd_write) {
     trace->wb = true;
     switch (rdest.type) {
@@ -1475,6 +1531,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
       break;
     case RegType::Integer:
       if (rdest.idx != 0) {
+        auto& reg_data = warp.ireg_file.at(rdest.idx);
         DPH(2, "Dest Reg: " << rdest << "={");
         for (uint32_t t = 0; t < num_threads; ++t) {
           if (t) DPN(2, ", ");
@@ -1482,16 +1539,30 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
             DPN(2, "-");
             continue;
           }
-          warp.ireg_file.at(rdest.idx).at(t) = rd_data[t].i;
-          DPN(2, "0x" << std::hex << rd_data[t].u << std::dec);
+          DPN(2, "0x" << std::hex << rd_data[rd_uniform ? thread_start : t].u << std::dec);
         }
         DPN(2, "}" << std::endl);
+        if (rd_uniform) {
+          reg_data.at(0) = rd_data[thread_start].i;
+        } else {
+          if (warp.ireg_uniform.test(rdest.idx)) {
+            // inactive threads keep the previous uniform value
+            std::fill(reg_data.begin() + 1, reg_data.end(), reg_data.at(0));
+          }
+          for (uint32_t t = thread_start; t < num_threads; ++t) {
+            if (warp.tmask.test(t)) {
+              reg_data.at(t) = rd_data[t].i;
+            }
+          }
+        }
+        warp.ireg_uniform.set(rdest.idx, rd_uniform);
       } else {
         // disable writes to x0
         trace->wb = false;
       }
       break;
-    case RegType::Float:
+    case RegType::Float: {
+      auto& reg_data = warp.freg_file.at(rdest.idx);
       DPH(2, "Dest Reg: " << rdest << "={");
       for (uint32_t t = 0; t < num_threads; ++t) {
         if (t) DPN(2, ", ");
@@ -1499,15 +1570,29 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
           DPN(2, "-");
           continue;
         }
-        warp.freg_file.at(rdest.idx).at(t) = rd_data[t].u64;
-        if ((rd_data[t].u64 >> 32) == 0xffffffff) {
-          DPN(2, "0x" << std::hex << rd_data[t].u32 << std::dec);
+        auto& value = rd_data[rd_uniform ? thread_start : t];
+        if ((value.u64 >> 32) == 0xffffffff) {
+          DPN(2, "0x" << std::hex << value.u32 << std::dec);
         } else {
-          DPN(2, "0x" << std::hex << rd_data[t].u64 << std::dec);
+          DPN(2, "0x" << std::hex << value.u64 << std::dec);
         }
       }
       DPN(2, "}" << std::endl);
-      break;
+      if (rd_uniform) {
+        reg_data.at(0) = rd_data[thread_start].u64;
+      } else {
+        if (warp.freg_uniform.test(rdest.idx)) {
+          // inactive threads keep the previous uniform value
+          std::fill(reg_data.begin() + 1, reg_data.end(), reg_data.at(0));
+        }
+        for (uint32_t t = thread_start; t < num_threads; ++t) {
+          if (warp.tmask.test(t)) {
+            reg_data.at(t) = rd_data[t].u64;
+          }
+        }
+      }
+      warp.freg_uniform.set(rdest.idx, rd_uniform);
+    } break;
   #ifdef EXT_V_ENABLE
     case RegType::Vector:
       DPH(2, "Dest Reg: " << rdest << "={");
@@ -1549,12 +1634,12 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
     DPN(5, "  %r" << std::setfill('0') << std::setw(2) << i << ':' << std::hex);
     // Integer register file
     for (uint32_t j = 0; j < arch_.num_threads(); ++j) {
-      DPN(5, ' ' << std::setfill('0') << std::setw(XLEN/4) << warp.ireg_file.at(i).at(j) << std::setfill(' ') << ' ');
+      DPN(5, ' ' << std::setfill('0') << std::setw(XLEN/4) << warp.ireg_file.at(i).at(warp.ireg_uniform.test(i) ? 0 : j) << std::setfill(' ') << ' ');
     }
     DPN(5, '|');
     // Floating point register file
     for (uint32_t j = 0; j < arch_.num_threads(); ++j) {
-      DPN(5, ' ' << std::setfill('0') << std::setw(16) << warp.freg_file.at(i).at(j) << std::setfill(' ') << ' ');
+      DPN(5, ' ' << std::setfill('0') << std::setw(16) << warp.freg_file.at(i).at(warp.freg_uniform.test(i) ? 0 : j) << std::setfill(' ') << ' ');
     }
     DPN(5, std::dec << std::endl);
   }
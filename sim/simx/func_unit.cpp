@@ -159,7 +159,11 @@ void FpuUnit::tick() {
 LsuUnit::LsuUnit(const SimContext& ctx, Core* core)
 	: FuncUnit(ctx, core, "lsu-unit")
 	, pending_loads_(0)
-{}
+{
+	for (uint32_t b = 0; b < NUM_LSU_BLOCKS; ++b) {
+		core_->lmem_switch_.at(b)->RspIn.set_listener(this);
+	}
+}
 
 LsuUnit::~LsuUnit()
 {}
@@ -252,6 +256,12 @@ void LsuUnit::tick() {
 			continue;
 		}
 
+		// wait for the address translation
+		if (remain_addrs_ == 0 && trace->dtlb_latency != 0) {
+			--trace->dtlb_latency;
+			continue;
+		}
+
 		// check pending queue capacity
 		if (!is_write && state.pending_rd_reqs.full()) {
 			if (!trace->log_once(true)) {
@@ -314,6 +324,7 @@ void LsuUnit::tick() {
 			lsu_req.uuid = trace->uuid;
 
 			// send memory request
+			core_->local_mem()->profile(trace->PC, lsu_req);
 			core_->lmem_switch_.at(block_idx)->ReqIn.push(lsu_req);
 			DT(3, this->name() << "-mem-req: " << lsu_req);
 
@@ -337,6 +348,23 @@ void LsuUnit::tick() {
 	}
 }
 
+SimActivity LsuUnit::activity() const {
+	if (!this->inputs_empty())
+		return SimActivity::Busy;
+	for (uint32_t b = 0; b < NUM_LSU_BLOCKS; ++b) {
+		if (!core_->lmem_switch_.at(b)->RspIn.empty())
+			return SimActivity::Busy;
+		auto& state = states_.at(b);
+		if (state.fence_lock && state.pending_rd_reqs.empty())
+			return SimActivity::Busy;
+	}
+	return SimActivity::Idle;
+}
+
+void LsuUnit::skip(uint64_t cycles) {
+	core_->perf_stats_.load_latency += pending_loads_ * cycles;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 SfuUnit::SfuUnit(const SimContext& ctx, Core* core)
@@ -39,7 +39,23 @@ public:
 
 	virtual void tick() = 0;
 
+	// units must opt into idle-cycle skipping
+	virtual SimActivity activity() const {
+		return SimActivity::Busy;
+	}
+
+	virtual void skip(uint64_t /*cycles*/) {}
+
 protected:
+
+	bool inputs_empty() const {
+		for (auto& input : Inputs) {
+			if (!input.empty())
+				return false;
+		}
+		return true;
+	}
+
 	Core* core_;
 };
 
@@ -50,6 +66,10 @@ public:
   AluUnit(const SimContext& ctx, Core*);
 
   void tick() override;
+
+  SimActivity activity() const override {
+    return this->inputs_empty() ? SimActivity::Idle : SimActivity::Busy;
+  }
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -59,6 +79,10 @@ public:
   FpuUnit(const SimContext& ctx, Core*);
 
   void tick() override;
+
+  SimActivity activity() const override {
+    return this->inputs_empty() ? SimActivity::Idle : SimActivity::Busy;
+  }
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -71,6 +95,9 @@ public:
 	void reset() override;
 	void tick() override;
 
+	SimActivity activity() const override;
+	void skip(uint64_t cycles) override;
+
 private:
 
  	struct pending_req_t {
@@ -106,6 +133,10 @@ public:
 	SfuUnit(const SimContext& ctx, Core*);
 
 	void tick() override;
+
+	SimActivity activity() const override {
+		return this->inputs_empty() ? SimActivity::Idle : SimActivity::Busy;
+	}
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -76,6 +76,10 @@ public:
 
   bool fetch_stall;
 
+  // address translation cycles of the fetch and of the memory accesses
+  uint32_t itlb_latency;
+  uint32_t dtlb_latency;
+
   uint64_t issue_time ;
 
   instr_trace_t(uint64_t uuid, const Arch& arch)
@@ -95,7 +99,9 @@ public:
     , sop(true)
     , eop(true)
     , fetch_stall(false)
-    , issue_time(SimPlatform::instance().cycles())
+    , itlb_latency(0)
+    , dtlb_latency(0)
+    , issue_time(SimPlatform::current().cycles())
     , log_once_(false)
   {}
 
@@ -116,6 +122,8 @@ public:
     , sop(rhs.sop)
     , eop(rhs.eop)
     , fetch_stall(rhs.fetch_stall)
+    , itlb_latency(rhs.itlb_latency)
+    , dtlb_latency(rhs.dtlb_latency)
     , issue_time(rhs.issue_time)
     , log_once_(false)
   {}
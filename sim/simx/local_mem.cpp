@@ -15,16 +15,44 @@
 #include "core.h"
 #include <bitmanip.h>
 #include <vector>
+#include <map>
+#include <fstream>
+#include <string.h>
 #include "types.h"
 
 using namespace vortex;
 
+namespace {
+
+enum class BankHash {
+	Linear, // consecutive words map to consecutive banks
+	Xor     // bank bits are XOR-ed with the word row bits
+};
+
+// bank hashing, selected at runtime with VORTEX_LMEM_BANK_HASH=linear|xor
+BankHash bank_hash() {
+	static BankHash s_hash = [] {
+		auto env = getenv("VORTEX_LMEM_BANK_HASH");
+		if (env == nullptr || env[0] == '\0' || 0 == strcmp(env, "linear"))
+			return BankHash::Linear;
+		if (0 == strcmp(env, "xor"))
+			return BankHash::Xor;
+		std::cerr << "Error: invalid local memory bank hash: " << env << std::endl;
+		std::abort();
+	}();
+	return s_hash;
+}
+
+}
+
 class LocalMem::Impl {
 protected:
 	LocalMem* simobject_;
 	Config    config_;
 	RAM       ram_;
 	uint32_t 	line_bits_;
+	uint32_t  lg2_line_size_;
+	BankHash  bank_hash_;
 	MemCrossBar::Ptr mem_xbar_;
 	mutable PerfStats perf_stats_;
 
@@ -37,23 +65,27 @@ public:
 		: simobject_(simobject)
 		, config_(config)
 		, ram_(config.capacity)
+		, lg2_line_size_(log2ceil(config.line_size))
+		, bank_hash_(bank_hash())
 	{
 		uint32_t total_lines = config.capacity / config.line_size;
 		line_bits_ = log2ceil(total_lines);
 
 		char sname[100];
 		snprintf(sname, 100, "%s-xbar", simobject->name().c_str());
-		uint32_t lg2_line_size = log2ceil(config_.line_size);
 		uint32_t num_banks = 1 << config.B;
 		mem_xbar_ = MemCrossBar::Create(sname, ArbiterType::Priority, config.num_reqs, num_banks,
-		 [lg2_line_size, num_banks](const MemCrossBar::ReqType& req) {
-    	// Custom logic to calculate the output index using bank interleaving
-			return (uint32_t)((req.addr >> lg2_line_size) & (num_banks-1));
+		 [this](const MemCrossBar::ReqType& req) {
+			return this->bank_index(req.addr);
 		});
 		for (uint32_t i = 0; i < config.num_reqs; ++i) {
 			simobject->Inputs.at(i).bind(&mem_xbar_->ReqIn.at(i));
 			mem_xbar_->RspIn.at(i).bind(&simobject->Outputs.at(i));
 		}
+		// wake up on bank requests
+		for (auto& req_out : mem_xbar_->ReqOut) {
+			req_out.set_listener(simobject);
+		}
 	}
 
 	virtual ~Impl() {}
@@ -74,6 +106,55 @@ public:
 		ram_.write(data, l_addr, size);
 	}
 
+	uint32_t bank_index(uint64_t addr) const {
+		uint64_t word = addr >> lg2_line_size_;
+		if (bank_hash_ == BankHash::Xor) {
+			// swizzle strided accesses across banks
+			word ^= (word >> config_.B);
+		}
+		return (uint32_t)(word & ((1 << config_.B) - 1));
+	}
+
+	void profile(uint64_t PC, const LsuReq& req) {
+		// count the distinct words requested from each bank,
+		// lanes reading the same word are not counted as conflicts
+		uint32_t num_lanes = req.mask.size();
+		assert(num_lanes <= NUM_LSU_LANES);
+		uint64_t words[NUM_LSU_LANES];
+		uint32_t banks[NUM_LSU_LANES];
+		uint32_t count = 0;
+		uint32_t ways = 0;
+		for (uint32_t i = 0; i < num_lanes; ++i) {
+			if (!req.mask.test(i))
+				continue;
+			auto addr = req.addrs.at(i);
+			if (get_addr_type(addr) != AddrType::Shared)
+				continue;
+			uint64_t word = addr >> lg2_line_size_;
+			uint32_t bank = this->bank_index(addr);
+			uint32_t bank_words = 1;
+			bool duplicate = false;
+			for (uint32_t j = 0; j < count; ++j) {
+				if (banks[j] != bank)
+					continue;
+				if (words[j] == word) {
+					duplicate = true;
+					break;
+				}
+				++bank_words;
+			}
+			if (duplicate)
+				continue;
+			words[count] = word;
+			banks[count] = bank;
+			++count;
+			ways = std::max(ways, bank_words);
+		}
+		if (count != 0) {
+			LmemProfile::instance().record(PC, ways);
+		}
+	}
+
 	void tick() {
 		// process bank requets from xbar
 		uint32_t num_banks = (1 << config_.B);
@@ -100,6 +181,14 @@ public:
 		}
 	}
 
+	SimActivity activity() const {
+		for (auto& xbar_req_out : mem_xbar_->ReqOut) {
+			if (!xbar_req_out.empty())
+				return SimActivity::Busy;
+		}
+		return SimActivity::Idle;
+	}
+
 	const PerfStats& perf_stats() const {
 		perf_stats_.bank_stalls = mem_xbar_->collisions();
 		return perf_stats_;
@@ -131,10 +220,60 @@ void LocalMem::write(const void* data, uint64_t addr, uint32_t size) {
   impl_->write(data, addr, size);
 }
 
+uint32_t LocalMem::bank_index(uint64_t addr) const {
+  return impl_->bank_index(addr);
+}
+
+void LocalMem::profile(uint64_t PC, const LsuReq& req) {
+  if (!LmemProfile::instance().enabled())
+    return;
+  impl_->profile(PC, req);
+}
+
 void LocalMem::tick() {
   impl_->tick();
 }
 
+SimActivity LocalMem::activity() const {
+  return impl_->activity();
+}
+
 const LocalMem::PerfStats& LocalMem::perf_stats() const {
   return impl_->perf_stats();
-}
\ No newline at end of file
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+LmemProfile::LmemProfile() {
+  auto filename = getenv("VORTEX_LMEM_PROFILE");
+  if (filename != nullptr) {
+    filename_ = filename;
+  }
+}
+
+LmemProfile::~LmemProfile() {
+  if (filename_.empty())
+    return;
+  std::ofstream ofs(filename_);
+  if (!ofs) {
+    std::cerr << "Error: failed to open local memory profile file: " << filename_ << std::endl;
+    return;
+  }
+  // sort by PC
+  std::map<uint64_t, pc_stats_t> sorted(stats_.begin(), stats_.end());
+  ofs << "PC,requests,conflicts,max_ways" << std::endl;
+  for (auto& it : sorted) {
+    ofs << "0x" << std::hex << it.first << std::dec << ","
+        << it.second.requests << ","
+        << it.second.conflicts << ","
+        << it.second.max_ways << std::endl;
+  }
+}
+
+void LmemProfile::record(uint64_t PC, uint32_t ways) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& stats = stats_[PC];
+  stats.requests += 1;
+  stats.conflicts += ways - 1;
+  stats.max_ways = std::max(stats.max_ways, ways);
+}
@@ -14,6 +14,9 @@
 #pragma once
 
 #include <simobject.h>
+#include <string>
+#include <unordered_map>
+#include <mutex>
 #include "types.h"
 
 namespace vortex {
@@ -59,8 +62,16 @@ public:
 
   void write(const void* data, uint64_t addr, uint32_t size);
 
+  // bank servicing a given address
+  uint32_t bank_index(uint64_t addr) const;
+
+  // record the bank conflicts of a multi-lane request into the per-PC profile
+  void profile(uint64_t PC, const LsuReq& req);
+
   void tick();
 
+  SimActivity activity() const;
+
   const PerfStats& perf_stats() const;
 
 protected:
@@ -69,4 +80,36 @@ protected:
   Impl* impl_;
 };
 
+// process-wide per-PC local memory bank conflict profile,
+// enabled by setting VORTEX_LMEM_PROFILE=<file>
+class LmemProfile {
+public:
+  static LmemProfile& instance() {
+    static LmemProfile s_inst;
+    return s_inst;
+  }
+
+  bool enabled() const {
+    return !filename_.empty();
+  }
+
+  // ways: largest number of distinct words requested from a single bank
+  void record(uint64_t PC, uint32_t ways);
+
+private:
+
+  struct pc_stats_t {
+    uint64_t requests;
+    uint64_t conflicts;
+    uint32_t max_ways;
+  };
+
+  LmemProfile();
+  ~LmemProfile();
+
+  std::string filename_;
+  std::unordered_map<uint64_t, pc_stats_t> stats_;
+  std::mutex mutex_;
+};
+
 }
@@ -33,6 +33,8 @@ MemCoalescer::MemCoalescer(
   , output_ratio_(input_size / output_size)
   , pending_rd_reqs_(queue_size)
   , sent_mask_(input_size)
+  , cur_mask_(input_size)
+  , rsp_mask_(input_size)
   , line_size_(line_size)
   , delay_(delay)
 {}
@@ -48,7 +50,8 @@ void MemCoalescer::tick() {
     DT(4, this->name() << "-mem-rsp: " << out_rsp);
     auto& entry = pending_rd_reqs_.at(out_rsp.tag);
 
-    BitVector<> rsp_mask(input_size_);
+    auto& rsp_mask = rsp_mask_;
+    rsp_mask.reset();
     for (uint32_t o = 0; o < output_size_; ++o) {
       if (!out_rsp.mask.test(o))
         continue;
@@ -95,10 +98,11 @@ void MemCoalescer::tick() {
 
   uint64_t addr_mask = ~uint64_t(line_size_-1);
 
-  BitVector<> out_mask(output_size_);
-  std::vector<uint64_t> out_addrs(output_size_);
+  // build the memory request in place
+  LsuReq out_req(output_size_);
 
-  BitVector<> cur_mask(input_size_);
+  auto& cur_mask = cur_mask_;
+  cur_mask.reset();
 
   for (uint32_t o = 0; o < output_size_; ++o) {
     for (uint32_t r = 0; r < output_ratio_; ++r) {
@@ -106,7 +110,7 @@ void MemCoalescer::tick() {
       if (sent_mask_.test(i) || !in_req.mask.test(i))
         continue;
 
-      uint64_t seed_addr = in_req.addrs.at(i) & addr_mask;
+      uint64_t seed_addr = in_req.addrs[i] & addr_mask;
       cur_mask.set(i);
 
       // coalesce matching requests
@@ -114,19 +118,19 @@ void MemCoalescer::tick() {
         uint32_t j = o * output_ratio_ + s;
         if (sent_mask_.test(j) || !in_req.mask.test(j))
           continue;
-        uint64_t match_addr = in_req.addrs.at(j) & addr_mask;
+        uint64_t match_addr = in_req.addrs[j] & addr_mask;
         if (match_addr == seed_addr) {
           cur_mask.set(j);
         }
       }
 
-      out_mask.set(o);
-      out_addrs.at(o) = seed_addr;
+      out_req.mask.set(o);
+      out_req.addrs[o] = seed_addr;
       break;
     }
   }
 
-  assert(!out_mask.none());
+  assert(!out_req.mask.none());
 
   uint32_t tag = 0;
   if (!in_req.write) {
@@ -135,11 +139,8 @@ void MemCoalescer::tick() {
   }
 
   // build memory request
-  LsuReq out_req{output_size_};
-  out_req.mask = out_mask;
   out_req.tag = tag;
   out_req.write = in_req.write;
-  out_req.addrs = out_addrs;
   out_req.cid = in_req.cid;
   out_req.uuid = in_req.uuid;
 
@@ -158,6 +159,12 @@ void MemCoalescer::tick() {
   }
 }
 
+SimActivity MemCoalescer::activity() const {
+  if (!RspOut.empty() || !ReqIn.empty())
+    return SimActivity::Busy;
+  return SimActivity::Idle;
+}
+
 const MemCoalescer::PerfStats& MemCoalescer::perf_stats() const {
   return perf_stats_;
 }
\ No newline at end of file
@@ -50,6 +50,8 @@ public:
 
   void tick();
 
+  SimActivity activity() const;
+
   const PerfStats& perf_stats() const;
 
 private:
@@ -65,6 +67,8 @@ private:
 
   HashTable<pending_req_t> pending_rd_reqs_;
   BitVector<> sent_mask_;
+  BitVector<> cur_mask_; // scratch masks reused across ticks
+  BitVector<> rsp_mask_;
   uint32_t line_size_;
   uint32_t delay_;
   PerfStats perf_stats_;
@@ -14,6 +14,8 @@
 #include "mem_sim.h"
 #include <vector>
 #include <queue>
+#include <string>
+#include <algorithm>
 #include <stdlib.h>
 #include <dram_sim.h>
 
@@ -23,10 +25,60 @@
 
 using namespace vortex;
 
+namespace {
+
+enum class BankHash {
+	Linear, // consecutive interleave units map to consecutive banks
+	Xor     // all unit index bits above the bank field are XOR-folded into it
+};
+
+struct bank_map_t {
+	bool     enabled;    // banks are DRAM channels, otherwise Ramulator maps the raw address
+	BankHash hash;
+	uint32_t interleave; // interleave granularity in bytes (0: block size)
+
+	// selected at runtime with VORTEX_MEM_BANK_HASH=linear|xor[:<interleave>]
+	bank_map_t() : enabled(false), hash(BankHash::Linear), interleave(0) {
+		auto env = getenv("VORTEX_MEM_BANK_HASH");
+		if (env == nullptr || env[0] == '\0')
+			return;
+		enabled = true;
+		std::string value(env);
+		auto sep = value.find(':');
+		auto name = value.substr(0, sep);
+		if (name == "linear") {
+			hash = BankHash::Linear;
+		} else if (name == "xor") {
+			hash = BankHash::Xor;
+		} else {
+			std::cerr << "Error: invalid memory bank hash: " << value << std::endl;
+			std::abort();
+		}
+		if (sep != std::string::npos) {
+			interleave = std::atoi(value.c_str() + sep + 1);
+			if (!ispow2(interleave)) {
+				std::cerr << "Error: invalid memory interleave size: " << value << std::endl;
+				std::abort();
+			}
+		}
+	}
+};
+
+const bank_map_t& bank_map() {
+	static bank_map_t s_map;
+	return s_map;
+}
+
+}
+
 class MemSim::Impl {
 private:
 	MemSim*   simobject_;
 	Config    config_;
+	bool      bank_channels_;
+	BankHash  bank_hash_;
+	uint32_t  lg2_interleave_;
+	uint32_t  lg2_num_banks_;
 	MemCrossBar::Ptr mem_xbar_;
 	DramSim   dram_sim_;
 	mutable PerfStats perf_stats_;
@@ -40,19 +92,29 @@ public:
 	Impl(MemSim* simobject, const Config& config)
 		: simobject_(simobject)
 		, config_(config)
+		, bank_channels_(bank_map().enabled)
+		, bank_hash_(bank_map().hash)
+		, lg2_interleave_(log2ceil(std::max(bank_map().interleave, config.block_size)))
+		, lg2_num_banks_(log2ceil(config.num_banks))
 		, dram_sim_(config.num_banks, config.block_size, config.clock_ratio)
 	{
+		assert(ispow2(config.num_banks));
+		perf_stats_.bank_reqs.resize(config.num_banks, 0);
+
 		char sname[100];
 		snprintf(sname, 100, "%s-xbar", simobject->name().c_str());
 		mem_xbar_ = MemCrossBar::Create(sname, ArbiterType::RoundRobin, config.num_ports, config.num_banks,
-			[lg2_block_size = log2ceil(config.block_size), num_banks = config.num_banks](const MemCrossBar::ReqType& req) {
-    	// Custom logic to calculate the output index using bank interleaving
-			return (uint32_t)((req.addr >> lg2_block_size) & (num_banks-1));
+			[this](const MemCrossBar::ReqType& req) {
+			return this->bank_index(req.addr);
 		});
 		for (uint32_t i = 0; i < config.num_ports; ++i) {
 			simobject->MemReqPorts.at(i).bind(&mem_xbar_->ReqIn.at(i));
 			mem_xbar_->RspIn.at(i).bind(&simobject->MemRspPorts.at(i));
 		}
+		// wake up on bank requests
+		for (auto& req_out : mem_xbar_->ReqOut) {
+			req_out.set_listener(simobject);
+		}
 	}
 
 	~Impl() {
@@ -61,11 +123,51 @@ public:
 
 	const PerfStats& perf_stats() const {
 		perf_stats_.bank_stalls = mem_xbar_->collisions();
+		perf_stats_.dram = dram_sim_.perf_stats();
 		return perf_stats_;
 	}
 
 	void reset() {
 		dram_sim_.reset();
+		std::fill(perf_stats_.bank_reqs.begin(), perf_stats_.bank_reqs.end(), 0);
+	}
+
+	uint32_t bank_index(uint64_t addr) const {
+		uint64_t unit = addr >> lg2_interleave_;
+		uint64_t bank = unit;
+		if (bank_hash_ == BankHash::Xor && lg2_num_banks_ != 0) {
+			// spread power-of-two strides across banks
+			for (unit >>= lg2_num_banks_; unit != 0; unit >>= lg2_num_banks_) {
+				bank ^= unit;
+			}
+		}
+		return (uint32_t)(bank & (config_.num_banks - 1));
+	}
+
+	// address within the bank's DRAM channel: the unit index without its bank field
+	// (a bijection for both hashes, since the bank field is only XOR-ed with higher bits)
+	uint64_t bank_addr(uint64_t addr) const {
+		uint64_t offset = addr & ((uint64_t(1) << lg2_interleave_) - 1);
+		uint64_t unit = addr >> lg2_interleave_;
+		return ((unit >> lg2_num_banks_) << lg2_interleave_) | offset;
+	}
+
+	SimActivity activity() const {
+		for (uint32_t i = 0; i < config_.num_banks; ++i) {
+			if (!mem_xbar_->ReqOut.at(i).empty())
+				return SimActivity::Busy;
+		}
+		// the DRAM model must keep ticking until its responses are out
+		return dram_sim_.busy() ? SimActivity::Background : SimActivity::Idle;
+	}
+
+	void skip(uint64_t cycles) {
+		// no request can arrive, step the DRAM model until its responses are out
+		while (cycles != 0 && dram_sim_.busy()) {
+			dram_sim_.tick();
+			--cycles;
+		}
+		dram_sim_.skip(cycles);
 	}
 
 	void tick() {
@@ -76,26 +178,29 @@ public:
 				continue;
 
 			auto& mem_req = mem_xbar_->ReqOut.at(i).front();
+			assert(this->bank_index(mem_req.addr) == i);
 
-			// enqueue the request to the memory system
+			// enqueue the request to the memory system,
+			// with bank mapping enabled, the crossbar port selects the DRAM channel
 			auto req_args = new DramCallbackArgs{this, mem_req, i};
-			dram_sim_.send_request(
-				mem_req.addr,
-				mem_req.write,
-				[](void* arg) {
-					auto rsp_args = reinterpret_cast<const DramCallbackArgs*>(arg);
-					if (!rsp_args->request.write) {
-						// only send a response for read requests
-						MemRsp mem_rsp{rsp_args->request.tag, rsp_args->request.cid, rsp_args->request.uuid};
-						rsp_args->memsim->mem_xbar_->RspOut.at(rsp_args->bank_id).push(mem_rsp, 1);
-						DT(3, rsp_args->memsim->simobject_->name() << "-mem-rsp" << rsp_args->bank_id << ": " << mem_rsp);
-					}
-					delete rsp_args;
-				},
-				req_args
-			);
+			auto rsp_cb = [](void* arg) {
+				auto rsp_args = reinterpret_cast<const DramCallbackArgs*>(arg);
+				if (!rsp_args->request.write) {
+					// only send a response for read requests
+					MemRsp mem_rsp{rsp_args->request.tag, rsp_args->request.cid, rsp_args->request.uuid};
+					rsp_args->memsim->mem_xbar_->RspOut.at(rsp_args->bank_id).push(mem_rsp, 1);
+					DT(3, rsp_args->memsim->simobject_->name() << "-mem-rsp" << rsp_args->bank_id << ": " << mem_rsp);
+				}
+				delete rsp_args;
+			};
+			if (bank_channels_) {
+				dram_sim_.send_request(i, this->bank_addr(mem_req.addr), mem_req.write, rsp_cb, req_args);
+			} else {
+				dram_sim_.send_request(mem_req.addr, mem_req.write, rsp_cb, req_args);
+			}
 
 			DT(3, simobject_->name() << "-mem-req" << i << ": " << mem_req);
+			++perf_stats_.bank_reqs.at(i);
 			mem_xbar_->ReqOut.at(i).pop();
 		}
 	}
@@ -122,6 +227,18 @@ void MemSim::tick() {
   impl_->tick();
 }
 
+uint32_t MemSim::bank_index(uint64_t addr) const {
+	return impl_->bank_index(addr);
+}
+
+SimActivity MemSim::activity() const {
+  return impl_->activity();
+}
+
+void MemSim::skip(uint64_t cycles) {
+  impl_->skip(cycles);
+}
+
 const MemSim::PerfStats &MemSim::perf_stats() const {
 	return impl_->perf_stats();
 }
\ No newline at end of file
@@ -14,6 +14,7 @@
 #pragma once
 
 #include <simobject.h>
+#include <dram_sim.h>
 #include "types.h"
 
 namespace vortex {
@@ -29,6 +30,8 @@ public:
 
 	struct PerfStats {
 		uint64_t bank_stalls;
+		std::vector<uint64_t> bank_reqs; // requests per bank
+		DramSim::PerfStats dram;
 
 		PerfStats()
 			: bank_stalls(0)
@@ -36,6 +39,13 @@ public:
 
 		PerfStats& operator+=(const PerfStats& rhs) {
 			this->bank_stalls += rhs.bank_stalls;
+			if (this->bank_reqs.size() < rhs.bank_reqs.size()) {
+				this->bank_reqs.resize(rhs.bank_reqs.size(), 0);
+			}
+			for (size_t i = 0; i < rhs.bank_reqs.size(); ++i) {
+				this->bank_reqs[i] += rhs.bank_reqs[i];
+			}
+			this->dram += rhs.dram;
 			return *this;
 		}
 	};
@@ -50,6 +60,13 @@ public:
 
 	void tick();
 
+	// bank servicing a given address
+	uint32_t bank_index(uint64_t addr) const;
+
+	SimActivity activity() const;
+
+	void skip(uint64_t cycles);
+
 	const PerfStats& perf_stats() const;
 
 private:
@@ -31,6 +31,10 @@ public:
 
   virtual void tick();
 
+  SimActivity activity() const {
+    return Input.empty() ? SimActivity::Idle : SimActivity::Busy;
+  }
+
   void writeback(instr_trace_t* trace);
 
   uint32_t total_stalls() const {
@@ -67,6 +67,12 @@ void Operands::tick() {
   }
 }
 
+SimActivity Operands::activity() const {
+  if (NUM_OPCS < 2)
+    return SimActivity::Idle; // pass-thru
+  return Input.empty() ? SimActivity::Idle : SimActivity::Busy;
+}
+
 uint32_t Operands::total_stalls() const {
   uint32_t total = 0;
   for (const auto& opc_unit : opc_units_) {
@@ -33,6 +33,8 @@ public:
 
   virtual void tick();
 
+  SimActivity activity() const;
+
   void writeback(instr_trace_t* trace);
 
   uint32_t total_stalls() const;
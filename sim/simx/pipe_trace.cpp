@@ -0,0 +1,83 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pipe_trace.h"
+#include <iostream>
+
+using namespace vortex;
+
+static constexpr size_t PIPE_TRACE_BUFFER_SIZE = 65536;
+
+static bool is_gzip_file(const std::string& filename) {
+  auto n = filename.size();
+  return n > 3 && filename.compare(n - 3, 3, ".gz") == 0;
+}
+
+static FILE* open_file(const std::string& filename, bool write, bool* piped) {
+  if (is_gzip_file(filename)) {
+    auto cmd = (write ? "gzip -c > '" : "gzip -dc '") + filename + "'";
+    *piped = true;
+    return popen(cmd.c_str(), write ? "w" : "r");
+  }
+  *piped = false;
+  return fopen(filename.c_str(), write ? "wb" : "rb");
+}
+
+FILE* vortex::pipe_trace_open(const std::string& filename, bool* piped) {
+  return open_file(filename, false, piped);
+}
+
+void vortex::pipe_trace_close(FILE* file, bool piped) {
+  if (piped) {
+    pclose(file);
+  } else {
+    fclose(file);
+  }
+}
+
+PipeTrace::PipeTrace(const std::string& filename, uint32_t device)
+  : size_(0)
+  , device_(device)
+  , file_(nullptr)
+  , piped_(false) {
+  if (filename.empty())
+    return;
+  file_ = open_file(filename, true, &piped_);
+  if (file_ == nullptr) {
+    std::cerr << "Error: failed to open pipeline trace file: " << filename << std::endl;
+    return;
+  }
+  pipe_trace_header_t header;
+  header.magic = PIPE_TRACE_MAGIC;
+  header.version = PIPE_TRACE_VERSION;
+  header.record_size = sizeof(pipe_trace_record_t);
+  fwrite(&header, sizeof(header), 1, file_);
+  buffer_.resize(PIPE_TRACE_BUFFER_SIZE);
+}
+
+PipeTrace::~PipeTrace() {
+  if (file_ == nullptr)
+    return;
+  this->flush();
+  pipe_trace_close(file_, piped_);
+}
+
+void PipeTrace::flush() {
+  if (file_ == nullptr)
+    return;
+  if (size_ != 0) {
+    fwrite(buffer_.data(), sizeof(pipe_trace_record_t), size_, file_);
+    size_ = 0;
+  }
+  fflush(file_);
+}
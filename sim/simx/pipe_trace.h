@@ -0,0 +1,121 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include <string>
+
+namespace vortex {
+
+// Binary pipeline trace.
+// The file starts with a pipe_trace_header_t followed by a stream of
+// fixed-size pipe_trace_record_t entries, one per instruction stage event.
+// Files with a ".gz" extension are piped through gzip.
+
+#define PIPE_TRACE_MAGIC   0x54505856 // "VXPT"
+#define PIPE_TRACE_VERSION 2
+
+enum class PipeStage : uint8_t {
+  Schedule = 0,
+  Decode,
+  IBuffer,
+  Dispatch,
+  Commit,
+  Count
+};
+
+inline const char* pipe_stage_name(PipeStage stage) {
+  switch (stage) {
+  case PipeStage::Schedule: return "schedule";
+  case PipeStage::Decode:   return "decode";
+  case PipeStage::IBuffer:  return "ibuffer";
+  case PipeStage::Dispatch: return "dispatch";
+  case PipeStage::Commit:   return "commit";
+  default: return "?";
+  }
+}
+
+struct pipe_trace_header_t {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t record_size;
+};
+
+struct pipe_trace_record_t {
+  uint64_t uuid;
+  uint64_t PC;
+  uint64_t cycle;
+  uint16_t device;
+  uint16_t cid;
+  uint16_t wid;
+  uint8_t  stage;
+  uint8_t  flags; // bit0: sop, bit1: eop
+};
+
+static_assert(sizeof(pipe_trace_record_t) == 32, "invalid record size");
+
+// per-device trace writer, enabled by setting VORTEX_PIPE_TRACE=<file>
+// (each device simulates on a single thread and buffers its own records)
+class PipeTrace {
+public:
+  PipeTrace(const std::string& filename, uint32_t device);
+  ~PipeTrace();
+
+  bool enabled() const {
+    return file_ != nullptr;
+  }
+
+  void log(PipeStage stage, uint64_t uuid, uint64_t PC, uint64_t cycle,
+           uint32_t cid, uint32_t wid, bool sop, bool eop) {
+    auto& rec = buffer_[size_];
+    rec.uuid   = uuid;
+    rec.PC     = PC;
+    rec.cycle  = cycle;
+    rec.device = device_;
+    rec.cid    = cid;
+    rec.wid    = wid;
+    rec.stage  = (uint8_t)stage;
+    rec.flags  = (sop ? 0x1 : 0) | (eop ? 0x2 : 0);
+    if (++size_ == buffer_.size()) {
+      this->flush();
+    }
+  }
+
+  void flush();
+
+private:
+
+  std::vector<pipe_trace_record_t> buffer_;
+  size_t size_;
+  uint32_t device_;
+  FILE* file_;
+  bool piped_;
+};
+
+// open a trace file for reading (handles gzip-compressed files)
+FILE* pipe_trace_open(const std::string& filename, bool* piped);
+
+void pipe_trace_close(FILE* file, bool piped);
+
+}
+
+#define PT(pipe_trace, stage, trace) do { \
+  auto& pt_writer = (pipe_trace); \
+  if (pt_writer.enabled()) { \
+    pt_writer.log(stage, (trace)->uuid, (trace)->PC, SimPlatform::current().cycles(), \
+                  (trace)->cid, (trace)->wid, (trace)->sop, (trace)->eop); \
+  } \
+} while(0)
@@ -13,14 +13,96 @@
 
 #include "processor.h"
 #include "processor_impl.h"
+#include "pipe_trace.h"
+#include <iostream>
+#include <sstream>
+#include <stdlib.h>
 
 using namespace vortex;
 
-ProcessorImpl::ProcessorImpl(const Arch& arch)
-  : arch_(arch)
+namespace {
+
+// device-wide counters available to the perf timeline
+enum {
+  TL_INSTRS,
+  TL_SCHED_IDLE,
+  TL_SCHED_STALLS,
+  TL_IBUF_STALLS,
+  TL_SCRB_STALLS,
+  TL_OPDS_STALLS,
+  TL_IFETCHES,
+  TL_LOADS,
+  TL_STORES,
+  TL_IFETCH_LATENCY,
+  TL_LOAD_LATENCY,
+  TL_ICACHE_READS,
+  TL_ICACHE_MISSES,
+  TL_DCACHE_READS,
+  TL_DCACHE_WRITES,
+  TL_DCACHE_MISSES,
+  TL_L2_READS,
+  TL_L2_WRITES,
+  TL_L2_MISSES,
+  TL_L3_READS,
+  TL_L3_WRITES,
+  TL_L3_MISSES,
+  TL_MEM_READS,
+  TL_MEM_WRITES,
+  TL_MEM_LATENCY,
+  TL_COUNT
+};
+
+const char* const timeline_names[TL_COUNT] = {
+  "instrs",
+  "sched_idle",
+  "sched_stalls",
+  "ibuf_stalls",
+  "scrb_stalls",
+  "opds_stalls",
+  "ifetches",
+  "loads",
+  "stores",
+  "ifetch_latency",
+  "load_latency",
+  "icache_reads",
+  "icache_misses",
+  "dcache_reads",
+  "dcache_writes",
+  "dcache_misses",
+  "l2_reads",
+  "l2_writes",
+  "l2_misses",
+  "l3_reads",
+  "l3_writes",
+  "l3_misses",
+  "mem_reads",
+  "mem_writes",
+  "mem_latency"
+};
+
+// each device writes its own pipeline trace file
+std::string pipe_trace_path(uint32_t device_id) {
+  auto env = getenv("VORTEX_PIPE_TRACE");
+  if (env == nullptr || env[0] == '\0')
+    return std::string();
+  return device_file_path(env, device_id);
+}
+
+}
+
+ProcessorImpl::ProcessorImpl(const Arch& arch, uint32_t device_id)
+  : platform_(device_id)
+  , pipe_trace_(pipe_trace_path(device_id), device_id)
+  , arch_(arch)
   , clusters_(arch.num_clusters())
+  , warm_start_(false)
+  , timeline_interval_(0)
+  , timeline_next_(0)
+  , timeline_cycles_(0)
+  , timeline_runs_(0)
 {
-  SimPlatform::instance().initialize();
+  // objects created below belong to this device's platform
+  SimPlatform::Scope scope(&platform_);
 
 	assert(PLATFORM_MEMORY_DATA_SIZE == MEM_BLOCK_SIZE);
 
@@ -97,19 +179,27 @@ ProcessorImpl::ProcessorImpl(const Arch& arch)
 #endif
   // reset the device
   this->reset();
+
+  this->open_timeline();
 }
 
 ProcessorImpl::~ProcessorImpl() {
-  SimPlatform::instance().finalize();
+  SimPlatform::Scope scope(&platform_);
+  clusters_.clear();
+  memsim_ = nullptr;
+  l3cache_ = nullptr;
+  platform_.finalize();
 }
 
 void ProcessorImpl::attach_ram(RAM* ram) {
+  SimPlatform::Scope scope(&platform_);
   for (auto cluster : clusters_) {
     cluster->attach_ram(ram);
   }
 }
 #ifdef VM_ENABLE
 void ProcessorImpl::set_satp(uint64_t satp) {
+  SimPlatform::Scope scope(&platform_);
   for (auto cluster : clusters_) {
     cluster->set_satp(satp);
   }
@@ -117,13 +207,32 @@ void ProcessorImpl::set_satp(uint64_t satp) {
 #endif
 
 int ProcessorImpl::run() {
-  SimPlatform::instance().reset();
+  SimPlatform::Scope scope(&platform_);
+  platform_.reset();
   this->reset();
 
+  // the caches pay their initialization pass, unless the launch is warm;
+  // their lines are only dropped by invalidate_caches()
+  if (!warm_start_) {
+    platform_.for_each<CacheSim>([](CacheSim* cache) {
+      cache->init();
+    });
+  }
+
+  if (timeline_.is_open()) {
+    // counters restart with each run
+    timeline_last_.assign(TL_COUNT, 0);
+    timeline_cycles_ = 0;
+    timeline_next_ = timeline_interval_;
+    ++timeline_runs_;
+  }
+
   bool done;
   int exitcode = 0;
   do {
-    SimPlatform::instance().tick();
+    // the platform may fast-forward idle cycles
+    auto cycles = platform_.cycles();
+    platform_.tick();
     done = true;
     for (auto cluster : clusters_) {
       if (cluster->running()) {
@@ -132,9 +241,41 @@ int ProcessorImpl::run() {
       }
       exitcode |= cluster->get_exitcode();
     }
-    perf_mem_latency_ += perf_mem_pending_reads_;
+    perf_mem_latency_ += perf_mem_pending_reads_ * (platform_.cycles() - cycles);
+    if (timeline_.is_open() && platform_.cycles() >= timeline_next_) {
+      this->dump_timeline();
+    }
   } while (!done);
 
+  // credit sleeping objects before their statistics are read
+  platform_.sync();
+
+  if (timeline_.is_open()) {
+    if (platform_.cycles() != timeline_cycles_) {
+      this->dump_timeline();
+    }
+    timeline_.flush();
+  }
+
+  pipe_trace_.flush();
+
+  auto bank_stats = getenv("VORTEX_MEM_BANK_STATS");
+  if (bank_stats != nullptr && bank_stats[0] != '\0' && bank_stats[0] != '0') {
+    auto& memsim_stats = memsim_->perf_stats();
+    auto& bank_reqs = memsim_stats.bank_reqs;
+    uint64_t total = 0;
+    for (auto reqs : bank_reqs) {
+      total += reqs;
+    }
+    std::cout << "PERF: memory bank requests:";
+    for (uint32_t i = 0; i < bank_reqs.size(); ++i) {
+      int pct = total ? int((100 * bank_reqs.at(i)) / total) : 0;
+      std::cout << " bank" << i << "=" << bank_reqs.at(i) << " (" << pct << "%)";
+    }
+    // banks are DRAM channels, unless the DRAM address mapper moves the channel bits
+    std::cout << ", channel_mismatches=" << memsim_stats.dram.channel_mismatches << std::endl;
+  }
+
   return exitcode;
 }
 
@@ -145,10 +286,125 @@ void ProcessorImpl::reset() {
   perf_mem_pending_reads_ = 0;
 }
 
+void ProcessorImpl::open_timeline() {
+  auto env = getenv("VORTEX_PERF_TIMELINE");
+  if (env == nullptr || env[0] == '\0')
+    return;
+  std::string value(env);
+  auto sep = value.find(':');
+  // each device writes its own file
+  auto filename = device_file_path(value.substr(0, sep), platform_.id());
+  timeline_interval_ = 1000;
+  if (sep != std::string::npos) {
+    auto sep2 = value.find(':', sep + 1);
+    timeline_interval_ = std::max<int64_t>(1, std::atoll(value.substr(sep + 1, sep2 - sep - 1).c_str()));
+    if (sep2 != std::string::npos) {
+      // comma-separated subset of the counters
+      std::stringstream ss(value.substr(sep2 + 1));
+      std::string name;
+      while (std::getline(ss, name, ',')) {
+        auto it = std::find(std::begin(timeline_names), std::end(timeline_names), name);
+        if (it == std::end(timeline_names)) {
+          std::cerr << "Error: unknown perf timeline counter: " << name << std::endl;
+          continue;
+        }
+        timeline_counters_.push_back(it - std::begin(timeline_names));
+      }
+    }
+  }
+  if (timeline_counters_.empty()) {
+    for (uint32_t i = 0; i < TL_COUNT; ++i) {
+      timeline_counters_.push_back(i);
+    }
+  }
+  timeline_.open(filename);
+  if (!timeline_) {
+    std::cerr << "Error: failed to open perf timeline file: " << filename << std::endl;
+    return;
+  }
+  timeline_ << "run,cycle,cycles";
+  for (auto id : timeline_counters_) {
+    timeline_ << "," << timeline_names[id];
+  }
+  timeline_ << std::endl;
+}
+
+void ProcessorImpl::sample_counters(std::vector<uint64_t>& values) {
+  values.assign(TL_COUNT, 0);
+  platform_.for_each<Core>([&](Core* core) {
+    auto& perf = core->perf_stats();
+    values[TL_INSTRS]         += perf.instrs;
+    values[TL_SCHED_IDLE]     += perf.sched_idle;
+    values[TL_SCHED_STALLS]   += perf.sched_stalls;
+    values[TL_IBUF_STALLS]    += perf.ibuf_stalls;
+    values[TL_SCRB_STALLS]    += perf.scrb_stalls;
+    values[TL_OPDS_STALLS]    += perf.opds_stalls;
+    values[TL_IFETCHES]       += perf.ifetches;
+    values[TL_LOADS]          += perf.loads;
+    values[TL_STORES]         += perf.stores;
+    values[TL_IFETCH_LATENCY] += perf.ifetch_latency;
+    values[TL_LOAD_LATENCY]   += perf.load_latency;
+  });
+  platform_.for_each<Socket>([&](Socket* socket) {
+    auto perf = socket->perf_stats();
+    values[TL_ICACHE_READS]  += perf.icache.reads;
+    values[TL_ICACHE_MISSES] += perf.icache.read_misses;
+    values[TL_DCACHE_READS]  += perf.dcache.reads;
+    values[TL_DCACHE_WRITES] += perf.dcache.writes;
+    values[TL_DCACHE_MISSES] += perf.dcache.read_misses + perf.dcache.write_misses;
+  });
+  for (auto cluster : clusters_) {
+    auto perf = cluster->perf_stats();
+    values[TL_L2_READS]  += perf.l2cache.reads;
+    values[TL_L2_WRITES] += perf.l2cache.writes;
+    values[TL_L2_MISSES] += perf.l2cache.read_misses + perf.l2cache.write_misses;
+  }
+  auto l3perf = l3cache_->perf_stats();
+  values[TL_L3_READS]    = l3perf.reads;
+  values[TL_L3_WRITES]   = l3perf.writes;
+  values[TL_L3_MISSES]   = l3perf.read_misses + l3perf.write_misses;
+  values[TL_MEM_READS]   = perf_mem_reads_;
+  values[TL_MEM_WRITES]  = perf_mem_writes_;
+  values[TL_MEM_LATENCY] = perf_mem_latency_;
+}
+
+void ProcessorImpl::dump_timeline() {
+  // one row per interval, with counts relative to the previous row
+  std::vector<uint64_t> values;
+  platform_.sync();
+  this->sample_counters(values);
+  auto cycles = platform_.cycles();
+  timeline_ << timeline_runs_ << "," << cycles << "," << (cycles - timeline_cycles_);
+  for (auto id : timeline_counters_) {
+    timeline_ << "," << (values[id] - timeline_last_[id]);
+  }
+  timeline_ << "\n";
+  timeline_last_ = values;
+  timeline_cycles_ = cycles;
+  // idle-cycle skipping may jump over several intervals
+  timeline_next_ = (cycles / timeline_interval_ + 1) * timeline_interval_;
+}
+
 void ProcessorImpl::dcr_write(uint32_t addr, uint32_t value) {
+  SimPlatform::Scope scope(&platform_);
   dcrs_.write(addr, value);
 }
 
+void ProcessorImpl::set_startup(uint64_t addr, uint64_t arg) {
+  dcrs_.set_startup(addr, arg);
+}
+
+void ProcessorImpl::set_warm_start(bool enable) {
+  warm_start_ = enable;
+}
+
+void ProcessorImpl::invalidate_caches() {
+  SimPlatform::Scope scope(&platform_);
+  platform_.for_each<CacheSim>([](CacheSim* cache) {
+    cache->invalidate();
+  });
+}
+
 ProcessorImpl::PerfStats ProcessorImpl::perf_stats() const {
   ProcessorImpl::PerfStats perf;
   perf.mem_reads   = perf_mem_reads_;
@@ -161,8 +417,8 @@ ProcessorImpl::PerfStats ProcessorImpl::perf_stats() const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-Processor::Processor(const Arch& arch)
-  : impl_(new ProcessorImpl(arch))
+Processor::Processor(const Arch& arch, uint32_t device_id)
+  : impl_(new ProcessorImpl(arch, device_id))
 {
 #ifdef VM_ENABLE
   satp_ = NULL;
@@ -196,6 +452,18 @@ void Processor::dcr_write(uint32_t addr, uint32_t value) {
   return impl_->dcr_write(addr, value);
 }
 
+void Processor::set_startup(uint64_t addr, uint64_t arg) {
+  impl_->set_startup(addr, arg);
+}
+
+void Processor::set_warm_start(bool enable) {
+  impl_->set_warm_start(enable);
+}
+
+void Processor::invalidate_caches() {
+  impl_->invalidate_caches();
+}
+
 #ifdef VM_ENABLE
 int16_t Processor::set_satp_by_addr(uint64_t base_addr) {
   uint16_t asid = 0;
@@ -217,4 +485,9 @@ uint64_t Processor::get_base_ppn() {
   assert (satp_!=NULL);
   return satp_->get_base_ppn();
 }
+void Processor::tlb_flush() {
+  // rewriting satp flushes the cores' TLBs
+  assert (satp_!=NULL);
+  impl_->set_satp(satp_->get_satp());
+}
 #endif
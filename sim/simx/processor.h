@@ -28,7 +28,8 @@ class SATP_t;
 
 class Processor {
 public:
-  Processor(const Arch& arch);
+  // device_id tells apart the output files of devices in the same process
+  Processor(const Arch& arch, uint32_t device_id = 0);
   ~Processor();
 
   void attach_ram(RAM* mem);
@@ -36,11 +37,21 @@ public:
   int run();
 
   void dcr_write(uint32_t addr, uint32_t value);
+
+  // write the startup address and argument registers at once
+  void set_startup(uint64_t addr, uint64_t arg);
+
+  // skip the cache initialization pass of the next runs
+  void set_warm_start(bool enable);
+
+  // drop cache contents before the next run
+  void invalidate_caches();
 #ifdef VM_ENABLE
   bool is_satp_unset();
   uint8_t get_satp_mode();
   uint64_t get_base_ppn();
   int16_t set_satp_by_addr(uint64_t addr);
+  void tlb_flush();
 #endif
 
 private:
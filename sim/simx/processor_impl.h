@@ -18,6 +18,8 @@
 #include "constants.h"
 #include "dcrs.h"
 #include "cluster.h"
+#include "pipe_trace.h"
+#include <fstream>
 
 namespace vortex {
 
@@ -31,7 +33,7 @@ public:
     uint64_t mem_latency;
   };
 
-  ProcessorImpl(const Arch& arch);
+  ProcessorImpl(const Arch& arch, uint32_t device_id);
   ~ProcessorImpl();
 
   void attach_ram(RAM* mem);
@@ -40,16 +42,34 @@ public:
 
   void dcr_write(uint32_t addr, uint32_t value);
 
+  void set_startup(uint64_t addr, uint64_t arg);
+
+  void set_warm_start(bool enable);
+
+  void invalidate_caches();
+
 #ifdef VM_ENABLE
   void set_satp(uint64_t satp);
 #endif
 
   PerfStats perf_stats() const;
 
+  PipeTrace& pipe_trace() {
+    return pipe_trace_;
+  }
+
 private:
 
   void reset();
 
+  void open_timeline();
+
+  void sample_counters(std::vector<uint64_t>& values);
+
+  void dump_timeline();
+
+  SimPlatform platform_; // declared first, released last
+  PipeTrace pipe_trace_;  // written by the cores, created before them
   const Arch& arch_;
   std::vector<std::shared_ptr<Cluster>> clusters_;
   DCRS dcrs_;
@@ -59,6 +79,16 @@ private:
   uint64_t perf_mem_writes_;
   uint64_t perf_mem_latency_;
   uint64_t perf_mem_pending_reads_;
+  bool warm_start_;
+
+  // counter time series, enabled with VORTEX_PERF_TIMELINE=<file>[:<interval>[:<counters>]]
+  std::ofstream timeline_;
+  uint64_t timeline_interval_;
+  uint64_t timeline_next_;
+  uint64_t timeline_cycles_;
+  uint32_t timeline_runs_;
+  std::vector<uint32_t> timeline_counters_;
+  std::vector<uint64_t> timeline_last_;
 };
 
 }
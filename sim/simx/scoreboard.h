@@ -14,7 +14,7 @@
 #pragma once
 
 #include "instr_trace.h"
-#include <unordered_map>
+#include <algorithm>
 #include <vector>
 
 namespace vortex {
@@ -30,33 +30,32 @@ public:
 		uint64_t uuid;
 	};
 
+	// maximum number of conflicts reported by get_uses()
+	static constexpr uint32_t MAX_USES = NUM_SRC_REGS + 1;
+
 	Scoreboard(const Arch &arch)
-	: in_use_regs_(arch.num_warps()) {
-		for (auto& in_use_reg : in_use_regs_) {
-			in_use_reg.resize((int)RegType::Count);
-		}
+	: in_use_regs_(arch.num_warps() * (int)RegType::Count)
+	, owners_(arch.num_warps() * (int)RegType::Count * MAX_NUM_REGS, nullptr) {
 		this->reset();
 	}
 
 	void reset() {
-		for (auto& in_use_reg : in_use_regs_) {
-			for (auto& mask : in_use_reg) {
-				mask.reset();
-			}
+		for (auto& mask : in_use_regs_) {
+			mask.reset();
 		}
-		owners_.clear();
+		std::fill(owners_.begin(), owners_.end(), nullptr);
 	}
 
 	bool in_use(instr_trace_t* trace) const {
 		if (trace->wb) {
 			assert(trace->dst_reg.type != RegType::None);
-			if (in_use_regs_.at(trace->wid).at((int)trace->dst_reg.type).test(trace->dst_reg.idx)) {
+			if (this->test(trace->dst_reg, trace->wid)) {
 				return true;
 			}
 		}
 		for (uint32_t i = 0; i < trace->src_regs.size(); ++i) {
 			if (trace->src_regs[i].type != RegType::None) {
-				if (in_use_regs_.at(trace->wid).at((int)trace->src_regs[i].type).test(trace->src_regs[i].idx)) {
+				if (this->test(trace->src_regs[i], trace->wid)) {
 					return true;
 				}
 			}
@@ -64,53 +63,64 @@ public:
 		return false;
 	}
 
-	std::vector<reg_use_t> get_uses(instr_trace_t* trace) const {
-		std::vector<reg_use_t> out;
+	// fill out (MAX_USES entries) with the conflicting registers, returns their count
+	uint32_t get_uses(instr_trace_t* trace, reg_use_t* out) const {
+		uint32_t count = 0;
 		if (trace->wb) {
 			assert(trace->dst_reg.type != RegType::None);
-			if (in_use_regs_.at(trace->wid).at((int)trace->dst_reg.type).test(trace->dst_reg.idx)) {
-				uint32_t reg_id = get_reg_id(trace->dst_reg, trace->wid);
-				auto owner = owners_.at(reg_id);
-				out.push_back({trace->dst_reg.type, trace->dst_reg.idx, owner->fu_type, owner->op_type, owner->uuid});
+			if (this->test(trace->dst_reg, trace->wid)) {
+				auto owner = owners_[get_reg_index(trace->dst_reg, trace->wid)];
+				assert(owner != nullptr);
+				out[count++] = {trace->dst_reg.type, trace->dst_reg.idx, owner->fu_type, owner->op_type, owner->uuid};
 			}
 		}
 		for (uint32_t i = 0; i < trace->src_regs.size(); ++i) {
 			if (trace->src_regs[i].type != RegType::None) {
-				if (in_use_regs_.at(trace->wid).at((int)trace->src_regs[i].type).test(trace->src_regs[i].idx)) {
-					uint32_t reg_id = get_reg_id(trace->src_regs[i], trace->wid);
-					auto owner = owners_.at(reg_id);
-					out.push_back({trace->src_regs[i].type, trace->src_regs[i].idx, owner->fu_type, owner->op_type, owner->uuid});
+				if (this->test(trace->src_regs[i], trace->wid)) {
+					auto owner = owners_[get_reg_index(trace->src_regs[i], trace->wid)];
+					assert(owner != nullptr);
+					out[count++] = {trace->src_regs[i].type, trace->src_regs[i].idx, owner->fu_type, owner->op_type, owner->uuid};
 				}
 			}
 		}
-		return out;
+		assert(count <= MAX_USES);
+		return count;
 	}
 
 	void reserve(instr_trace_t* trace) {
-		uint32_t reg_id = get_reg_id(trace->dst_reg, trace->wid);
 		assert(trace->wb);
-		in_use_regs_.at(trace->wid).at((int)trace->dst_reg.type).set(trace->dst_reg.idx);
-		assert(owners_.count(reg_id) == 0);
-		owners_[reg_id] = trace;
+		auto& owner = owners_[get_reg_index(trace->dst_reg, trace->wid)];
+		in_use_regs_[get_mask_index(trace->dst_reg, trace->wid)].set(trace->dst_reg.idx);
+		assert(owner == nullptr);
+		owner = trace;
 	}
 
 	void release(instr_trace_t* trace) {
-		uint32_t reg_id = get_reg_id(trace->dst_reg, trace->wid);
 		assert(trace->wb);
-		assert(in_use_regs_.at(trace->wid).at((int)trace->dst_reg.type).test(trace->dst_reg.idx));
-		in_use_regs_.at(trace->wid).at((int)trace->dst_reg.type).reset(trace->dst_reg.idx);
-		assert(owners_.count(reg_id) != 0);
-		owners_.erase(reg_id);
+		auto& owner = owners_[get_reg_index(trace->dst_reg, trace->wid)];
+		auto& mask = in_use_regs_[get_mask_index(trace->dst_reg, trace->wid)];
+		assert(mask.test(trace->dst_reg.idx));
+		mask.reset(trace->dst_reg.idx);
+		assert(owner != nullptr);
+		owner = nullptr;
 	}
 
 private:
 
-  static uint32_t get_reg_id(const RegOpd& reg, uint32_t wid) {
-    return (wid << RegOpd::ID_BITS) | reg.id();
-  }
+	static uint32_t get_mask_index(const RegOpd& reg, uint32_t wid) {
+		return wid * (int)RegType::Count + (int)reg.type;
+	}
 
-	std::vector<std::vector<RegMask>> in_use_regs_;
-	std::unordered_map<uint32_t, instr_trace_t*> owners_;
-};
+	static uint32_t get_reg_index(const RegOpd& reg, uint32_t wid) {
+		return get_mask_index(reg, wid) * MAX_NUM_REGS + reg.idx;
+	}
+
+	bool test(const RegOpd& reg, uint32_t wid) const {
+		return in_use_regs_[get_mask_index(reg, wid)].test(reg.idx);
+	}
 
+	// flat tables indexed by (warp, register type, register index)
+	std::vector<RegMask> in_use_regs_;
+	std::vector<instr_trace_t*> owners_;
+};
 }
@@ -55,6 +55,10 @@ public:
 
   void tick();
 
+  SimActivity activity() const {
+    return SimActivity::Idle;
+  }
+
   void attach_ram(RAM* ram);
 
 #ifdef VM_ENABLE
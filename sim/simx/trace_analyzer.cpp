@@ -0,0 +1,279 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Offline analyzer for binary pipeline traces (see pipe_trace.h).
+// Computes the per-stage latency distributions reported by ci/trace_csv.py.
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <stdlib.h>
+#include <unistd.h>
+#include "pipe_trace.h"
+
+using namespace vortex;
+
+class LatencyStats {
+public:
+  LatencyStats(const char* name)
+    : name_(name)
+    , total_(0)
+    , count_(0)
+    , min_(0)
+    , max_(0)
+    , min_uuid_(0)
+    , max_uuid_(0)
+  {}
+
+  void update(uint64_t uuid, uint64_t value) {
+    if (count_ == 0 || value < min_) {
+      min_ = value;
+      min_uuid_ = uuid;
+    }
+    if (count_ == 0 || value > max_) {
+      max_ = value;
+      max_uuid_ = uuid;
+    }
+    total_ += value;
+    ++count_;
+    ++histogram_[value];
+  }
+
+  uint64_t percentile(uint32_t pct) const {
+    if (count_ == 0)
+      return 0;
+    uint64_t target = (count_ * pct + 99) / 100;
+    uint64_t accum = 0;
+    for (auto& it : histogram_) {
+      accum += it.second;
+      if (accum >= target)
+        return it.first;
+    }
+    return max_;
+  }
+
+  void dump(std::ostream& os, bool show_histogram) const {
+    uint64_t avg = count_ ? (total_ / count_) : 0;
+    os << name_ << " latency: avg=" << avg
+       << ", min=" << min_ << " (#" << min_uuid_ << ")"
+       << ", max=" << max_ << " (#" << max_uuid_ << ")"
+       << ", p50=" << this->percentile(50)
+       << ", p90=" << this->percentile(90)
+       << ", p99=" << this->percentile(99)
+       << ", count=" << count_ << std::endl;
+    if (!show_histogram)
+      return;
+    // power-of-two buckets
+    std::map<uint64_t, uint64_t> buckets;
+    for (auto& it : histogram_) {
+      uint64_t bucket = 0;
+      while ((1ull << bucket) <= it.first)
+        ++bucket;
+      buckets[bucket] += it.second;
+    }
+    for (auto& it : buckets) {
+      uint64_t lo = it.first ? (1ull << (it.first - 1)) : 0;
+      uint64_t hi = (1ull << it.first) - 1;
+      os << "  [" << std::setw(6) << lo << ", " << std::setw(6) << hi << "]: "
+         << it.second << std::endl;
+    }
+  }
+
+private:
+  const char* name_;
+  uint64_t total_;
+  uint64_t count_;
+  uint64_t min_;
+  uint64_t max_;
+  uint64_t min_uuid_;
+  uint64_t max_uuid_;
+  std::map<uint64_t, uint64_t> histogram_;
+};
+
+struct inflight_t {
+  uint64_t ticks[(int)PipeStage::Count];
+  uint64_t PC;
+  uint32_t cid;
+  uint32_t wid;
+  bool     scheduled;
+  bool     decoded;
+};
+
+static void show_usage() {
+  std::cout << "Usage: [-c <csv>] [-g: histogram] [-h: help] <trace>" << std::endl;
+}
+
+static const char* trace_file = nullptr;
+static const char* csv_file = nullptr;
+static bool show_histogram = false;
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "c:gh")) != -1) {
+    switch (c) {
+    case 'c':
+      csv_file = optarg;
+      break;
+    case 'g':
+      show_histogram = true;
+      break;
+    case 'h':
+      show_usage();
+      exit(0);
+      break;
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+  if (optind < argc) {
+    trace_file = argv[optind];
+  } else {
+    show_usage();
+    exit(-1);
+  }
+}
+
+int main(int argc, char **argv) {
+  parse_args(argc, argv);
+
+  bool piped;
+  auto file = pipe_trace_open(trace_file, &piped);
+  if (file == nullptr) {
+    std::cerr << "Error: failed to open " << trace_file << std::endl;
+    return -1;
+  }
+
+  pipe_trace_header_t header;
+  if (fread(&header, sizeof(header), 1, file) != 1
+   || header.magic != PIPE_TRACE_MAGIC
+   || header.version != PIPE_TRACE_VERSION
+   || header.record_size != sizeof(pipe_trace_record_t)) {
+    std::cerr << "Error: invalid trace file " << trace_file << std::endl;
+    pipe_trace_close(file, piped);
+    return -1;
+  }
+
+  std::ofstream csv;
+  if (csv_file) {
+    csv.open(csv_file);
+    if (!csv) {
+      std::cerr << "Error: failed to open " << csv_file << std::endl;
+      pipe_trace_close(file, piped);
+      return -1;
+    }
+    csv << "device,uuid,cid,wid,PC,schedule,decode,ibuffer,dispatch,commit" << std::endl;
+  }
+
+  LatencyStats perf_fetch("Fetch");
+  LatencyStats perf_sched("Schedule");
+  LatencyStats perf_issue("Issue");
+  LatencyStats perf_exec("Execute");
+  LatencyStats perf_total("Total");
+
+  // uuids are unique per device
+  std::vector<std::unordered_map<uint64_t, inflight_t>> inflight;
+  std::vector<pipe_trace_record_t> records(4096);
+  uint64_t num_records = 0;
+  uint64_t num_aliased = 0;
+
+  size_t n;
+  while ((n = fread(records.data(), sizeof(pipe_trace_record_t), records.size(), file)) != 0) {
+    num_records += n;
+    for (size_t i = 0; i < n; ++i) {
+      auto& rec = records[i];
+      auto stage = (PipeStage)rec.stage;
+      if (rec.device >= inflight.size()) {
+        inflight.resize(rec.device + 1);
+      }
+      auto& dev_inflight = inflight[rec.device];
+      auto& entry = dev_inflight[rec.uuid];
+      switch (stage) {
+      case PipeStage::Schedule:
+        if (entry.scheduled) {
+          // micro-ops of an instruction share its uuid and PC, and their warp is
+          // only rescheduled after decode; anything else means uuids are not unique.
+          if (entry.PC != rec.PC || entry.cid != rec.cid || entry.wid != rec.wid || !entry.decoded) {
+            if (num_aliased++ == 0) {
+              std::cerr << "Error: uuid #" << rec.uuid << " scheduled again while in flight" << std::endl;
+            }
+          }
+        }
+        entry.scheduled = true;
+        entry.decoded = false;
+        entry.PC  = rec.PC;
+        entry.cid = rec.cid;
+        entry.wid = rec.wid;
+        entry.ticks[(int)stage] = rec.cycle;
+        break;
+      case PipeStage::Decode:
+        entry.decoded = true;
+        entry.ticks[(int)stage] = rec.cycle;
+        perf_fetch.update(rec.uuid, rec.cycle - entry.ticks[(int)PipeStage::Schedule]);
+        break;
+      case PipeStage::IBuffer:
+        entry.ticks[(int)stage] = rec.cycle;
+        perf_sched.update(rec.uuid, rec.cycle - entry.ticks[(int)PipeStage::Schedule]);
+        break;
+      case PipeStage::Dispatch:
+        entry.ticks[(int)stage] = rec.cycle;
+        perf_issue.update(rec.uuid, rec.cycle - entry.ticks[(int)PipeStage::IBuffer]);
+        break;
+      case PipeStage::Commit:
+        entry.ticks[(int)stage] = rec.cycle;
+        perf_exec.update(rec.uuid, rec.cycle - entry.ticks[(int)PipeStage::Dispatch]);
+        if (rec.flags & 0x2) {
+          // end of packet: instruction retired
+          perf_total.update(rec.uuid, rec.cycle - entry.ticks[(int)PipeStage::Schedule]);
+          if (csv_file) {
+            csv << rec.device << "," << rec.uuid << "," << entry.cid << "," << entry.wid
+                << ",0x" << std::hex << entry.PC << std::dec;
+            for (int s = 0; s < (int)PipeStage::Count; ++s) {
+              csv << "," << entry.ticks[s];
+            }
+            csv << std::endl;
+          }
+          dev_inflight.erase(rec.uuid);
+        }
+        break;
+      default:
+        std::cerr << "Error: invalid stage " << (int)rec.stage << " (#" << rec.uuid << ")" << std::endl;
+        pipe_trace_close(file, piped);
+        return -1;
+      }
+    }
+  }
+
+  pipe_trace_close(file, piped);
+
+  size_t num_incomplete = 0;
+  for (auto& dev_inflight : inflight) {
+    num_incomplete += dev_inflight.size();
+  }
+  std::cout << "records=" << num_records << ", devices=" << inflight.size()
+            << ", incomplete=" << num_incomplete << std::endl;
+  if (num_aliased != 0) {
+    std::cerr << "Error: " << num_aliased << " instructions share an in-flight uuid, latencies are invalid" << std::endl;
+    return -1;
+  }
+  perf_fetch.dump(std::cout, show_histogram);
+  perf_sched.dump(std::cout, show_histogram);
+  perf_issue.dump(std::cout, show_histogram);
+  perf_exec.dump(std::cout, show_histogram);
+  perf_total.dump(std::cout, show_histogram);
+
+  return 0;
+}
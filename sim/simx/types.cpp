@@ -84,6 +84,12 @@ void LocalMemSwitch::tick() {
   }
 }
 
+SimActivity LocalMemSwitch::activity() const {
+  if (!RspLmem.empty() || !RspDC.empty() || !ReqIn.empty())
+    return SimActivity::Busy;
+  return SimActivity::Idle;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 LsuMemAdapter::LsuMemAdapter(
@@ -158,4 +164,14 @@ void LsuMemAdapter::tick() {
     }
     ReqIn.pop();
   }
-}
\ No newline at end of file
+}
+
+SimActivity LsuMemAdapter::activity() const {
+  if (!ReqIn.empty())
+    return SimActivity::Busy;
+  for (auto& rsp_out : RspOut) {
+    if (!rsp_out.empty())
+      return SimActivity::Busy;
+  }
+  return SimActivity::Idle;
+}
@@ -14,6 +14,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <array>
 #include <bitset>
 #include <queue>
 #include <vector>
@@ -904,7 +905,7 @@ private:
 
 struct LsuReq {
   BitVector<> mask;
-  std::vector<uint64_t> addrs;
+  std::array<uint64_t, NUM_LSU_LANES> addrs; // inline storage, mask.size() entries used
   bool     write;
   uint32_t tag;
   uint32_t cid;
@@ -912,12 +913,13 @@ struct LsuReq {
 
   LsuReq(uint32_t size)
     : mask(size)
-    , addrs(size, 0)
     , write(false)
     , tag(0)
     , cid(0)
-    , uuid(0)
-  {}
+    , uuid(0) {
+    assert(size <= NUM_LSU_LANES);
+    addrs.fill(0);
+  }
 
   friend std::ostream &operator<<(std::ostream &os, const LsuReq& req) {
     os << "rw=" << req.write << ", mask=" << req.mask << ", addr={";
@@ -1107,6 +1109,14 @@ public:
     //--
   }
 
+  SimActivity activity() const {
+    return SimActivity::Idle;
+  }
+
+  void set_listener(SimObjectBase* listener) {
+    bus_.set_listener(listener);
+  }
+
   bool empty() const {
     return bus_.empty();
   }
@@ -1238,6 +1248,17 @@ public:
     }
   }
 
+  SimActivity activity() const {
+    // bypass inputs are bound to the outputs
+    if (Inputs.size() == Outputs.size())
+      return SimActivity::Idle;
+    for (auto& input : Inputs) {
+      if (!input.empty())
+        return SimActivity::Busy;
+    }
+    return SimActivity::Idle;
+  }
+
 protected:
 
   uint32_t delay_;
@@ -1341,6 +1362,16 @@ public:
     }
   }
 
+  SimActivity activity() const {
+    if (Inputs.size() == 1 && Outputs.size() == 1)
+      return SimActivity::Idle;
+    for (auto& input : Inputs) {
+      if (!input.empty())
+        return SimActivity::Busy;
+    }
+    return SimActivity::Idle;
+  }
+
   uint64_t collisions() const {
     return collisions_;
   }
@@ -1443,6 +1474,16 @@ public:
     }
   }
 
+  SimActivity activity() const {
+    if (!arbiter_)
+      return SimActivity::Idle;
+    for (auto& rsp_out : RspOut) {
+      if (!rsp_out.empty())
+        return SimActivity::Busy;
+    }
+    return SimActivity::Idle;
+  }
+
 protected:
   typedef TxArbiter<Req> ReqArb;
 
@@ -1552,6 +1593,16 @@ public:
     }
   }
 
+  SimActivity activity() const {
+    if (!crossbar_)
+      return SimActivity::Idle;
+    for (auto& rsp_out : RspOut) {
+      if (!rsp_out.empty())
+        return SimActivity::Busy;
+    }
+    return SimActivity::Idle;
+  }
+
   uint64_t collisions() const {
     if (crossbar_) {
       return crossbar_->collisions();
@@ -1591,6 +1642,8 @@ public:
 
   void tick();
 
+  SimActivity activity() const;
+
 private:
   uint32_t delay_;
 };
@@ -1616,6 +1669,8 @@ public:
 
   void tick();
 
+  SimActivity activity() const;
+
 private:
   uint32_t delay_;
 };
@@ -0,0 +1,196 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "warp_sched.h"
+#include <iostream>
+#include <string>
+#include <stdlib.h>
+#include <bitmanip.h>
+
+using namespace vortex;
+
+static_assert(MAX_NUM_WARPS <= 64, "warp masks must fit in a 64-bit word");
+
+namespace {
+
+struct sched_config_t {
+  WarpScheduler::Policy policy;
+  uint32_t pool_size;
+
+  sched_config_t()
+    : policy(WarpScheduler::Policy::LowestId)
+    , pool_size(0) {
+    auto env = getenv("VORTEX_WARP_SCHED");
+    if (env == nullptr || env[0] == '\0')
+      return;
+    std::string value(env);
+    auto sep = value.find(':');
+    auto name = value.substr(0, sep);
+    if (name == "lid") {
+      policy = WarpScheduler::Policy::LowestId;
+    } else if (name == "lrr") {
+      policy = WarpScheduler::Policy::LooseRR;
+    } else if (name == "gto") {
+      policy = WarpScheduler::Policy::GTO;
+    } else if (name == "2lev") {
+      policy = WarpScheduler::Policy::TwoLevel;
+      if (sep != std::string::npos) {
+        pool_size = std::atoi(value.c_str() + sep + 1);
+      }
+    } else {
+      std::cerr << "Error: invalid warp scheduling policy: " << value << std::endl;
+      std::abort();
+    }
+  }
+};
+
+const sched_config_t& sched_config() {
+  static sched_config_t s_config;
+  return s_config;
+}
+
+}
+
+WarpScheduler::WarpScheduler(uint32_t num_warps)
+  : policy_(sched_config().policy)
+  , num_warps_(num_warps)
+  , pool_size_(num_warps)
+  , wait_start_(num_warps, 0) {
+  if (policy_ == Policy::TwoLevel) {
+    pool_size_ = sched_config().pool_size;
+    if (pool_size_ == 0) {
+      pool_size_ = std::max<uint32_t>(1, num_warps / 2);
+    }
+    pool_size_ = std::min(pool_size_, num_warps);
+  }
+  this->reset();
+}
+
+void WarpScheduler::reset() {
+  last_wid_ = -1;
+  pool_mask_ = 0;
+  waiting_mask_ = 0;
+  sched_cycles_ = 0;
+  perf_stats_ = PerfStats();
+}
+
+int WarpScheduler::select(const WarpMask& active, const WarpMask& stalled) {
+  uint64_t active_mask = active.to_ullong();
+  uint64_t ready = active_mask & ~stalled.to_ullong();
+  if (ready == 0) {
+    this->update_stats(0);
+    return -1;
+  }
+
+  uint32_t wid;
+  switch (policy_) {
+  default:
+  case Policy::LowestId:
+    wid = count_trailing_zeros(ready);
+    break;
+  case Policy::LooseRR:
+    wid = this->select_rr(ready);
+    break;
+  case Policy::GTO:
+    // warps are activated in ID order, so the lowest ID is the oldest
+    if (last_wid_ < num_warps_ && ((ready >> last_wid_) & 0x1)) {
+      wid = last_wid_;
+    } else {
+      wid = count_trailing_zeros(ready);
+    }
+    break;
+  case Policy::TwoLevel:
+    wid = this->select_two_level(active_mask, ready);
+    break;
+  }
+
+  this->update_stats(ready & ~(1ull << wid));
+  last_wid_ = wid;
+  return wid;
+}
+
+void WarpScheduler::skip(uint64_t cycles) {
+  if (cycles == 0)
+    return;
+  this->update_stats(0);
+  sched_cycles_ += cycles - 1;
+}
+
+uint32_t WarpScheduler::select_rr(uint64_t ready) const {
+  // first ready warp after the last scheduled one, wrapping around
+  uint32_t start = last_wid_ + 1;
+  uint64_t upper = (start < 64) ? (ready & (~0ull << start)) : 0;
+  return count_trailing_zeros(upper ? upper : ready);
+}
+
+uint32_t WarpScheduler::select_two_level(uint64_t active, uint64_t ready) {
+  // drop retired warps and refill the active pool from the pending set
+  pool_mask_ &= active;
+  uint64_t pending = active & ~pool_mask_;
+  uint32_t pool_count = __builtin_popcountll(pool_mask_);
+  while (pool_count < pool_size_ && pending != 0) {
+    uint64_t lsb = pending & -pending;
+    pool_mask_ |= lsb;
+    pending &= ~lsb;
+    ++pool_count;
+  }
+
+  // all pool warps are stalled: swap a stalled warp with a ready pending one
+  if ((pool_mask_ & ready) == 0) {
+    uint64_t pending_ready = ready & ~pool_mask_;
+    uint64_t lsb = pending_ready & -pending_ready;
+    if (pool_count >= pool_size_) {
+      uint64_t stalled = pool_mask_ & ~ready;
+      pool_mask_ &= ~(stalled & -stalled);
+    }
+    pool_mask_ |= lsb;
+  }
+
+  return this->select_rr(ready & pool_mask_);
+}
+
+void WarpScheduler::update_stats(uint64_t waiting) {
+  // only visit warps that start or stop waiting
+  uint64_t started = waiting & ~waiting_mask_;
+  uint64_t stopped = waiting_mask_ & ~waiting;
+  for (; started != 0; started &= started - 1) {
+    wait_start_[count_trailing_zeros(started)] = sched_cycles_;
+  }
+  for (; stopped != 0; stopped &= stopped - 1) {
+    auto cycles = sched_cycles_ - wait_start_[count_trailing_zeros(stopped)];
+    perf_stats_.sched_starv = std::max(perf_stats_.sched_starv, cycles);
+  }
+  waiting_mask_ = waiting;
+  perf_stats_.sched_wait += __builtin_popcountll(waiting);
+  ++sched_cycles_;
+}
+
+WarpScheduler::PerfStats WarpScheduler::perf_stats() const {
+  // include warps that are still waiting
+  auto perf = perf_stats_;
+  for (uint64_t waiting = waiting_mask_; waiting != 0; waiting &= waiting - 1) {
+    auto cycles = sched_cycles_ - wait_start_[count_trailing_zeros(waiting)];
+    perf.sched_starv = std::max(perf.sched_starv, cycles);
+  }
+  return perf;
+}
+
+std::ostream& vortex::operator<<(std::ostream& os, WarpScheduler::Policy policy) {
+  switch (policy) {
+  case WarpScheduler::Policy::LowestId: os << "lid"; break;
+  case WarpScheduler::Policy::LooseRR:  os << "lrr"; break;
+  case WarpScheduler::Policy::GTO:      os << "gto"; break;
+  case WarpScheduler::Policy::TwoLevel: os << "2lev"; break;
+  }
+  return os;
+}
@@ -0,0 +1,85 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+#include "types.h"
+
+namespace vortex {
+
+// Warp scheduling policy, selected at runtime with
+// VORTEX_WARP_SCHED=lid|lrr|gto|2lev[:<pool_size>] (default: lid).
+class WarpScheduler {
+public:
+  enum class Policy {
+    LowestId,   // lowest-numbered ready warp
+    LooseRR,    // round-robin starting after the last scheduled warp
+    GTO,        // greedy on last scheduled warp, then oldest
+    TwoLevel    // round-robin within an active pool, refilled from pending warps
+  };
+
+  struct PerfStats {
+    uint64_t sched_wait;  // ready warp cycles lost to other warps
+    uint64_t sched_starv; // longest consecutive wait of a ready warp
+
+    PerfStats()
+      : sched_wait(0)
+      , sched_starv(0)
+    {}
+
+    PerfStats& operator+=(const PerfStats& rhs) {
+      this->sched_wait += rhs.sched_wait;
+      this->sched_starv = std::max(this->sched_starv, rhs.sched_starv);
+      return *this;
+    }
+  };
+
+  WarpScheduler(uint32_t num_warps);
+
+  void reset();
+
+  // select a ready (active and not stalled) warp, returns -1 if none
+  int select(const WarpMask& active, const WarpMask& stalled);
+
+  // account for cycles without ready warps
+  void skip(uint64_t cycles);
+
+  Policy policy() const {
+    return policy_;
+  }
+
+  PerfStats perf_stats() const;
+
+private:
+
+  uint32_t select_rr(uint64_t ready) const;
+
+  uint32_t select_two_level(uint64_t active, uint64_t ready);
+
+  void update_stats(uint64_t waiting);
+
+  Policy   policy_;
+  uint32_t num_warps_;
+  uint32_t pool_size_;
+  uint32_t last_wid_;
+  uint64_t pool_mask_;
+  uint64_t waiting_mask_;
+  uint64_t sched_cycles_;
+  std::vector<uint64_t> wait_start_;
+  PerfStats perf_stats_;
+};
+
+std::ostream& operator<<(std::ostream& os, WarpScheduler::Policy policy);
+
+}
@@ -0,0 +1,221 @@
+#include <iostream>
+#include <unistd.h>
+#include <string.h>
+#include <vector>
+#include <vortex.h>
+#include "common.h"
+
+#define RT_CHECK(_expr)                                         \
+   do {                                                         \
+     int _ret = _expr;                                          \
+     if (0 == _ret)                                             \
+       break;                                                   \
+     printf("Error: '%s' returned %d!\n", #_expr, (int)_ret);   \
+	 cleanup();			                                              \
+     exit(-1);                                                  \
+   } while (false)
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char* kernel_file = "kernel.vxbin";
+uint32_t size = 1000;
+
+vx_device_h device = nullptr;
+vx_buffer_h src_buffer = nullptr;
+vx_buffer_h dst_buffer = nullptr;
+vx_buffer_h krnl_buffer = nullptr;
+vx_buffer_h args_buffer = nullptr;
+int errors = 0;
+
+static void show_usage() {
+   std::cout << "Vortex Test." << std::endl;
+   std::cout << "Usage: [-k: kernel] [-n words] [-h: help]" << std::endl;
+}
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "n:k:h")) != -1) {
+    switch (c) {
+    case 'n':
+      size = atoi(optarg);
+      break;
+    case 'k':
+      kernel_file = optarg;
+      break;
+    case 'h':
+      show_usage();
+      exit(0);
+      break;
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+}
+
+void cleanup() {
+  if (device) {
+    vx_mem_free(src_buffer);
+    vx_mem_free(dst_buffer);
+    vx_mem_free(krnl_buffer);
+    vx_mem_free(args_buffer);
+    vx_dev_close(device);
+  }
+}
+
+// the device buffer must match its host reference
+static void verify(const char* name, vx_buffer_h buffer, const std::vector<uint8_t>& ref) {
+  std::vector<uint8_t> h_buf(ref.size());
+  RT_CHECK(vx_copy_from_dev(h_buf.data(), buffer, 0, h_buf.size()));
+  int mismatches = 0;
+  for (uint32_t i = 0; i < ref.size(); ++i) {
+    if (h_buf[i] != ref[i]) {
+      if (mismatches < 100) {
+        printf("*** error: %s: [%d] expected=0x%x, actual=0x%x\n", name, i, ref[i], h_buf[i]);
+      }
+      ++mismatches;
+    }
+  }
+  errors += mismatches;
+}
+
+// host reference of a fill, the last period may be partial
+static void fill(std::vector<uint8_t>& ref, uint64_t offset, uint64_t size, const uint8_t* pattern, uint32_t pattern_size) {
+  for (uint64_t i = 0; i < size; ++i) {
+    ref[offset + i] = pattern[i % pattern_size];
+  }
+}
+
+// overlapping copies within a buffer, in both directions
+static void test_copy(std::vector<uint8_t>& ref) {
+  std::cout << "test overlapping copies" << std::endl;
+  uint64_t buf_size = ref.size();
+  uint64_t len = buf_size - 67;
+
+  // the destination overlaps the tail of the source
+  RT_CHECK(vx_copy_dev_to_dev(src_buffer, 67, src_buffer, 0, len));
+  memmove(ref.data() + 67, ref.data(), len);
+  verify("forward copy", src_buffer, ref);
+
+  // the destination overlaps the head of the source
+  RT_CHECK(vx_copy_dev_to_dev(src_buffer, 0, src_buffer, 29, len));
+  memmove(ref.data(), ref.data() + 29, len);
+  verify("backward copy", src_buffer, ref);
+}
+
+// fills with patterns that do not divide the filled range
+static void test_fill(std::vector<uint8_t>& ref) {
+  std::cout << "test non-power-of-two fills" << std::endl;
+  uint64_t buf_size = ref.size();
+  static const uint8_t pattern[] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77};
+
+  RT_CHECK(vx_mem_fill(src_buffer, 5, buf_size - 10, pattern, 3));
+  fill(ref, 5, buf_size - 10, pattern, 3);
+  verify("fill 3", src_buffer, ref);
+
+  RT_CHECK(vx_mem_fill(src_buffer, 1, buf_size / 2 + 1, pattern, 7));
+  fill(ref, 1, buf_size / 2 + 1, pattern, 7);
+  verify("fill 7", src_buffer, ref);
+}
+
+// the same operations through a queue, followed by a kernel consuming the result
+static void test_enqueue(std::vector<uint8_t>& ref) {
+  std::cout << "test enqueued copies and fills" << std::endl;
+  uint64_t buf_size = ref.size();
+  uint64_t len = buf_size - 41;
+  uint8_t pattern[] = {0xa1, 0xb2, 0xc3, 0xd4, 0xe5};
+
+  vx_queue_h queue;
+  RT_CHECK(vx_queue_create(device, &queue));
+  RT_CHECK(vx_enqueue_fill(queue, src_buffer, 3, buf_size - 3, pattern, 5, nullptr));
+  // the pattern was captured at enqueue time
+  fill(ref, 3, buf_size - 3, pattern, 5);
+  memset(pattern, 0, sizeof(pattern));
+  RT_CHECK(vx_enqueue_copy_dev_to_dev(queue, src_buffer, 41, src_buffer, 0, len, nullptr));
+  memmove(ref.data() + 41, ref.data(), len);
+  RT_CHECK(vx_enqueue_copy_dev_to_dev(queue, src_buffer, 0, src_buffer, 17, len, nullptr));
+  memmove(ref.data(), ref.data() + 17, len);
+  RT_CHECK(vx_enqueue_start(queue, krnl_buffer, args_buffer, nullptr));
+  std::vector<uint8_t> h_dst(buf_size);
+  RT_CHECK(vx_enqueue_copy_from_dev(queue, h_dst.data(), dst_buffer, 0, buf_size, nullptr));
+  RT_CHECK(vx_queue_finish(queue, VX_MAX_TIMEOUT));
+  RT_CHECK(vx_queue_destroy(queue));
+
+  verify("enqueued ops", src_buffer, ref);
+
+  // the kernel adds one to every word
+  int mismatches = 0;
+  for (uint32_t i = 0; i < size; ++i) {
+    uint32_t src, dst;
+    memcpy(&src, ref.data() + i * sizeof(uint32_t), sizeof(uint32_t));
+    memcpy(&dst, h_dst.data() + i * sizeof(uint32_t), sizeof(uint32_t));
+    if (dst != src + 1) {
+      if (mismatches < 100) {
+        printf("*** error: kernel: [%d] expected=%d, actual=%d\n", i, src + 1, dst);
+      }
+      ++mismatches;
+    }
+  }
+  errors += mismatches;
+}
+
+int main(int argc, char *argv[]) {
+  // parse command arguments
+  parse_args(argc, argv);
+
+  std::srand(50);
+
+  // open device connection
+  std::cout << "open device connection" << std::endl;
+  RT_CHECK(vx_dev_open(&device));
+
+  uint32_t num_points = size;
+  uint32_t buf_size = num_points * sizeof(uint32_t);
+
+  std::cout << "number of points: " << num_points << std::endl;
+  std::cout << "buffer size: " << buf_size << " bytes" << std::endl;
+
+  // allocate device memory
+  std::cout << "allocate device memory" << std::endl;
+  RT_CHECK(vx_mem_alloc(device, buf_size, VX_MEM_READ_WRITE, &src_buffer));
+  RT_CHECK(vx_mem_alloc(device, buf_size, VX_MEM_WRITE, &dst_buffer));
+
+  kernel_arg_t kernel_arg = {};
+  kernel_arg.num_points = num_points;
+  kernel_arg.value = 1;
+  RT_CHECK(vx_mem_address(src_buffer, &kernel_arg.src_addr));
+  RT_CHECK(vx_mem_address(dst_buffer, &kernel_arg.dst_addr));
+
+  // Upload kernel binary
+  std::cout << "Upload kernel binary" << std::endl;
+  RT_CHECK(vx_upload_kernel_file(device, kernel_file, &krnl_buffer));
+
+  // upload kernel arguments
+  std::cout << "upload kernel arguments" << std::endl;
+  RT_CHECK(vx_upload_bytes(device, &kernel_arg, sizeof(kernel_arg_t), &args_buffer));
+
+  // host reference of the source buffer
+  std::vector<uint8_t> ref(buf_size);
+  for (auto& value : ref) {
+    value = rand();
+  }
+  RT_CHECK(vx_copy_to_dev(src_buffer, ref.data(), 0, buf_size));
+
+  test_copy(ref);
+  test_fill(ref);
+  test_enqueue(ref);
+
+  // cleanup
+  std::cout << "cleanup" << std::endl;
+  cleanup();
+
+  if (errors != 0) {
+    std::cout << "Found " << std::dec << errors << " errors!" << std::endl;
+    std::cout << "FAILED!" << std::endl;
+    return 1;
+  }
+
+  std::cout << "PASSED!" << std::endl;
+
+  return 0;
+}
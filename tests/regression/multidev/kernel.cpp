@@ -0,0 +1,14 @@
+#include <vx_spawn.h>
+#include "common.h"
+
+void kernel_body(kernel_arg_t* __UNIFORM__ arg) {
+	auto src_ptr = reinterpret_cast<uint32_t*>(arg->src_addr);
+	auto dst_ptr = reinterpret_cast<uint32_t*>(arg->dst_addr);
+
+	dst_ptr[blockIdx.x] = src_ptr[blockIdx.x] + arg->value;
+}
+
+int main() {
+	kernel_arg_t* arg = (kernel_arg_t*)csr_read(VX_CSR_MSCRATCH);
+	return vx_spawn_threads(1, &arg->num_points, nullptr, (vx_kernel_func_cb)kernel_body, arg);
+}
@@ -0,0 +1,156 @@
+#include <iostream>
+#include <unistd.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include <vortex.h>
+#include "common.h"
+
+#define RT_CHECK(_expr)                                         \
+   do {                                                         \
+     int _ret = _expr;                                          \
+     if (0 == _ret)                                             \
+       break;                                                   \
+     printf("Error: '%s' returned %d!\n", #_expr, (int)_ret);   \
+     return _ret;                                               \
+   } while (false)
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char* kernel_file = "kernel.vxbin";
+uint32_t size = 16;
+uint32_t num_devices = 2;
+uint32_t num_launches = 4;
+
+static void show_usage() {
+   std::cout << "Vortex Test." << std::endl;
+   std::cout << "Usage: [-k: kernel] [-n words] [-d devices] [-l launches] [-h: help]" << std::endl;
+}
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "n:d:l:k:h")) != -1) {
+    switch (c) {
+    case 'n':
+      size = atoi(optarg);
+      break;
+    case 'd':
+      num_devices = atoi(optarg);
+      break;
+    case 'l':
+      num_launches = atoi(optarg);
+      break;
+    case 'k':
+      kernel_file = optarg;
+      break;
+    case 'h':
+      show_usage();
+      exit(0);
+      break;
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+}
+
+// each launch adds the device value to the buffer
+static int run_device(vx_device_h device, uint32_t value, int* errors) {
+  uint32_t buf_size = size * sizeof(uint32_t);
+
+  std::vector<uint32_t> h_src(size);
+  std::vector<uint32_t> h_dst(size, 0);
+  for (uint32_t i = 0; i < size; ++i) {
+    h_src[i] = i * value;
+  }
+
+  vx_buffer_h buffer;
+  vx_buffer_h krnl_buffer;
+  vx_buffer_h args_buffer;
+  RT_CHECK(vx_mem_alloc(device, buf_size, VX_MEM_READ_WRITE, &buffer));
+  RT_CHECK(vx_copy_to_dev(buffer, h_src.data(), 0, buf_size));
+  RT_CHECK(vx_upload_kernel_file(device, kernel_file, &krnl_buffer));
+
+  // the kernel updates the buffer in place
+  kernel_arg_t kernel_arg = {};
+  kernel_arg.num_points = size;
+  kernel_arg.value = value;
+  RT_CHECK(vx_mem_address(buffer, &kernel_arg.src_addr));
+  kernel_arg.dst_addr = kernel_arg.src_addr;
+  RT_CHECK(vx_upload_bytes(device, &kernel_arg, sizeof(kernel_arg_t), &args_buffer));
+
+  for (uint32_t i = 0; i < num_launches; ++i) {
+    RT_CHECK(vx_start(device, krnl_buffer, args_buffer));
+    RT_CHECK(vx_ready_wait(device, VX_MAX_TIMEOUT));
+  }
+
+  RT_CHECK(vx_copy_from_dev(h_dst.data(), buffer, 0, buf_size));
+  for (uint32_t i = 0; i < size; ++i) {
+    auto ref = h_src[i] + num_launches * value;
+    if (h_dst[i] != ref) {
+      if (*errors < 100) {
+        printf("*** error: device value %d: [%d] expected=%d, actual=%d\n", value, i, ref, h_dst[i]);
+      }
+      ++*errors;
+    }
+  }
+
+  RT_CHECK(vx_mem_free(buffer));
+  RT_CHECK(vx_mem_free(krnl_buffer));
+  RT_CHECK(vx_mem_free(args_buffer));
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  // parse command arguments
+  parse_args(argc, argv);
+
+  std::cout << "number of devices: " << num_devices << std::endl;
+  std::cout << "number of points: " << size << std::endl;
+
+  // open device connections
+  std::cout << "open device connections" << std::endl;
+  std::vector<vx_device_h> devices(num_devices, nullptr);
+  for (auto& device : devices) {
+    RT_CHECK(vx_dev_open(&device));
+  }
+
+  // simulate the devices concurrently, one host thread each
+  std::cout << "run devices concurrently" << std::endl;
+  std::vector<int> results(num_devices, 0);
+  std::vector<int> errors(num_devices, 0);
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < num_devices; ++i) {
+    threads.emplace_back([&, i]() {
+      results[i] = run_device(devices[i], i + 1, &errors[i]);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // cleanup
+  std::cout << "cleanup" << std::endl;
+  for (auto device : devices) {
+    vx_dev_close(device);
+  }
+
+  int total_errors = 0;
+  for (uint32_t i = 0; i < num_devices; ++i) {
+    if (results[i] != 0) {
+      printf("*** error: device %d failed!\n", i);
+      ++total_errors;
+    }
+    total_errors += errors[i];
+  }
+
+  if (total_errors != 0) {
+    std::cout << "Found " << std::dec << total_errors << " errors!" << std::endl;
+    std::cout << "FAILED!" << std::endl;
+    return 1;
+  }
+
+  std::cout << "PASSED!" << std::endl;
+
+  return 0;
+}
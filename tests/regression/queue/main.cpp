@@ -0,0 +1,279 @@
+#include <iostream>
+#include <unistd.h>
+#include <string.h>
+#include <vector>
+#include <vortex.h>
+#include "common.h"
+
+#define RT_CHECK(_expr)                                         \
+   do {                                                         \
+     int _ret = _expr;                                          \
+     if (0 == _ret)                                             \
+       break;                                                   \
+     printf("Error: '%s' returned %d!\n", #_expr, (int)_ret);   \
+	 cleanup();			                                              \
+     exit(-1);                                                  \
+   } while (false)
+
+#define TEST_CHECK(_expr)                                       \
+   do {                                                         \
+     if (_expr)                                                 \
+       break;                                                   \
+     printf("*** error: '%s' failed at line %d!\n", #_expr, __LINE__); \
+     ++errors;                                                  \
+   } while (false)
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char* kernel_file = "kernel.vxbin";
+uint32_t size = 16;
+
+vx_device_h device = nullptr;
+vx_buffer_h src_buffer = nullptr;
+vx_buffer_h dst0_buffer = nullptr;
+vx_buffer_h dst1_buffer = nullptr;
+vx_buffer_h krnl_buffer = nullptr;
+vx_buffer_h args0_buffer = nullptr;
+vx_buffer_h args1_buffer = nullptr;
+int errors = 0;
+
+static void show_usage() {
+   std::cout << "Vortex Test." << std::endl;
+   std::cout << "Usage: [-k: kernel] [-n words] [-h: help]" << std::endl;
+}
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "n:k:h")) != -1) {
+    switch (c) {
+    case 'n':
+      size = atoi(optarg);
+      break;
+    case 'k':
+      kernel_file = optarg;
+      break;
+    case 'h':
+      show_usage();
+      exit(0);
+      break;
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+}
+
+void cleanup() {
+  if (device) {
+    vx_mem_free(src_buffer);
+    vx_mem_free(dst0_buffer);
+    vx_mem_free(dst1_buffer);
+    vx_mem_free(krnl_buffer);
+    vx_mem_free(args0_buffer);
+    vx_mem_free(args1_buffer);
+    vx_dev_close(device);
+  }
+}
+
+static void generate(std::vector<uint32_t>& data) {
+  for (auto& value : data) {
+    value = rand();
+  }
+}
+
+static int event_status(vx_event_h event) {
+  int status = -1;
+  RT_CHECK(vx_event_query(event, &status));
+  return status;
+}
+
+// every element of dst must be src plus value
+static void verify(const std::vector<uint32_t>& dst, const std::vector<uint32_t>& src, uint32_t value) {
+  int mismatches = 0;
+  for (uint32_t i = 0; i < dst.size(); ++i) {
+    auto ref = src[i] + value;
+    if (dst[i] != ref) {
+      if (mismatches < 100) {
+        printf("*** error: [%d] expected=%d, actual=%d\n", i, ref, dst[i]);
+      }
+      ++mismatches;
+    }
+  }
+  errors += mismatches;
+}
+
+// upload, launch and read back through a single queue
+static void test_in_order(uint32_t buf_size) {
+  std::cout << "test in-order execution" << std::endl;
+  std::vector<uint32_t> h_src(size);
+  std::vector<uint32_t> h_dst(size, 0);
+  generate(h_src);
+
+  vx_queue_h queue;
+  RT_CHECK(vx_queue_create(device, &queue));
+  vx_event_h start_event;
+  vx_event_h copy_event;
+  RT_CHECK(vx_enqueue_copy_to_dev(queue, src_buffer, h_src.data(), 0, buf_size, nullptr));
+  RT_CHECK(vx_enqueue_start(queue, krnl_buffer, args0_buffer, &start_event));
+  RT_CHECK(vx_enqueue_copy_from_dev(queue, h_dst.data(), dst0_buffer, 0, buf_size, &copy_event));
+  TEST_CHECK(0 == vx_event_wait(copy_event, VX_MAX_TIMEOUT));
+  // commands complete in order
+  TEST_CHECK(VX_EVENT_COMPLETE == event_status(start_event));
+  TEST_CHECK(VX_EVENT_COMPLETE == event_status(copy_event));
+  RT_CHECK(vx_queue_finish(queue, VX_MAX_TIMEOUT));
+  RT_CHECK(vx_event_release(start_event));
+  RT_CHECK(vx_event_release(copy_event));
+  RT_CHECK(vx_queue_destroy(queue));
+
+  verify(h_dst, h_src, 1);
+}
+
+// the second kernel consumes the output of a kernel running on another queue
+static void test_barrier(uint32_t buf_size) {
+  std::cout << "test cross-queue barrier" << std::endl;
+  std::vector<uint32_t> h_src(size);
+  std::vector<uint32_t> h_dst(size, 0);
+  generate(h_src);
+
+  vx_queue_h queue0, queue1;
+  RT_CHECK(vx_queue_create(device, &queue0));
+  RT_CHECK(vx_queue_create(device, &queue1));
+  vx_event_h start_event;
+  vx_event_h barrier_event;
+  // queue1 can reach the device while the first kernel of queue0 runs
+  RT_CHECK(vx_enqueue_start(queue0, krnl_buffer, args0_buffer, nullptr));
+  RT_CHECK(vx_enqueue_copy_to_dev(queue0, src_buffer, h_src.data(), 0, buf_size, nullptr));
+  RT_CHECK(vx_enqueue_start(queue0, krnl_buffer, args0_buffer, &start_event));
+  RT_CHECK(vx_enqueue_barrier(queue1, 1, &start_event, &barrier_event));
+  RT_CHECK(vx_enqueue_start(queue1, krnl_buffer, args1_buffer, nullptr));
+  RT_CHECK(vx_enqueue_copy_from_dev(queue1, h_dst.data(), dst1_buffer, 0, buf_size, nullptr));
+  RT_CHECK(vx_queue_finish(queue1, VX_MAX_TIMEOUT));
+  // the barrier was released only after the last kernel of queue0 completed
+  TEST_CHECK(VX_EVENT_COMPLETE == event_status(start_event));
+  TEST_CHECK(VX_EVENT_COMPLETE == event_status(barrier_event));
+  RT_CHECK(vx_event_release(start_event));
+  RT_CHECK(vx_event_release(barrier_event));
+  RT_CHECK(vx_queue_destroy(queue0));
+  RT_CHECK(vx_queue_destroy(queue1));
+
+  verify(h_dst, h_src, 1 + 2);
+}
+
+// a failed command fails the commands queued after it
+static void test_error(uint32_t buf_size) {
+  std::cout << "test error propagation" << std::endl;
+  std::vector<uint32_t> h_old(size);
+  std::vector<uint32_t> h_src(size);
+  std::vector<uint32_t> h_dst(size, 0);
+  RT_CHECK(vx_copy_from_dev(h_old.data(), src_buffer, 0, buf_size));
+  generate(h_src);
+
+  vx_queue_h queue;
+  RT_CHECK(vx_queue_create(device, &queue));
+  vx_event_h bad_event;
+  vx_event_h copy_event;
+  vx_event_h start_event;
+  // out of the buffer bounds
+  RT_CHECK(vx_enqueue_copy_to_dev(queue, src_buffer, h_src.data(), buf_size, buf_size, &bad_event));
+  RT_CHECK(vx_enqueue_copy_to_dev(queue, src_buffer, h_src.data(), 0, buf_size, &copy_event));
+  RT_CHECK(vx_enqueue_start(queue, krnl_buffer, args0_buffer, &start_event));
+  RT_CHECK(vx_queue_finish(queue, VX_MAX_TIMEOUT));
+  TEST_CHECK(0 != vx_event_wait(bad_event, VX_MAX_TIMEOUT));
+  TEST_CHECK(0 != vx_event_wait(copy_event, VX_MAX_TIMEOUT));
+  TEST_CHECK(0 != vx_event_wait(start_event, VX_MAX_TIMEOUT));
+  TEST_CHECK(VX_EVENT_ERROR == event_status(bad_event));
+  TEST_CHECK(VX_EVENT_ERROR == event_status(copy_event));
+  TEST_CHECK(VX_EVENT_ERROR == event_status(start_event));
+  RT_CHECK(vx_event_release(bad_event));
+  RT_CHECK(vx_event_release(copy_event));
+  RT_CHECK(vx_event_release(start_event));
+  RT_CHECK(vx_queue_destroy(queue));
+
+  // the skipped copy left the device buffer unchanged
+  RT_CHECK(vx_copy_from_dev(h_dst.data(), src_buffer, 0, buf_size));
+  verify(h_dst, h_old, 0);
+}
+
+// destroying a queue completes its pending commands
+static void test_destroy(uint32_t buf_size) {
+  std::cout << "test queue destruction with pending work" << std::endl;
+  std::vector<uint32_t> h_src(size);
+  std::vector<uint32_t> h_dst(size, 0);
+  generate(h_src);
+
+  vx_queue_h queue;
+  RT_CHECK(vx_queue_create(device, &queue));
+  vx_event_h copy_event;
+  RT_CHECK(vx_enqueue_copy_to_dev(queue, src_buffer, h_src.data(), 0, buf_size, nullptr));
+  RT_CHECK(vx_enqueue_start(queue, krnl_buffer, args0_buffer, nullptr));
+  RT_CHECK(vx_enqueue_copy_from_dev(queue, h_dst.data(), dst0_buffer, 0, buf_size, &copy_event));
+  RT_CHECK(vx_queue_destroy(queue));
+  // the event outlives its queue
+  TEST_CHECK(VX_EVENT_COMPLETE == event_status(copy_event));
+  RT_CHECK(vx_event_release(copy_event));
+
+  verify(h_dst, h_src, 1);
+}
+
+int main(int argc, char *argv[]) {
+  // parse command arguments
+  parse_args(argc, argv);
+
+  std::srand(50);
+
+  // open device connection
+  std::cout << "open device connection" << std::endl;
+  RT_CHECK(vx_dev_open(&device));
+
+  uint32_t num_points = size;
+  uint32_t buf_size = num_points * sizeof(uint32_t);
+
+  std::cout << "number of points: " << num_points << std::endl;
+  std::cout << "buffer size: " << buf_size << " bytes" << std::endl;
+
+  // allocate device memory
+  std::cout << "allocate device memory" << std::endl;
+  kernel_arg_t kernel_arg0 = {};
+  kernel_arg_t kernel_arg1 = {};
+  RT_CHECK(vx_mem_alloc(device, buf_size, VX_MEM_READ, &src_buffer));
+  RT_CHECK(vx_mem_alloc(device, buf_size, VX_MEM_READ_WRITE, &dst0_buffer));
+  RT_CHECK(vx_mem_alloc(device, buf_size, VX_MEM_WRITE, &dst1_buffer));
+
+  // kernel 0: dst0 = src + 1, kernel 1: dst1 = dst0 + 2
+  kernel_arg0.num_points = num_points;
+  kernel_arg0.value = 1;
+  RT_CHECK(vx_mem_address(src_buffer, &kernel_arg0.src_addr));
+  RT_CHECK(vx_mem_address(dst0_buffer, &kernel_arg0.dst_addr));
+  kernel_arg1.num_points = num_points;
+  kernel_arg1.value = 2;
+  RT_CHECK(vx_mem_address(dst0_buffer, &kernel_arg1.src_addr));
+  RT_CHECK(vx_mem_address(dst1_buffer, &kernel_arg1.dst_addr));
+
+  // Upload kernel binary
+  std::cout << "Upload kernel binary" << std::endl;
+  RT_CHECK(vx_upload_kernel_file(device, kernel_file, &krnl_buffer));
+
+  // upload kernel arguments
+  std::cout << "upload kernel arguments" << std::endl;
+  RT_CHECK(vx_upload_bytes(device, &kernel_arg0, sizeof(kernel_arg_t), &args0_buffer));
+  RT_CHECK(vx_upload_bytes(device, &kernel_arg1, sizeof(kernel_arg_t), &args1_buffer));
+
+  test_in_order(buf_size);
+  test_barrier(buf_size);
+  test_error(buf_size);
+  test_destroy(buf_size);
+
+  // cleanup
+  std::cout << "cleanup" << std::endl;
+  cleanup();
+
+  if (errors != 0) {
+    std::cout << "Found " << std::dec << errors << " errors!" << std::endl;
+    std::cout << "FAILED!" << std::endl;
+    return 1;
+  }
+
+  std::cout << "PASSED!" << std::endl;
+
+  return 0;
+}
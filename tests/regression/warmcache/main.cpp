@@ -0,0 +1,167 @@
+#include <iostream>
+#include <unistd.h>
+#include <string.h>
+#include <vector>
+#include <vortex.h>
+#include <VX_types.h>
+#include "common.h"
+
+#define RT_CHECK(_expr)                                         \
+   do {                                                         \
+     int _ret = _expr;                                          \
+     if (0 == _ret)                                             \
+       break;                                                   \
+     printf("Error: '%s' returned %d!\n", #_expr, (int)_ret);   \
+	 cleanup();			                                              \
+     exit(-1);                                                  \
+   } while (false)
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char* kernel_file = "kernel.vxbin";
+uint32_t size = 1024;
+
+vx_device_h device = nullptr;
+vx_buffer_h src_buffer = nullptr;
+vx_buffer_h dst_buffer = nullptr;
+vx_buffer_h krnl_buffer = nullptr;
+vx_buffer_h args_buffer = nullptr;
+int errors = 0;
+
+static void show_usage() {
+   std::cout << "Vortex Test." << std::endl;
+   std::cout << "Usage: [-k: kernel] [-n words] [-h: help]" << std::endl;
+}
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "n:k:h")) != -1) {
+    switch (c) {
+    case 'n':
+      size = atoi(optarg);
+      break;
+    case 'k':
+      kernel_file = optarg;
+      break;
+    case 'h':
+      show_usage();
+      exit(0);
+      break;
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+}
+
+void cleanup() {
+  if (device) {
+    vx_mem_free(src_buffer);
+    vx_mem_free(dst_buffer);
+    vx_mem_free(krnl_buffer);
+    vx_mem_free(args_buffer);
+    vx_dev_close(device);
+  }
+}
+
+// launch the kernel and return the data cache read misses of the launch
+static uint64_t run_kernel(int flags, const std::vector<uint32_t>& h_src) {
+  uint32_t buf_size = size * sizeof(uint32_t);
+  RT_CHECK(vx_start_ex(device, krnl_buffer, args_buffer, flags));
+  RT_CHECK(vx_ready_wait(device, VX_MAX_TIMEOUT));
+
+  uint64_t num_cores;
+  RT_CHECK(vx_dev_caps(device, VX_CAPS_NUM_CORES, &num_cores));
+  uint64_t misses = 0;
+  for (uint32_t core_id = 0; core_id < num_cores; ++core_id) {
+    uint64_t value;
+    RT_CHECK(vx_mpm_query(device, VX_CSR_MPM_DCACHE_MISS_R, core_id, &value));
+    misses += value;
+  }
+
+  std::vector<uint32_t> h_dst(size);
+  RT_CHECK(vx_copy_from_dev(h_dst.data(), dst_buffer, 0, buf_size));
+  for (uint32_t i = 0; i < size; ++i) {
+    auto ref = h_src[i] + 1;
+    if (h_dst[i] != ref) {
+      if (errors < 100) {
+        printf("*** error: [%d] expected=%d, actual=%d\n", i, ref, h_dst[i]);
+      }
+      ++errors;
+    }
+  }
+  return misses;
+}
+
+int main(int argc, char *argv[]) {
+  // parse command arguments
+  parse_args(argc, argv);
+
+  std::srand(50);
+
+  // open device connection
+  std::cout << "open device connection" << std::endl;
+  RT_CHECK(vx_dev_open(&device));
+
+  uint32_t num_points = size;
+  uint32_t buf_size = num_points * sizeof(uint32_t);
+
+  std::cout << "number of points: " << num_points << std::endl;
+  std::cout << "buffer size: " << buf_size << " bytes" << std::endl;
+
+  // allocate device memory
+  std::cout << "allocate device memory" << std::endl;
+  RT_CHECK(vx_mem_alloc(device, buf_size, VX_MEM_READ, &src_buffer));
+  RT_CHECK(vx_mem_alloc(device, buf_size, VX_MEM_WRITE, &dst_buffer));
+
+  kernel_arg_t kernel_arg = {};
+  kernel_arg.num_points = num_points;
+  kernel_arg.value = 1;
+  RT_CHECK(vx_mem_address(src_buffer, &kernel_arg.src_addr));
+  RT_CHECK(vx_mem_address(dst_buffer, &kernel_arg.dst_addr));
+
+  std::vector<uint32_t> h_src(size);
+  for (auto& value : h_src) {
+    value = rand();
+  }
+  RT_CHECK(vx_copy_to_dev(src_buffer, h_src.data(), 0, buf_size));
+
+  // Upload kernel binary
+  std::cout << "Upload kernel binary" << std::endl;
+  RT_CHECK(vx_upload_kernel_file(device, kernel_file, &krnl_buffer));
+
+  // upload kernel arguments
+  std::cout << "upload kernel arguments" << std::endl;
+  RT_CHECK(vx_upload_bytes(device, &kernel_arg, sizeof(kernel_arg_t), &args_buffer));
+
+  // count memory events
+  RT_CHECK(vx_dcr_write(device, VX_DCR_BASE_MPM_CLASS, VX_DCR_MPM_CLASS_MEM));
+
+  // the cold launch starts from invalidated caches, the warm launch reuses
+  // the lines that the cold launch brought in
+  std::cout << "cold launch" << std::endl;
+  RT_CHECK(vx_cache_flush(device));
+  auto cold_misses = run_kernel(0, h_src);
+  std::cout << "warm launch" << std::endl;
+  auto warm_misses = run_kernel(VX_START_WARM_CACHES, h_src);
+
+  std::cout << "dcache read misses: cold=" << cold_misses << ", warm=" << warm_misses << std::endl;
+  if (warm_misses >= cold_misses) {
+    printf("*** error: the warm launch did not reduce the cache misses!\n");
+    ++errors;
+  }
+
+  // cleanup
+  std::cout << "cleanup" << std::endl;
+  cleanup();
+
+  if (errors != 0) {
+    std::cout << "Found " << std::dec << errors << " errors!" << std::endl;
+    std::cout << "FAILED!" << std::endl;
+    return 1;
+  }
+
+  std::cout << "PASSED!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,159 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <bitmanip.h>
+#include <bitvector.h>
+
+#define CHECK(_expr)                                            \
+   do {                                                         \
+     if (_expr)                                                 \
+       break;                                                   \
+     printf("Error: '%s' failed at line %d (size=%d)!\n", #_expr, __LINE__, (int)size); \
+     return -1;                                                 \
+   } while (false)
+
+// sizes around the single-word, inline (256 bits) and heap storage boundaries
+static const size_t sizes[] = {
+  0, 1, 31, 32, 33, 63, 64, 65, 127, 128, 129, 255, 256, 257, 320, 1000
+};
+
+// reference scans over a plain bool vector
+static size_t ref_next(const std::vector<bool>& ref, size_t pos) {
+  while (pos < ref.size() && !ref[pos])
+    ++pos;
+  return pos;
+}
+
+static size_t ref_last(const std::vector<bool>& ref) {
+  for (size_t i = ref.size(); i-- != 0;) {
+    if (ref[i])
+      return i;
+  }
+  return ref.size();
+}
+
+template <typename T>
+static int check_scans(const vortex::BitVector<T>& bv, const std::vector<bool>& ref) {
+  size_t size = ref.size();
+  CHECK(bv.size() == size);
+  CHECK(bv.find_first() == ref_next(ref, 0));
+  CHECK(bv.find_last() == ref_last(ref));
+  size_t count = 0;
+  for (size_t i = 0; i < size; ++i) {
+    CHECK(bv.test(i) == ref[i]);
+    CHECK(bv.find_next(i) == ref_next(ref, i + 1));
+    count += ref[i];
+  }
+  CHECK(bv.count() == count);
+  CHECK(bv.any() == (count != 0));
+  CHECK(bv.none() == (count == 0));
+  std::vector<size_t> visited;
+  bv.for_each_set([&](size_t i) { visited.push_back(i); });
+  CHECK(visited.size() == count);
+  for (size_t j = 0, i = bv.find_first(); i < size; i = bv.find_next(i), ++j) {
+    CHECK(visited.at(j) == i);
+  }
+  return 0;
+}
+
+template <typename T>
+static int test_sizes() {
+  for (auto size : sizes) {
+    // empty vector
+    vortex::BitVector<T> bv(size);
+    std::vector<bool> ref(size, false);
+    if (check_scans(bv, ref))
+      return -1;
+    CHECK(bv.find_next(size) == size);
+
+    if (size == 0)
+      continue;
+
+    // last bit only, including the last bit of a partial word
+    bv.set(size - 1);
+    ref[size - 1] = true;
+    if (check_scans(bv, ref))
+      return -1;
+    CHECK(bv.find_next(size - 1) == size);
+
+    // sparse pattern spanning every word
+    for (size_t i = 0; i < size; i += 7) {
+      bv.set(i);
+      ref[i] = true;
+    }
+    if (check_scans(bv, ref))
+      return -1;
+
+    // flip must keep bits past the size clear
+    bv.flip();
+    ref.flip();
+    if (check_scans(bv, ref))
+      return -1;
+
+    // all bits set
+    bv.reset();
+    bv.flip();
+    std::vector<bool> ones(size, true);
+    CHECK(bv.all());
+    if (check_scans(bv, ones))
+      return -1;
+
+    // copies and moves keep the contents, inline or on the heap
+    vortex::BitVector<T> copy(bv);
+    CHECK(copy == bv);
+    vortex::BitVector<T> moved(std::move(copy));
+    CHECK(moved == bv);
+    CHECK(copy.size() == 0);
+    vortex::BitVector<T> assigned(1);
+    assigned = moved;
+    CHECK(assigned == bv);
+    assigned = std::move(moved);
+    CHECK(assigned == bv);
+  }
+  return 0;
+}
+
+template <typename T>
+static int test_resize() {
+  // grow and shrink across the inline and heap storage
+  for (auto from : sizes) {
+    for (auto to : sizes) {
+      vortex::BitVector<T> bv(from);
+      std::vector<bool> ref(from, false);
+      for (size_t i = 0; i < from; i += 3) {
+        bv.set(i);
+        ref[i] = true;
+      }
+      // bits below both sizes are kept, new bits are clear
+      bv.resize(to);
+      ref.resize(to, false);
+      size_t size = to;
+      if (check_scans(bv, ref))
+        return -1;
+      CHECK(bv.find_next(to) == to);
+    }
+  }
+  return 0;
+}
+
+template <typename T>
+static int run_tests() {
+  if (test_sizes<T>())
+    return -1;
+  if (test_resize<T>())
+    return -1;
+  return 0;
+}
+
+int main() {
+  if (run_tests<uint32_t>())
+    return -1;
+  if (run_tests<uint64_t>())
+    return -1;
+
+  printf("PASSED!\n");
+
+  return 0;
+}
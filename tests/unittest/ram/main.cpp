@@ -0,0 +1,150 @@
+#include <mem.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#define CHECK(_expr)                                            \
+   do {                                                         \
+     if (_expr)                                                 \
+       break;                                                   \
+     printf("Error: '%s' failed at line %d!\n", #_expr, __LINE__); \
+     return -1;                                                 \
+   } while (false)
+
+static const uint64_t capacity = 1 << 20;
+static const uint32_t pageSize = 64;
+
+// fill a range with a known sequence, mirrored in a host reference copy
+static void init_range(vortex::RAM& ram, std::vector<uint8_t>& ref, uint64_t addr, uint64_t size) {
+  for (uint64_t i = 0; i < size; ++i) {
+    ref[addr + i] = uint8_t(i * 7 + 3);
+  }
+  ram.write(ref.data() + addr, addr, size);
+}
+
+static bool match(vortex::RAM& ram, const std::vector<uint8_t>& ref, uint64_t addr, uint64_t size) {
+  std::vector<uint8_t> data(size);
+  ram.read(data.data(), addr, size);
+  return 0 == memcmp(data.data(), ref.data() + addr, size);
+}
+
+static int test_copy() {
+  struct { uint64_t dst, src, size; } cases[] = {
+    {1000, 1000, 300}, // same range
+    {1000, 1037, 300}, // overlapping, destination below the source
+    {1037, 1000, 300}, // overlapping, destination above the source
+    {1001, 1000, 300}, // overlapping by all but one byte
+    {1000, 1001, 300},
+    {2048, 2048 + 64, 256}, // page-aligned overlap
+    {2048 + 64, 2048, 256},
+    {4000, 8000, 513}, // disjoint
+  };
+  for (auto& c : cases) {
+    vortex::RAM ram(capacity, pageSize);
+    std::vector<uint8_t> ref(capacity);
+    uint64_t lo = std::min(c.dst, c.src);
+    uint64_t hi = std::max(c.dst, c.src) + c.size;
+    init_range(ram, ref, lo, hi - lo);
+    ram.copy(c.dst, c.src, c.size);
+    memmove(ref.data() + c.dst, ref.data() + c.src, c.size);
+    CHECK(match(ram, ref, lo, hi - lo));
+  }
+  return 0;
+}
+
+static int test_fill() {
+  uint8_t pattern[64];
+  for (int i = 0; i < 64; ++i) {
+    pattern[i] = uint8_t(0x80 + i);
+  }
+  struct { uint64_t addr, size; uint32_t pattern_size; } cases[] = {
+    {0, 64, 4},        // single page
+    {5, 300, 3},       // unaligned, period not dividing the page size
+    {60, 200, 7},      // starts at the end of a page
+    {128, 8, 1},
+    {1000, 3, 7},      // shorter than the pattern
+    {3000, 640, 64},   // period equal to the page size
+  };
+  for (auto& c : cases) {
+    vortex::RAM ram(capacity, pageSize);
+    std::vector<uint8_t> ref(capacity);
+    init_range(ram, ref, c.addr - (c.addr ? 1 : 0), c.size + 2);
+    ram.fill(c.addr, c.size, pattern, c.pattern_size);
+    for (uint64_t i = 0; i < c.size; ++i) {
+      ref[c.addr + i] = pattern[i % c.pattern_size];
+    }
+    // bytes around the range are left untouched
+    CHECK(match(ram, ref, c.addr - (c.addr ? 1 : 0), c.size + 2));
+  }
+  return 0;
+}
+
+static int test_map() {
+  vortex::RAM ram(capacity, pageSize);
+  std::vector<uint8_t> ref(capacity);
+  init_range(ram, ref, 0, 4096);
+
+  // a mapped range is contiguous and aliases memory
+  auto p0 = ram.map(100, 100);
+  CHECK(p0 != nullptr);
+  CHECK(0 == memcmp(p0, ref.data() + 100, 100));
+  p0[10] = 0xab;
+  ref[110] = 0xab;
+  CHECK(match(ram, ref, 100, 100));
+
+  // a sub-range of a mapped region is served from it
+  auto p1 = ram.map(120, 16);
+  CHECK(p1 == p0 + 20);
+  ram.unmap(120);
+
+  // a second region, disjoint from the first
+  auto p2 = ram.map(1000, 200);
+  CHECK(p2 != nullptr);
+
+  // regions still mapped cannot be merged
+  CHECK(nullptr == ram.map(150, 1000));
+  ram.unmap(100);
+  CHECK(nullptr == ram.map(150, 1000));
+  ram.unmap(1000);
+
+  // merge both regions and the pages between them
+  auto p3 = ram.map(150, 1000);
+  CHECK(p3 != nullptr);
+  CHECK(0 == memcmp(p3, ref.data() + 150, 1000));
+  p3[0] = 0xcd;
+  p3[999] = 0xef;
+  ref[150] = 0xcd;
+  ref[1149] = 0xef;
+  CHECK(match(ram, ref, 0, 4096));
+
+  // the merged region covers the original ones
+  auto p4 = ram.map(64, 1200 - 64);
+  CHECK(p4 != nullptr);
+  CHECK(p4 + (150 - 64) == p3);
+  ram.unmap(64);
+  ram.unmap(150);
+
+  // copy and fill across mapped and unmapped pages
+  ram.copy(1100, 2000, 200);
+  memmove(ref.data() + 1100, ref.data() + 2000, 200);
+  uint8_t pattern[] = {1, 2, 3};
+  ram.fill(1180, 100, pattern, 3);
+  for (int i = 0; i < 100; ++i) {
+    ref[1180 + i] = pattern[i % 3];
+  }
+  CHECK(match(ram, ref, 0, 4096));
+  return 0;
+}
+
+int main() {
+  if (test_copy() != 0)
+    return -1;
+  if (test_fill() != 0)
+    return -1;
+  if (test_map() != 0)
+    return -1;
+
+  printf("PASSED!\n");
+
+  return 0;
+}